@@ -1,5 +1,6 @@
 #include "Model.h"
 #include "../Objects/Logger.h"
+#include "../Objects/MeshCache.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -11,18 +12,38 @@
 	#include <GL/gl.h>
 #endif
 
+#include <assimp/DefaultIOSystem.h>
 #include <iostream>
+#include <algorithm>
+
+// changing these invalidates the mesh cache entries (they are a part of the key)
+#define MODEL_IMPORT_FLAGS (aiProcess_Triangulate | aiProcess_FlipUVs)
 
 namespace ed
 {
 	namespace eng
 	{
+		// remembers every file that the importer opened - models can reference other files (.gltf buffers, .mtl, ...)
+		class RecordingIOSystem : public Assimp::DefaultIOSystem
+		{
+		public:
+			std::vector<std::string> Files;
+
+			Assimp::IOStream* Open(const char* file, const char* mode = "rb") override
+			{
+				Assimp::IOStream* ret = Assimp::DefaultIOSystem::Open(file, mode);
+				if (ret != nullptr && std::find(Files.begin(), Files.end(), file) == Files.end())
+					Files.push_back(file);
+				return ret;
+			}
+		};
+
 		Model::Mesh::Mesh(const std::string& name, std::vector<Model::Mesh::Vertex> vertices, std::vector<unsigned int> indices, std::vector<Model::Mesh::Texture> textures)
 		{
 			Name = name;
-			Vertices = vertices;
-			Indices = indices;
-			Textures = textures;
+			Vertices = std::move(vertices);
+			Indices = std::move(indices);
+			Textures = std::move(textures);
 			m_setup();
 		}
 		void Model::Mesh::m_setup()
@@ -78,9 +99,20 @@ namespace ed
 		{
 			ed::Logger::Get().Log("Loading a 3D model " + path);
 
+			Directory = path.substr(0, path.find_last_of("/\\"));
+
+			// skip the import if the meshes are already cached
+			std::string cacheKey = ed::MeshCache::Instance().GetKey(path, MODEL_IMPORT_FLAGS);
+			if (ed::MeshCache::Instance().Load(cacheKey, *this)) {
+				ed::Logger::Get().Log("Loaded " + std::to_string(Meshes.size()) + " meshes from the mesh cache");
+				return true;
+			}
+
 			// read file via ASSIMP
 			Assimp::Importer importer;
-			const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
+			RecordingIOSystem* io = new RecordingIOSystem(); // owned by the importer
+			importer.SetIOHandler(io);
+			const aiScene* scene = importer.ReadFile(path, MODEL_IMPORT_FLAGS);
 			
 			// check for errors
 			if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
@@ -89,11 +121,17 @@ namespace ed
 				return false;
 			}
 
-			Directory = path.substr(0, path.find_last_of("/\\"));
 			m_processNode(scene->mRootNode, scene);
 
 			m_findBounds();
 
+			// the model file itself is already a part of the key
+			std::vector<std::string> dependencies;
+			for (const std::string& file : io->Files)
+				if (!io->ComparePaths(file.c_str(), path.c_str()))
+					dependencies.push_back(file);
+			ed::MeshCache::Instance().Save(cacheKey, *this, dependencies);
+
 			return true;
 		}
 		void Model::m_findBounds()
@@ -227,7 +265,7 @@ namespace ed
 			// TODO: textures
 
 			// return a mesh object created from the extracted mesh data
-			return Model::Mesh(mesh->mName.data, vertices, indices, textures);
+			return Model::Mesh(mesh->mName.data, std::move(vertices), std::move(indices), std::move(textures));
 		}
 	}
 }
\ No newline at end of file
@@ -59,6 +59,7 @@ namespace ed
 
 			inline glm::vec3 GetMinBound() { return m_minBound; }
 			inline glm::vec3 GetMaxBound() { return m_maxBound; }
+			inline void SetBounds(const glm::vec3& minBound, const glm::vec3& maxBound) { m_minBound = minBound; m_maxBound = maxBound; }
 
 		private:
 			void m_findBounds();
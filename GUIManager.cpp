@@ -10,6 +10,7 @@
 #include "UI/ObjectListUI.h"
 #include "UI/MessageOutputUI.h"
 #include "UI/PixelInspectUI.h"
+#include "UI/ProfilerUI.h"
 #include "UI/PipelineUI.h"
 #include "UI/PropertyUI.h"
 #include "UI/PreviewUI.h"
@@ -28,11 +29,19 @@
 #include "Objects/ThemeContainer.h"
 #include "Objects/CameraSnapshots.h"
 #include "Objects/Export/ExportCPP.h"
+#include "Objects/Export/ImageWriter.h"
+#include "Objects/Export/VideoWriter.h"
 #include "Objects/KeyboardShortcuts.h"
 #include "Objects/FunctionVariableManager.h"
+#include "Objects/JobQueue.h"
 #include "Objects/SystemVariableManager.h"
 
 #include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <atomic>
+#include <deque>
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb/stb_image_write.h>
 
@@ -55,6 +64,8 @@
 
 #define HARRAYSIZE(a) (sizeof(a)/sizeof(*a))
 #define TOOLBAR_HEIGHT 48
+#define SEQ_READBACK_DEPTH 3 // frames that can be read back asynchronously while the next one renders
+#define SEQ_PROGRESS_UPDATE_RATE 0.25f
 
 #define getByte(value, n) (value >> (n*8) & 0xFF)
 
@@ -92,7 +103,12 @@ namespace ed
 		m_isInfoOpened = false;
 		m_savePreviewSeqDuration = 5.5f;
 		m_savePreviewSeqFPS = 30;
+		m_savePreviewSeqThreads = 0;
+		m_savePreviewSeqPipe = false;
+		strcpy(m_savePreviewSeqCommand, "ffmpeg -y -f rawvideo -pix_fmt rgba -s {width}x{height} -r {fps} -i - -pix_fmt yuv420p render.mp4");
 		m_savePreviewSupersample = 0;
+		m_savePreviewTiled = false;
+		m_savePreviewTileSize = 2048;
 		m_iconFontLarge = nullptr;
 		m_expcppBackend = 0;
 		m_expcppCmakeFiles = true;
@@ -140,6 +156,7 @@ namespace ed
 		m_views.push_back(new PipelineUI(this, objects, "Pipeline"));
 		m_views.push_back(new PropertyUI(this, objects, "Properties"));
 		m_views.push_back(new PixelInspectUI(this, objects, "Pixel Inspect"));
+		m_views.push_back(new ProfilerUI(this, objects, "Profiler", false));
 
 		m_debugViews.push_back(new DebugWatchUI(this, objects, "Watch"));
 		m_debugViews.push_back(new DebugValuesUI(this, objects, "Variables"));
@@ -232,7 +249,7 @@ namespace ed
 			if (!file.empty() && dotPos != std::string::npos) {
 				std::string ext = file.substr(dotPos + 1);
 
-				const std::vector<std::string> imgExt = { "png", "jpeg", "jpg", "bmp", "gif", "psd", "pic", "pnm", "hdr", "tga" };
+				const std::vector<std::string> imgExt = { "png", "jpeg", "jpg", "bmp", "gif", "psd", "pic", "pnm", "hdr", "tga", "ktx", "ktx2", "dds" };
 				const std::vector<std::string> sndExt = { "ogg", "wav", "flac", "aiff", "raw" }; // TODO: more file ext
 				const std::vector<std::string> projExt = { "sprj" };
 
@@ -278,6 +295,364 @@ namespace ed
 
 		m_data->Plugins.OnEvent(e);
 	}
+	bool GUIManager::m_pipelineHasNDCQuad()
+	{
+		std::vector<PipelineItem*>& passes = m_data->Pipeline.GetList();
+		for (PipelineItem* pass : passes) {
+			if (pass->Type != PipelineItem::ItemType::ShaderPass)
+				continue;
+
+			pipe::ShaderPass* data = (pipe::ShaderPass*)pass->Data;
+			for (PipelineItem* item : data->Items)
+				if (item->Type == PipelineItem::ItemType::Geometry && ((pipe::GeometryItem*)item->Data)->Type == pipe::GeometryItem::ScreenQuadNDC)
+					return true;
+		}
+		return false;
+	}
+	bool GUIManager::m_savePreviewTiles(int sizeMulti)
+	{
+		int width = m_previewSaveSize.x, height = m_previewSaveSize.y;
+		if (width <= 0 || height <= 0)
+			return false;
+
+		ImageWriter writer;
+		if (!writer.Open(m_previewSavePath, width, height))
+			return false;
+
+		// the rendered tile (with supersampling) has to fit in a texture
+		GLint maxTexSize = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTexSize);
+		int renderTile = std::min(m_savePreviewTileSize, (int)maxTexSize);
+		int tileSize = std::max(1, renderTile / sizeMulti);
+		
+		auto& systemVM = SystemVariableManager::Instance();
+		systemVM.CopyState();
+		systemVM.SetTimeDelta(m_savePreviewTimeDelta);
+		systemVM.SetKeysWASD(m_savePreviewWASD[0], m_savePreviewWASD[1], m_savePreviewWASD[2], m_savePreviewWASD[3]);
+		systemVM.SetMousePosition(m_savePreviewMouse.x, m_savePreviewMouse.y);
+		systemVM.SetMouse(m_savePreviewMouse.x, m_savePreviewMouse.y, m_savePreviewMouse.z, m_savePreviewMouse.w);
+
+		// peak memory: one rendered tile + one row of tiles
+		unsigned char* pixels = (unsigned char*)malloc(tileSize * sizeMulti * tileSize * sizeMulti * 4);
+		unsigned char* outPixels = sizeMulti != 1 ? (unsigned char*)malloc(tileSize * tileSize * 4) : pixels;
+		unsigned char* strip = (unsigned char*)malloc((size_t)width * tileSize * 4);
+
+		GLuint tex = m_data->Renderer.GetTexture();
+		bool success = true;
+		for (int y = 0; y < height && success; y += tileSize) { // top to bottom
+			int tileH = std::min(tileSize, height - y);
+
+			for (int x = 0; x < width; x += tileSize) {
+				int tileW = std::min(tileSize, width - x);
+
+				systemVM.SetFrameIndex(m_savePreviewFrameIndex);
+				systemVM.SetTile(glm::vec4(x / (float)width, (height - y - tileH) / (float)height, tileW / (float)width, tileH / (float)height));
+				m_data->Renderer.Render(tileW * sizeMulti, tileH * sizeMulti);
+
+				glBindTexture(GL_TEXTURE_2D, tex);
+				glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+				glBindTexture(GL_TEXTURE_2D, 0);
+
+				// box filter doesn't sample outside of the tile -> no seams
+				if (sizeMulti != 1)
+					stbir_resize_uint8_generic(pixels, tileW * sizeMulti, tileH * sizeMulti, tileW * sizeMulti * 4,
+						outPixels, tileW, tileH, tileW * 4, 4, STBIR_ALPHA_CHANNEL_NONE, 0,
+						STBIR_EDGE_CLAMP, STBIR_FILTER_BOX, STBIR_COLORSPACE_LINEAR, nullptr);
+
+				// GL rows go from bottom to top
+				for (int row = 0; row < tileH; row++)
+					memcpy(strip + ((size_t)row * width + x) * 4, outPixels + (size_t)(tileH - 1 - row) * tileW * 4, tileW * 4);
+			}
+
+			success = writer.WriteRows(strip, tileH);
+		}
+		systemVM.SetTile(glm::vec4(0, 0, 1, 1));
+		success = writer.Close() && success;
+
+		if (sizeMulti != 1) free(outPixels);
+		free(pixels);
+		free(strip);
+
+		systemVM.AdvanceTimer(m_savePreviewCachedTime - m_savePreviewTimeDelta);
+
+		if (!success)
+			Logger::Get().Log("Failed to save the preview to " + m_previewSavePath, true);
+
+		return success;
+	}
+	void GUIManager::m_savePreviewSequence(int sizeMulti)
+	{
+		int actualSizeX = m_previewSaveSize.x * sizeMulti;
+		int actualSizeY = m_previewSaveSize.y * sizeMulti;
+		if (actualSizeX <= 0 || actualSizeY <= 0)
+			return;
+
+		float seqDelta = 1.0f / m_savePreviewSeqFPS;
+
+		SystemVariableManager::Instance().SetKeysWASD(m_savePreviewWASD[0], m_savePreviewWASD[1], m_savePreviewWASD[2], m_savePreviewWASD[3]);
+		SystemVariableManager::Instance().SetMousePosition(m_savePreviewMouse.x, m_savePreviewMouse.y);
+		SystemVariableManager::Instance().SetMouse(m_savePreviewMouse.x, m_savePreviewMouse.y, m_savePreviewMouse.z, m_savePreviewMouse.w);
+
+		float curTime = 0.0f;
+
+		GLuint tex = m_data->Renderer.GetTexture();
+
+		size_t lastDot = m_previewSavePath.find_last_of('.');
+		std::string ext = lastDot == std::string::npos ? "png" : m_previewSavePath.substr(lastDot + 1);
+		std::string filename = m_previewSavePath;
+
+		// allow only one %??d
+		bool inFormat = false;
+		int lastFormatPos = -1;
+		int formatCount = 0;
+		for (int i = 0; i < filename.size(); i++) {
+			if (filename[i] == '%') {
+				inFormat = true;
+				lastFormatPos = i;
+				continue;
+			}
+
+			if (inFormat) {
+				if (isdigit(filename[i])) { }
+				else {
+					if (filename[i] != '%' &&
+						((filename[i] == 'd' && formatCount > 0) ||
+							(filename[i] != 'd')))
+					{
+						filename.insert(lastFormatPos, 1, '%');
+					}
+
+					if (filename[i] == 'd')
+						formatCount++;
+					inFormat = false;
+				}
+			}
+		}
+
+		// no %d found? add one
+		if (formatCount == 0)
+			filename.insert(lastDot == std::string::npos ? filename.size() : lastDot, "%d"); // frame%d
+
+		// y4m/raw files and encoder commands get all the frames in one stream
+		VideoWriter video;
+		bool isVideo = m_savePreviewSeqPipe || VideoWriter::IsSupported(ext);
+		if (isVideo) {
+			bool opened = false;
+			if (m_savePreviewSeqPipe)
+				opened = video.OpenPipe(m_savePreviewSeqCommand, m_previewSaveSize.x, m_previewSaveSize.y, m_savePreviewSeqFPS);
+			else
+				opened = video.Open(m_previewSavePath, m_previewSaveSize.x, m_previewSaveSize.y, m_savePreviewSeqFPS);
+
+			if (!opened) {
+				Logger::Get().Log("Failed to start the video export", true);
+				return;
+			}
+		}
+
+		SystemVariableManager::Instance().AdvanceTimer(m_savePreviewCachedTime - m_savePreviewTimeDelta);
+		SystemVariableManager::Instance().SetTimeDelta(seqDelta);
+
+		int tCount = m_savePreviewSeqThreads;
+		if (tCount <= 0) {
+			tCount = std::thread::hardware_concurrency();
+			tCount = tCount == 0 ? 2 : tCount;
+		}
+
+		// readback goes through a pool of pixel pack buffers: up to SEQ_READBACK_DEPTH frames can be in
+		// flight on the GPU while every worker holds one mapped buffer -> the GPU never waits for glGetTexImage
+		// and the pixels are never copied on the main thread
+		int bufferCount = tCount + SEQ_READBACK_DEPTH;
+		size_t frameBytes = (size_t)actualSizeX * actualSizeY * 4;
+		GLuint* pbos = new GLuint[bufferCount];
+		glGenBuffers(bufferCount, pbos);
+		std::vector<int> freeBuffers;
+		for (int i = 0; i < bufferCount; i++) {
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+			glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+			freeBuffers.push_back(i);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		struct Readback
+		{
+			int Buffer;
+			int Frame;
+			GLsync Fence;
+		};
+		std::deque<Readback> inFlight;
+
+		struct EncodeJob
+		{
+			int Buffer;
+			int Frame;
+			const unsigned char* Pixels;
+		};
+		JobQueue<EncodeJob> jobs(tCount);			// main thread -> workers
+		JobQueue<int> finished(bufferCount);		// workers -> main thread, buffers that can be unmapped
+		std::atomic<int> framesWritten = 0;
+
+		std::vector<std::thread> threadPool;
+		for (int i = 0; i < tCount; i++) {
+			threadPool.push_back(std::thread([ext, filename, sizeMulti, actualSizeX, actualSizeY, isVideo, &video, &jobs, &finished, &framesWritten](int w, int h) {
+				char prevSavePath[MAX_PATH];
+				unsigned char* outPixels = sizeMulti != 1 ? (unsigned char*)malloc(w * h * 4) : nullptr;
+				std::vector<unsigned char> videoFrame(isVideo ? video.GetFrameSize() : 0);
+
+				EncodeJob job;
+				while (jobs.Pop(job)) {
+					// the readback failed - the video still has to move on to the next frame
+					if (job.Pixels == nullptr) {
+						if (isVideo)
+							video.WriteFrame(job.Frame, nullptr);
+						continue;
+					}
+
+					// resize image
+					const unsigned char* outData = job.Pixels;
+					if (sizeMulti != 1) {
+						stbir_resize_uint8(job.Pixels, actualSizeX, actualSizeY, actualSizeX * 4,
+							outPixels, w, h, w * 4, 4);
+						outData = outPixels;
+					}
+
+					if (isVideo) {
+						video.Convert(outData, videoFrame.data());
+						finished.Push(job.Buffer); // the converted copy is written, the buffer can be reused already
+						video.WriteFrame(job.Frame, videoFrame.data());
+						framesWritten++;
+						continue;
+					}
+
+					sprintf(prevSavePath, filename.c_str(), job.Frame);
+
+					if (ext == "jpg" || ext == "jpeg")
+						stbi_write_jpg(prevSavePath, w, h, 4, outData, 100);
+					else if (ext == "bmp")
+						stbi_write_bmp(prevSavePath, w, h, 4, outData);
+					else if (ext == "tga")
+						stbi_write_tga(prevSavePath, w, h, 4, outData);
+					else
+						ImageWriter::Save(prevSavePath, w, h, outData, true, 1); // the frames are already encoded in parallel
+
+					framesWritten++;
+					finished.Push(job.Buffer);
+				}
+
+				free(outPixels);
+			}, m_previewSaveSize.x, m_previewSaveSize.y));
+		}
+
+		// unmap the buffers that the workers are done with (has to happen on this thread)
+		auto retireBuffer = [&](int buffer) {
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[buffer]);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			freeBuffers.push_back(buffer);
+		};
+
+		// wait for the oldest readback, map it and queue it for encoding
+		auto dispatchOldest = [&]() {
+			Readback rb = inFlight.front();
+			inFlight.pop_front();
+
+			while (glClientWaitSync(rb.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) { }
+			glDeleteSync(rb.Fence);
+
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[rb.Buffer]);
+			const unsigned char* data = (const unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameBytes, GL_MAP_READ_BIT);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+			if (data == nullptr) {
+				Logger::Get().Log("Failed to map the pixel buffer of frame " + std::to_string(rb.Frame), true);
+				freeBuffers.push_back(rb.Buffer);
+				rb.Buffer = -1;
+			}
+
+			EncodeJob job;
+			job.Buffer = rb.Buffer;
+			job.Frame = rb.Frame;
+			job.Pixels = data;
+			jobs.Push(job); // blocks while all workers are busy
+		};
+
+		int frameCount = (int)std::ceil(m_savePreviewSeqDuration / seqDelta - 0.0001f);
+		std::string windowTitle = SDL_GetWindowTitle(m_wnd);
+		sf::Clock exportClock, progressClock;
+
+		int globalFrame = 0;
+		while (curTime < m_savePreviewSeqDuration) {
+			int buffer = 0;
+			while (finished.TryPop(buffer))
+				retireBuffer(buffer);
+
+			if (inFlight.size() >= SEQ_READBACK_DEPTH)
+				dispatchOldest();
+
+			// every buffer is mapped or queued -> wait for an encoder
+			if (freeBuffers.empty() && finished.Pop(buffer))
+				retireBuffer(buffer);
+
+			SystemVariableManager::Instance().CopyState();
+			SystemVariableManager::Instance().SetFrameIndex(m_savePreviewFrameIndex + globalFrame);
+
+			m_data->Renderer.Render(actualSizeX, actualSizeY);
+
+			// asynchronous readback
+			Readback rb;
+			rb.Buffer = freeBuffers.back();
+			rb.Frame = globalFrame;
+			freeBuffers.pop_back();
+
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[rb.Buffer]);
+			glBindTexture(GL_TEXTURE_2D, tex);
+			glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+			glBindTexture(GL_TEXTURE_2D, 0);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			rb.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			inFlight.push_back(rb);
+
+			SystemVariableManager::Instance().AdvanceTimer(seqDelta);
+
+			curTime += seqDelta;
+			globalFrame++;
+
+			// progress & ETA in the title bar - the UI doesn't get redrawn during the export
+			if (progressClock.getElapsedTime().asSeconds() > SEQ_PROGRESS_UPDATE_RATE) {
+				int written = framesWritten;
+				float elapsed = exportClock.getElapsedTime().asSeconds();
+				float eta = written > 0 ? elapsed / written * (frameCount - written) : 0.0f;
+
+				char progress[128];
+				sprintf(progress, "SHADERed - exporting frame %d/%d (%d%%), ETA %.0fs", written, frameCount, (int)(100.0f * written / std::max(frameCount, 1)), eta);
+				SDL_SetWindowTitle(m_wnd, progress);
+
+				progressClock.restart();
+			}
+		}
+
+		// flush the remaining frames and wait for the workers
+		while (!inFlight.empty())
+			dispatchOldest();
+		jobs.Close();
+		for (auto& thread : threadPool)
+			if (thread.joinable())
+				thread.join();
+
+		int buffer = 0;
+		while (finished.TryPop(buffer))
+			retireBuffer(buffer);
+		glDeleteBuffers(bufferCount, pbos);
+		delete[] pbos;
+
+		if (isVideo && !video.Close())
+			Logger::Get().Log("Failed to finish the video export", true);
+
+		SDL_SetWindowTitle(m_wnd, windowTitle.c_str());
+
+		float exportTime = exportClock.getElapsedTime().asSeconds();
+		Logger::Get().Log("Exported " + std::to_string((int)framesWritten) + " frames in " + std::to_string(exportTime) + "s using " + std::to_string(tCount) + " encoder threads");
+
+	}
 	void GUIManager::m_tooltip(const std::string &text)
 	{
 		if (ImGui::IsItemHovered())
@@ -1317,7 +1692,7 @@ namespace ed
 			ImGui::TextWrapped("Path: %s", m_previewSavePath.c_str());
 			ImGui::SameLine();
 			if (ImGui::Button("...##save_prev_path"))
-				UIHelper::GetSaveFileDialog(m_previewSavePath, "png;jpg,jpeg;bmp;tga");
+				UIHelper::GetSaveFileDialog(m_previewSavePath, "png;jpg,jpeg;bmp;tga;y4m;rgba,raw");
 			
 			ImGui::Text("Width: ");
 			ImGui::SameLine();
@@ -1337,6 +1712,42 @@ namespace ed
 			ImGui::Combo("##save_prev_ssmp", &m_savePreviewSupersample, " 1x\0 2x\0 4x\0 8x\0");
 			ImGui::Unindent(105);
 
+			// ScreenQuadNDC doesn't go through any matrix -> every tile would contain the whole image
+			bool canTile = !m_pipelineHasNDCQuad();
+			if (!canTile)
+				m_savePreviewTiled = false;
+
+			ImGui::Text("Tiled: ");
+			if (ImGui::IsItemHovered())
+				ImGui::SetTooltip("Render and save the image in parts so that it doesn't have to fit in memory (png, bmp and tga only).\nShaders have to use the built-in projection/orthographic matrices - gl_FragCoord is relative to the tile.\nNot available if the pipeline contains a ScreenQuadNDC.");
+			ImGui::SameLine();
+			ImGui::Indent(105);
+			if (!canTile) {
+				ImGui::PushItemFlag(ImGuiItemFlags_Disabled, true);
+				ImGui::PushStyleVar(ImGuiStyleVar_Alpha, ImGui::GetStyle().Alpha * 0.5f);
+			}
+			ImGui::Checkbox("##save_prev_tiled", &m_savePreviewTiled);
+			if (!canTile) {
+				ImGui::PopStyleVar();
+				ImGui::PopItemFlag();
+			}
+			ImGui::Unindent(105);
+
+			if (!m_savePreviewTiled || m_savePreviewSeq) {
+				ImGui::PushItemFlag(ImGuiItemFlags_Disabled, true);
+				ImGui::PushStyleVar(ImGuiStyleVar_Alpha, ImGui::GetStyle().Alpha * 0.5f);
+			}
+			ImGui::Text("Tile size: ");
+			ImGui::SameLine();
+			ImGui::Indent(105);
+			if (ImGui::InputInt("##save_prev_tilesize", &m_savePreviewTileSize, 256, 1024))
+				m_savePreviewTileSize = std::max(64, m_savePreviewTileSize);
+			ImGui::Unindent(105);
+			if (!m_savePreviewTiled || m_savePreviewSeq) {
+				ImGui::PopStyleVar();
+				ImGui::PopItemFlag();
+			}
+
 			ImGui::Separator();
 			if (ImGui::CollapsingHeader("Sequence")) {
 				ImGui::TextWrapped("Export a sequence of images");
@@ -1365,6 +1776,32 @@ namespace ed
 				ImGui::DragInt("##save_prev_seqfps", &m_savePreviewSeqFPS);
 				ImGui::PopItemWidth();
 
+				/* ENCODER THREADS */
+				ImGui::Text("Encoder threads:");
+				ImGui::SameLine();
+				ImGui::PushItemWidth(-1);
+				if (ImGui::InputInt("##save_prev_seqthreads", &m_savePreviewSeqThreads))
+					m_savePreviewSeqThreads = std::max(0, m_savePreviewSeqThreads);
+				ImGui::PopItemWidth();
+				m_tooltip("0 = one thread per CPU core");
+
+				/* ENCODER COMMAND */
+				ImGui::Text("Pipe to command:");
+				ImGui::SameLine();
+				ImGui::Checkbox("##save_prev_seqpipe", &m_savePreviewSeqPipe);
+				m_tooltip("Raw RGBA frames are written to the stdin of this command instead of the image files.\n{width}, {height} and {fps} are replaced with the actual values.");
+				if (!m_savePreviewSeqPipe) {
+					ImGui::PushItemFlag(ImGuiItemFlags_Disabled, true);
+					ImGui::PushStyleVar(ImGuiStyleVar_Alpha, ImGui::GetStyle().Alpha * 0.5f);
+				}
+				ImGui::PushItemWidth(-1);
+				ImGui::InputText("##save_prev_seqcmd", m_savePreviewSeqCommand, sizeof(m_savePreviewSeqCommand));
+				ImGui::PopItemWidth();
+				if (!m_savePreviewSeqPipe) {
+					ImGui::PopItemFlag();
+					ImGui::PopStyleVar();
+				}
+
 				if (!m_savePreviewSeq) {
 					ImGui::PopItemFlag();
 					ImGui::PopStyleVar();
@@ -1422,6 +1859,8 @@ namespace ed
 			ImGui::Separator();
 
 			if (ImGui::Button("Save")) {
+				m_data->Objects.WaitForTextures(); // don't save the placeholders
+
 				int sizeMulti = 1;
 				switch (m_savePreviewSupersample) {
 				case 1: sizeMulti = 2; break;
@@ -1431,8 +1870,11 @@ namespace ed
 				int actualSizeX = m_previewSaveSize.x * sizeMulti;
 				int actualSizeY = m_previewSaveSize.y * sizeMulti;
 
+				// tiled render
+				if (!m_savePreviewSeq && m_savePreviewTiled)
+					m_savePreviewTiles(sizeMulti);
 				// normal render
-				if (!m_savePreviewSeq) {
+				else if (!m_savePreviewSeq) {
 					if (actualSizeX > 0 && actualSizeY > 0) {
 						SystemVariableManager::Instance().CopyState();
 						
@@ -1475,158 +1917,13 @@ namespace ed
 					else if (ext == "tga")
 						stbi_write_tga(m_previewSavePath.c_str(), m_previewSaveSize.x, m_previewSaveSize.y, 4, outPixels);
 					else
-						stbi_write_png(m_previewSavePath.c_str(), m_previewSaveSize.x, m_previewSaveSize.y, 4, outPixels, m_previewSaveSize.x * 4);
+						ImageWriter::Save(m_previewSavePath, m_previewSaveSize.x, m_previewSaveSize.y, outPixels);
 
 					if (sizeMulti != 1) free(outPixels);
 					free(pixels);
 				}
-				else { // sequence render
-
-					float seqDelta = 1.0f / m_savePreviewSeqFPS;
-
-					if (actualSizeX > 0 && actualSizeY > 0) {
-						SystemVariableManager::Instance().SetKeysWASD(m_savePreviewWASD[0], m_savePreviewWASD[1], m_savePreviewWASD[2], m_savePreviewWASD[3]);
-						SystemVariableManager::Instance().SetMousePosition(m_savePreviewMouse.x, m_savePreviewMouse.y);
-						SystemVariableManager::Instance().SetMouse(m_savePreviewMouse.x, m_savePreviewMouse.y, m_savePreviewMouse.z, m_savePreviewMouse.w);
-						
-						float curTime = 0.0f;
-						
-						GLuint tex = m_data->Renderer.GetTexture();
-						
-						size_t lastDot = m_previewSavePath.find_last_of('.');
-						std::string ext = lastDot == std::string::npos ? "png" : m_previewSavePath.substr(lastDot+1);
-						std::string filename = m_previewSavePath;
-						
-						// allow only one %??d
-						bool inFormat = false;
-						int lastFormatPos = -1;
-						int formatCount = 0;
-						for (int i = 0; i < filename.size(); i++) {
-							if (filename[i] == '%') {
-								inFormat = true;
-								lastFormatPos = i;
-								continue;
-							}
-
-							if (inFormat) {
-								if (isdigit(filename[i])) { }
-								else {
-									if (filename[i] != '%' &&
-										((filename[i] == 'd' && formatCount > 0) ||
-											(filename[i] != 'd')))
-									{
-										filename.insert(lastFormatPos, 1, '%');
-									}
-
-									if (filename[i] == 'd')
-										formatCount++;
-									inFormat = false;
-								}
-							}
-						}
-
-						// no %d found? add one
-						if (formatCount == 0)
-							filename.insert(lastDot == std::string::npos ? filename.size() : lastDot, "%d"); // frame%d
-					
-						SystemVariableManager::Instance().AdvanceTimer(m_savePreviewCachedTime - m_savePreviewTimeDelta);
-						SystemVariableManager::Instance().SetTimeDelta(seqDelta);
-
-						stbi_write_png_compression_level = 5; // set to lowest compression level
-
-						int tCount = std::thread::hardware_concurrency();
-						tCount = tCount == 0 ? 2 : tCount;
-
-						unsigned char** pixels = new unsigned char*[tCount];
-						unsigned char** outPixels = new unsigned char* [tCount];
-						int* curFrame = new int[tCount];
-						bool* needsUpdate = new bool[tCount];
-						std::thread** threadPool = new std::thread*[tCount];
-						std::atomic<bool> isOver = false;
-
-						for (int i = 0; i < tCount; i++) {
-							curFrame[i] = 0;
-							needsUpdate[i] = true;
-							pixels[i] = (unsigned char*)malloc(actualSizeX * actualSizeY * 4);
-							
-							if (sizeMulti != 1) outPixels[i] = (unsigned char*)malloc(m_previewSaveSize.x * m_previewSaveSize.y * 4);
-							else outPixels[i] = nullptr;
-
-							threadPool[i] = new std::thread([ext, filename, sizeMulti, actualSizeX, actualSizeY, &outPixels, &pixels, &needsUpdate, &curFrame, &isOver](int worker, int w, int h) {
-								char prevSavePath[MAX_PATH];
-								while (!isOver) {
-									if (needsUpdate[worker])
-										continue;
-
-									// resize image
-									if (sizeMulti != 1) {
-										stbir_resize_uint8(pixels[worker], actualSizeX, actualSizeY, actualSizeX * 4,
-											outPixels[worker], w, h, w * 4, 4);
-									} else outPixels[worker] = pixels[worker];
-
-									sprintf(prevSavePath, filename.c_str(), curFrame[worker]);
-									
-									if (ext == "jpg" || ext == "jpeg")
-										stbi_write_jpg(prevSavePath, w, h, 4, outPixels[worker], 100);
-									else if (ext == "bmp")
-										stbi_write_bmp(prevSavePath, w, h, 4, outPixels[worker]);
-									else if (ext == "tga")
-										stbi_write_tga(prevSavePath, w, h, 4, outPixels[worker]);
-									else
-										stbi_write_png(prevSavePath, w, h, 4, outPixels[worker], w * 4);
-								
-									needsUpdate[worker] = true;
-								}
-							}, i, m_previewSaveSize.x, m_previewSaveSize.y);
-						}
-
-						int globalFrame = 0;
-						while (curTime < m_savePreviewSeqDuration) {
-							int hasWork = -1;
-							for (int i = 0; i < tCount; i++) 
-								if (needsUpdate[i]) {
-									hasWork = i;
-									break;
-								}
-
-							if (hasWork == -1)
-								continue;
-
-							SystemVariableManager::Instance().CopyState();
-							SystemVariableManager::Instance().SetFrameIndex(m_savePreviewFrameIndex + globalFrame);
-							
-							m_data->Renderer.Render(actualSizeX, actualSizeY);
-
-							glBindTexture(GL_TEXTURE_2D, tex);
-							glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels[hasWork]);
-							glBindTexture(GL_TEXTURE_2D, 0);
-
-							SystemVariableManager::Instance().AdvanceTimer(seqDelta);
-
-							curTime += seqDelta;
-							curFrame[hasWork] = globalFrame;
-							needsUpdate[hasWork] = false;
-							globalFrame++;
-						}
-						isOver = true;
-						
-						for (int i = 0; i < tCount; i++) {
-							if (threadPool[i]->joinable())
-								threadPool[i]->join();
-							free(pixels[i]);
-							if (sizeMulti != 1)
-								free(outPixels[i]);
-							delete threadPool[i];
-						}
-						delete[] pixels;
-						delete[] outPixels;
-						delete[] curFrame;
-						delete[] needsUpdate;
-						delete[] threadPool;
-
-						stbi_write_png_compression_level = 8; // set back to default compression level
-					}
-				}
+				else // sequence render
+					m_savePreviewSequence(sizeMulti);
 
 				m_data->Renderer.Pause(m_wasPausedPrior);
 				ImGui::CloseCurrentPopup();
@@ -1845,6 +2142,8 @@ namespace ed
 			return m_objectPrev;
 		else if (view >= ViewID::DebugWatch && view <= ViewID::DebugImmediate)
 			return m_debugViews[(int)view - (int)ViewID::DebugWatch];
+		else if (view == ViewID::Profiler)
+			return m_views[(int)ViewID::PixelInspect + 1];
 
 		return m_views[(int)view];
 	}
@@ -1863,10 +2162,12 @@ namespace ed
 	{
 		std::ofstream data("data/gui.dat");
 
-		for (auto& view : m_views)
-			data.put(view->Visible);
+		// views that were added later go after the debug views so that older gui.dat files still load
+		for (int i = 0; i <= (int)ViewID::PixelInspect; i++)
+			data.put(m_views[i]->Visible);
 		for (auto& dview : m_debugViews)
 			data.put(dview->Visible);
+		data.put(Get(ViewID::Profiler)->Visible);
 
 		data.close();
 	}
@@ -1875,11 +2176,15 @@ namespace ed
 		std::ifstream data("data/gui.dat");
 
 		if (data.is_open()) {
-			for (auto& view : m_views)
-				view->Visible = data.get();
+			for (int i = 0; i <= (int)ViewID::PixelInspect; i++)
+				m_views[i]->Visible = data.get();
 			for (auto& dview : m_debugViews)
 				dview->Visible = data.get();
 
+			int profilerVisible = data.get();
+			if (profilerVisible != EOF)
+				Get(ViewID::Profiler)->Visible = profilerVisible;
+
 			data.close();
 		}
 
@@ -1983,7 +2288,7 @@ namespace ed
 	}
 	void GUIManager::CreateNewTexture() {
 		std::string path;
-		bool success = UIHelper::GetOpenFileDialog(path, "png;jpg;jpeg;bmp");
+		bool success = UIHelper::GetOpenFileDialog(path, "png;jpg;jpeg;bmp;ktx;ktx2;dds");
 		
 		if (!success)
 			return;
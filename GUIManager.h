@@ -35,7 +35,8 @@ namespace ed
 		DebugBreakpointList,
 		DebugImmediate,
 		Options,
-		ObjectPreview
+		ObjectPreview,
+		Profiler // added later - last so that the existing IDs don't change
 	};
 
 	class GUIManager
@@ -124,6 +125,10 @@ namespace ed
 		glm::vec4 m_savePreviewMouse;
 		std::string m_previewSavePath;
 		glm::ivec2 m_previewSaveSize;
+		bool m_savePreviewTiled;
+		int m_savePreviewTileSize; // in rendered pixels (with supersampling)
+		bool m_savePreviewTiles(int sizeMulti); // render & write the preview one tile at a time
+		bool m_pipelineHasNDCQuad(); // can't be rendered in tiles
 
 		bool m_expcppError;
 		int m_expcppBackend;
@@ -138,6 +143,10 @@ namespace ed
 		bool m_savePreviewSeq;
 		float m_savePreviewSeqDuration;
 		int m_savePreviewSeqFPS;
+		int m_savePreviewSeqThreads; // 0 -> hardware_concurrency()
+		bool m_savePreviewSeqPipe;
+		char m_savePreviewSeqCommand[512]; // raw RGBA frames are written to its stdin
+		void m_savePreviewSequence(int sizeMulti); // frames are read back through a ring of PBOs and encoded on worker threads
 
 		bool m_performanceMode, m_perfModeFake;
 		sf::Clock m_perfModeClock;
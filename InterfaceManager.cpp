@@ -16,7 +16,7 @@ namespace ed
 
 	InterfaceManager::InterfaceManager(GUIManager* gui) :
 		Renderer(&Pipeline, &Objects, &Parser, &Messages, &Plugins, &Debugger),
-		Pipeline(&Parser),
+		Pipeline(&Parser, &Renderer),
 		Objects(&Parser, &Renderer),
 		Parser(&Pipeline, &Objects, &Renderer, &Plugins, &Messages, &Debugger, gui),
 		Debugger(&Objects, &Renderer)
@@ -25,6 +25,8 @@ namespace ed
 	}
 	InterfaceManager::~InterfaceManager()
 	{
+		// Parser is destroyed before Renderer, stop the transcompiler threads that use it first
+		Renderer.StopCompiling();
 		Objects.Clear();
 		Plugins.Destroy();
 	}
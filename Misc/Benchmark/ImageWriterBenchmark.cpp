@@ -0,0 +1,157 @@
+// Compares ImageWriter's PNG encoder with stb_image_write on a noisy gradient frame.
+// Every ImageWriter output is decoded with stb_image and compared with the input.
+//
+// Not part of the SHADERed target, configure with -DSHADERED_BUILD_BENCHMARKS=ON -DCMAKE_BUILD_TYPE=Release
+// and build the ImageWriterBenchmark target (it only links ImageWriter.cpp, not the rest of the editor)
+// usage: ImageWriterBenchmark [output directory] [repeat count]
+//
+// ImageWriterBenchmark /tmp 3 on a single vCPU Intel Xeon VM (5 GB RAM, Linux 6.18, GCC 12.2, Release):
+//         stb lvl 8            stb lvl 5            ImageWriter (1 thread)   ImageWriter (all cores)
+//  1080p  0.64 / 6913814       0.92 / 6945961       0.44 / 6606630           0.35 / 6606630
+//  4K     2.86 / 27647361      2.36 / 27776446      1.35 / 26408529          1.26 / 26408529
+//  8K     11.03 / 110576467    9.93 / 111094581     5.59 / 105613679         5.82 / 105613679
+// with one core "all cores" is the same single thread, the difference between the two columns is noise
+#include "../../Objects/Export/ImageWriter.h"
+#include "../../Objects/Logger.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb/stb_image_write.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include <thread>
+#include <string.h>
+#include <stdlib.h>
+
+// ImageWriter only needs Logger::Log - avoid linking Logger.cpp and everything it depends on
+void ed::Logger::Log(const std::string& msg, bool error, const std::string& file, int line)
+{
+	fprintf(stderr, "%s%s\n", error ? "[ERROR] " : "", msg.c_str());
+}
+
+std::vector<unsigned char> createFrame(int width, int height)
+{
+	std::vector<unsigned char> ret((size_t)width * height * 4);
+	// mt19937's output is fixed by the standard, uniform_int_distribution's isn't - map it by hand
+	// so that every standard library generates the same frame
+	std::mt19937 rng(1234);
+	auto noise = [&]() { return (int)(rng() % 17) - 8; };
+
+	for (int y = 0; y < height; y++) {
+		unsigned char* row = ret.data() + (size_t)y * width * 4;
+		for (int x = 0; x < width; x++) {
+			int r = x * 255 / width + noise();
+			int g = y * 255 / height + noise();
+			int b = (x + y) * 255 / (width + height) + noise();
+
+			row[x * 4 + 0] = (unsigned char)std::min(255, std::max(0, r));
+			row[x * 4 + 1] = (unsigned char)std::min(255, std::max(0, g));
+			row[x * 4 + 2] = (unsigned char)std::min(255, std::max(0, b));
+			row[x * 4 + 3] = 255;
+		}
+	}
+
+	return ret;
+}
+long getFileSize(const std::string& file)
+{
+	FILE* f = fopen(file.c_str(), "rb");
+	if (f == nullptr)
+		return -1;
+	fseek(f, 0, SEEK_END);
+	long ret = ftell(f);
+	fclose(f);
+	return ret;
+}
+bool matches(const std::string& file, const std::vector<unsigned char>& pixels, int width, int height)
+{
+	int w = 0, h = 0, comp = 0;
+	unsigned char* data = stbi_load(file.c_str(), &w, &h, &comp, 4);
+	if (data == nullptr)
+		return false;
+
+	bool ret = w == width && h == height && memcmp(data, pixels.data(), pixels.size()) == 0;
+	stbi_image_free(data);
+	return ret;
+}
+// best time out of repeatCount runs, in seconds
+double measure(int repeatCount, const std::function<bool()>& func)
+{
+	double ret = -1.0;
+	for (int i = 0; i < repeatCount; i++) {
+		auto start = std::chrono::steady_clock::now();
+		if (!func())
+			return -1.0;
+		double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (ret < 0.0 || time < ret)
+			ret = time;
+	}
+	return ret;
+}
+
+int main(int argc, char** argv)
+{
+	std::string outDir = argc > 1 ? argv[1] : ".";
+	int repeatCount = argc > 2 ? std::max(1, atoi(argv[2])) : 3;
+
+	struct Resolution
+	{
+		const char* Name;
+		int Width, Height;
+	};
+	const Resolution resolutions[] = {
+		{ "1080p", 1920, 1080 },
+		{ "4K", 3840, 2160 },
+		{ "8K", 7680, 4320 }
+	};
+
+	printf("threads: %u, best of %d runs, seconds / size in bytes\n\n", std::thread::hardware_concurrency(), repeatCount);
+	printf("%-6s %-24s %-24s %-24s %s\n", "", "stb lvl 8", "stb lvl 5", "ImageWriter (1 thread)", "ImageWriter (all cores)");
+
+	bool success = true;
+	for (const Resolution& res : resolutions) {
+		std::vector<unsigned char> pixels = createFrame(res.Width, res.Height);
+		std::string results[4];
+
+		for (int i = 0; i < 4; i++) {
+			std::string file = outDir + "/benchmark_" + res.Name + "_" + std::to_string(i) + ".png";
+
+			double time = -1.0;
+			if (i < 2) {
+				stbi_write_png_compression_level = i == 0 ? 8 : 5;
+				time = measure(repeatCount, [&]() {
+					return stbi_write_png(file.c_str(), res.Width, res.Height, 4, pixels.data(), res.Width * 4) != 0;
+				});
+			} else {
+				int threadCount = i == 2 ? 1 : 0;
+				time = measure(repeatCount, [&]() {
+					return ed::ImageWriter::Save(file, res.Width, res.Height, pixels.data(), false, threadCount);
+				});
+
+				if (time >= 0.0 && !matches(file, pixels, res.Width, res.Height)) {
+					fprintf(stderr, "%s doesn't match the input image\n", file.c_str());
+					success = false;
+				}
+			}
+
+			char buffer[64];
+			if (time < 0.0)
+				snprintf(buffer, sizeof(buffer), "failed");
+			else
+				snprintf(buffer, sizeof(buffer), "%.2f / %ld", time, getFileSize(file));
+			results[i] = buffer;
+
+			remove(file.c_str());
+		}
+
+		printf("%-6s %-24s %-24s %-24s %s\n", res.Name, results[0].c_str(), results[1].c_str(), results[2].c_str(), results[3].c_str());
+	}
+
+	return success ? 0 : 1;
+}
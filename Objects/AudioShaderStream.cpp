@@ -1,5 +1,7 @@
 #include "AudioShaderStream.h"
 #include "ShaderTranscompiler.h"
+#include "GLState.h"
+#include "ShaderVariableContainer.h"
 #include "../Engine/GeometryFactory.h"
 #include "../Engine/GLUtils.h"
 #include <vector>
@@ -23,7 +25,8 @@ namespace ed
 		gl::FreeSimpleFramebuffer(m_fbo, m_rt, m_depth);
 		glDeleteVertexArrays(1, &m_fsRectVAO);
 		glDeleteBuffers(1, &m_fsRectVBO);
-		glDeleteProgram(m_shader);
+		ShaderVariableContainer::ForgetProgram(m_shader);
+		GLState::Instance().DeleteProgram(m_shader);
 		stop();
 	}
 	
@@ -141,21 +144,22 @@ namespace ed
 		
 		m_mutex.lock();
 
-		glUseProgram(m_shader);
-		glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+		GLState& glState = GLState::Instance();
+		glState.UseProgram(m_shader);
+		glState.BindFramebuffer(GL_FRAMEBUFFER, m_fbo);
 		glDrawBuffers(1, &m_fboBuffers);
 		glClearBufferfi(GL_DEPTH_STENCIL, 0, 1.0f, 0);
 		glClearBufferfv(GL_COLOR, 0, glm::value_ptr(glm::vec4(0.0f, 0.0f, 0.0f, 0.0f)));
-		glViewport(0, 0, 1024, 1);
+		glState.Viewport(0, 0, 1024, 1);
 
 		glUniform1f(m_svarCurTimeLoc, m_curTime);
 		glBindVertexArray(m_fsRectVAO);
 		glDrawArrays(GL_TRIANGLES, 0, 6);
 
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-		glBindTexture(GL_TEXTURE_2D, m_rt);
+		glState.BindFramebuffer(GL_FRAMEBUFFER, 0);
+		glState.BindTexture(0, GL_TEXTURE_2D, m_rt);
 		glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, m_pixels);
-		glBindTexture(GL_TEXTURE_2D, 0);
+		glState.BindTexture(0, GL_TEXTURE_2D, 0);
 
 		for (int s = 0; s < 1024; s++) {
 			int off = s * 4;
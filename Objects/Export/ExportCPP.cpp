@@ -2,6 +2,7 @@
 #include "../../Engine/GeometryFactory.h"
 #include "../SystemVariableManager.h"
 #include "../ShaderTranscompiler.h"
+#include "../FileCache.h"
 #include "../Names.h"
 #include <ghc/filesystem.hpp>
 #include <string>
@@ -13,10 +14,8 @@ namespace ed
 {
 	std::string loadFile(const std::string& filename)
 	{
-		std::ifstream file(filename);
-		std::string src((std::istreambuf_iterator<char>(file)),
-			std::istreambuf_iterator<char>());
-		file.close();
+		std::string src;
+		FileCache::Instance().Get(filename, src);
 		return src;
 	}
 	size_t findSection(const std::string& str, const std::string& sec)
@@ -365,9 +364,7 @@ namespace ed
 		}
 
 		// load template code data
-		std::ifstream templateFile("data/export/cpp/template.cpp");
-		std::string templateSrc((std::istreambuf_iterator<char>(templateFile)), std::istreambuf_iterator<char>());
-		templateFile.close();
+		std::string templateSrc = loadFile("data/export/cpp/template.cpp");
 
 		// get list of all shader files
 		std::vector<std::string> allShaderFiles;
@@ -0,0 +1,510 @@
+#include "ImageWriter.h"
+#include "../Logger.h"
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+
+#define DEFLATE_WINDOW_SIZE 32768
+#define DEFLATE_MAX_DISTANCE 32767
+#define DEFLATE_MAX_MATCH 258
+#define DEFLATE_HASH_BITS 15
+#define DEFLATE_MAX_CHAIN 16
+#define DEFLATE_NICE_MATCH 64
+#define PNG_MIN_STRIP_ROWS 16
+#define PNG_STRIPS_PER_THREAD 4
+
+namespace ed
+{
+	static const unsigned short lengthBase[] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258, 259 };
+	static const unsigned char lengthExtra[] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+	static const unsigned short distBase[] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577,32768 };
+	static const unsigned char distExtra[] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+
+	class BitStream
+	{
+	public:
+		BitStream(std::vector<unsigned char>& out) : m_out(out), m_buffer(0), m_count(0) {}
+
+		inline void Add(unsigned int bits, int count)
+		{
+			m_buffer |= bits << m_count;
+			m_count += count;
+			while (m_count >= 8) {
+				m_out.push_back(m_buffer & 0xFF);
+				m_buffer >>= 8;
+				m_count -= 8;
+			}
+		}
+		inline void AddReversed(unsigned int code, int count) // huffman codes are stored MSB first
+		{
+			unsigned int res = 0;
+			for (int i = 0; i < count; i++, code >>= 1)
+				res = (res << 1) | (code & 1);
+			Add(res, count);
+		}
+		inline void Align()
+		{
+			if (m_count > 0)
+				m_out.push_back(m_buffer & 0xFF);
+			m_buffer = 0;
+			m_count = 0;
+		}
+
+	private:
+		std::vector<unsigned char>& m_out;
+		unsigned int m_buffer;
+		int m_count;
+	};
+
+	// fixed huffman code for literals/lengths
+	static inline void writeSymbol(BitStream& bits, int sym)
+	{
+		if (sym < 144) bits.AddReversed(0x30 + sym, 8);
+		else if (sym < 256) bits.AddReversed(0x190 + sym - 144, 9);
+		else if (sym < 280) bits.AddReversed(sym - 256, 7);
+		else bits.AddReversed(0xC0 + sym - 280, 8);
+	}
+	static inline unsigned int hash3(const unsigned char* p)
+	{
+		return ((p[0] << 10) ^ (p[1] << 5) ^ p[2]) & ((1 << DEFLATE_HASH_BITS) - 1);
+	}
+
+	struct CRCTable
+	{
+		CRCTable()
+		{
+			for (uint32_t i = 0; i < 256; i++) {
+				uint32_t c = i;
+				for (int k = 0; k < 8; k++)
+					c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				Data[i] = c;
+			}
+		}
+		uint32_t Data[256];
+	};
+	static uint32_t crc32(uint32_t crc, const unsigned char* data, size_t len)
+	{
+		static const CRCTable table; // thread safe initialization
+		const uint32_t* crcTable = table.Data;
+
+		crc = ~crc;
+		for (size_t i = 0; i < len; i++)
+			crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		return ~crc;
+	}
+	static inline void put16(unsigned char* p, unsigned int v) { p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF; }
+	static inline void put32(unsigned char* p, unsigned int v) { put16(p, v & 0xFFFF); put16(p + 2, v >> 16); }
+	static inline void put32BE(unsigned char* p, unsigned int v) { p[0] = v >> 24; p[1] = (v >> 16) & 0xFF; p[2] = (v >> 8) & 0xFF; p[3] = v & 0xFF; }
+	static inline int paeth(int a, int b, int c)
+	{
+		int p = a + b - c, pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+		if (pa <= pb && pa <= pc) return a;
+		if (pb <= pc) return b;
+		return c;
+	}
+	static void adler32(uint32_t& a, uint32_t& b, const unsigned char* data, size_t len)
+	{
+		size_t pos = 0;
+		while (pos < len) {
+			size_t block = std::min<size_t>(len - pos, 5552);
+			for (size_t i = 0; i < block; i++) {
+				a += data[pos + i];
+				b += a;
+			}
+			a %= 65521;
+			b %= 65521;
+			pos += block;
+		}
+	}
+	// adler32 of A+B from adler32(A) and adler32(B) (same as zlib's adler32_combine)
+	static void adler32Combine(uint32_t& a1, uint32_t& b1, uint32_t a2, uint32_t b2, size_t len2)
+	{
+		const uint32_t base = 65521;
+		uint32_t rem = (uint32_t)(len2 % base);
+		uint32_t sum1 = a1;
+		uint32_t sum2 = (uint32_t)(((uint64_t)rem * sum1) % base);
+		sum1 += a2 + base - 1;
+		sum2 += b1 + b2 + base - rem;
+		if (sum1 >= base) sum1 -= base;
+		if (sum1 >= base) sum1 -= base;
+		if (sum2 >= (base << 1)) sum2 -= (base << 1);
+		if (sum2 >= base) sum2 -= base;
+		a1 = sum1;
+		b1 = sum2;
+	}
+	// pick the filter with the smallest sum of absolute differences (same heuristic as stb_image_write)
+	static void filterRow(const unsigned char* row, const unsigned char* prev, int stride, std::vector<unsigned char>& out)
+	{
+		// all five filters are evaluated in a single pass over the row
+		int sums[5] = { 0, 0, 0, 0, 0 };
+		for (int x = 0; x < stride; x++) {
+			int a = x >= 4 ? row[x - 4] : 0, b = prev[x], c = x >= 4 ? prev[x - 4] : 0;
+			int v = row[x];
+			sums[0] += abs((signed char)v);
+			sums[1] += abs((signed char)(v - a));
+			sums[2] += abs((signed char)(v - b));
+			sums[3] += abs((signed char)(v - ((a + b) >> 1)));
+			sums[4] += abs((signed char)(v - paeth(a, b, c)));
+		}
+		int bestFilter = 0;
+		for (int f = 1; f < 5; f++)
+			if (sums[f] < sums[bestFilter])
+				bestFilter = f;
+
+		size_t start = out.size();
+		out.resize(start + 1 + stride);
+		unsigned char* dst = &out[start];
+		dst[0] = bestFilter;
+		for (int x = 0; x < stride; x++) {
+			int a = x >= 4 ? row[x - 4] : 0, b = prev[x], c = x >= 4 ? prev[x - 4] : 0;
+			int v = row[x];
+			switch (bestFilter) {
+			case 1: v -= a; break;
+			case 2: v -= b; break;
+			case 3: v -= (a + b) >> 1; break;
+			case 4: v -= paeth(a, b, c); break;
+			}
+			dst[1 + x] = (unsigned char)v;
+		}
+	}
+
+	ImageWriter::ImageWriter()
+	{
+		m_file = nullptr;
+		m_format = Format::PNG;
+		m_width = m_height = m_rowsWritten = 0;
+		m_failed = false;
+		m_adler1 = 1;
+		m_adler2 = 0;
+		m_zlibHeader = false;
+	}
+	ImageWriter::~ImageWriter()
+	{
+		if (m_file != nullptr)
+			fclose(m_file);
+	}
+	bool ImageWriter::IsSupported(const std::string& ext)
+	{
+		return ext == "png" || ext == "bmp" || ext == "tga";
+	}
+	bool ImageWriter::Open(const std::string& file, int width, int height)
+	{
+		size_t lastDot = file.find_last_of('.');
+		std::string ext = lastDot == std::string::npos ? "png" : file.substr(lastDot + 1);
+		if (!IsSupported(ext)) {
+			Logger::Get().Log("Can't write ." + ext + " files in parts", true);
+			return false;
+		}
+		if (width <= 0 || height <= 0)
+			return false;
+		if (ext == "tga" && (width > 0xFFFF || height > 0xFFFF)) {
+			Logger::Get().Log("Image is too large for the .tga format", true);
+			return false;
+		}
+
+		m_format = ext == "bmp" ? Format::BMP : (ext == "tga" ? Format::TGA : Format::PNG);
+		m_width = width;
+		m_height = height;
+		m_rowsWritten = 0;
+		m_failed = false;
+
+		m_file = fopen(file.c_str(), "wb");
+		if (m_file == nullptr) {
+			Logger::Get().Log("Failed to open " + file + " for writing", true);
+			return false;
+		}
+
+		if (m_format == Format::PNG) {
+			static const unsigned char signature[] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+			fwrite(signature, 1, sizeof(signature), m_file);
+
+			unsigned char ihdr[13] = { 0 };
+			put32BE(ihdr, width);
+			put32BE(ihdr + 4, height);
+			ihdr[8] = 8; // bit depth
+			ihdr[9] = 6; // RGBA
+			m_writePNGChunk("IHDR", ihdr, sizeof(ihdr));
+
+			m_prevRow.assign(width * 4, 0);
+			m_adler1 = 1;
+			m_adler2 = 0;
+			m_zlibHeader = false;
+		} else if (m_format == Format::BMP) {
+			unsigned int rowSize = (width * 3 + 3) & ~3;
+			unsigned char header[54] = { 0 };
+			header[0] = 'B'; header[1] = 'M';
+			put32(header + 2, 54 + rowSize * height);
+			put32(header + 10, 54);
+			put32(header + 14, 40);
+			put32(header + 18, width);
+			put32(header + 22, (unsigned int)-height); // top-down
+			put16(header + 26, 1);
+			put16(header + 28, 24);
+			put32(header + 34, rowSize * height);
+			fwrite(header, 1, sizeof(header), m_file);
+		} else {
+			unsigned char header[18] = { 0 };
+			header[2] = 2; // uncompressed true color
+			put16(header + 12, width);
+			put16(header + 14, height);
+			header[16] = 32;
+			header[17] = 0x28; // 8 alpha bits, top-left origin
+			fwrite(header, 1, sizeof(header), m_file);
+		}
+
+		return !ferror(m_file);
+	}
+	bool ImageWriter::WriteRows(const unsigned char* pixels, int rowCount)
+	{
+		if (m_file == nullptr || m_failed)
+			return false;
+
+		if (m_rowsWritten + rowCount > m_height)
+			rowCount = m_height - m_rowsWritten;
+
+		size_t stride = m_width * 4;
+		if (m_format == Format::PNG) {
+			m_filtered.clear();
+			for (int y = 0; y < rowCount; y++) {
+				const unsigned char* row = pixels + y * stride;
+				filterRow(row, m_prevRow.data(), (int)stride, m_filtered);
+				memcpy(m_prevRow.data(), row, stride);
+			}
+
+			// adler32 of the uncompressed zlib data
+			adler32(m_adler1, m_adler2, m_filtered.data(), m_filtered.size());
+
+			m_compressed.clear();
+			if (!m_zlibHeader) {
+				m_compressed.push_back(0x78); // deflate, 32K window
+				m_compressed.push_back(0x01);
+				m_zlibHeader = true;
+			}
+			Deflate(m_filtered.data(), m_filtered.size(), m_compressed);
+			m_writePNGChunk("IDAT", m_compressed.data(), m_compressed.size());
+		} else {
+			bool isBMP = m_format == Format::BMP;
+			size_t outStride = isBMP ? ((m_width * 3 + 3) & ~3) : stride;
+			std::vector<unsigned char> out(outStride, 0);
+			for (int y = 0; y < rowCount; y++) {
+				const unsigned char* row = pixels + y * stride;
+				for (int x = 0; x < m_width; x++) {
+					unsigned char* px = &out[x * (isBMP ? 3 : 4)];
+					px[0] = row[x * 4 + 2];
+					px[1] = row[x * 4 + 1];
+					px[2] = row[x * 4 + 0];
+					if (!isBMP) px[3] = row[x * 4 + 3];
+				}
+				fwrite(out.data(), 1, outStride, m_file);
+			}
+		}
+
+		m_rowsWritten += rowCount;
+		m_failed = ferror(m_file) != 0;
+		return !m_failed;
+	}
+	bool ImageWriter::WriteImage(const unsigned char* pixels, bool flipY, int threadCount)
+	{
+		if (m_file == nullptr || m_failed || m_rowsWritten != 0)
+			return false;
+
+		size_t stride = m_width * 4;
+		auto getRow = [&](int y) { return pixels + (size_t)(flipY ? m_height - 1 - y : y) * stride; };
+
+		if (m_format != Format::PNG) {
+			for (int y = 0; y < m_height && !m_failed; y++)
+				WriteRows(getRow(y), 1);
+			return !m_failed;
+		}
+
+		if (threadCount <= 0)
+			threadCount = std::max<int>(1, std::thread::hardware_concurrency());
+
+		// split the image into strips that are filtered & deflated independently - a few strips per thread to balance the load
+		int stripRows = std::max(PNG_MIN_STRIP_ROWS, (m_height + threadCount * PNG_STRIPS_PER_THREAD - 1) / (threadCount * PNG_STRIPS_PER_THREAD));
+		int stripCount = (m_height + stripRows - 1) / stripRows;
+
+		struct Strip
+		{
+			std::vector<unsigned char> Data;
+			uint32_t Adler1, Adler2;
+			size_t Length; // uncompressed
+		};
+		std::vector<Strip> strips(stripCount);
+		std::vector<unsigned char> zeroRow(stride, 0);
+
+		std::atomic<int> nextStrip(0);
+		auto worker = [&]() {
+			std::vector<unsigned char> filtered;
+			int s = 0;
+			while ((s = nextStrip++) < stripCount) {
+				int y0 = s * stripRows, y1 = std::min(y0 + stripRows, m_height);
+
+				// filters can still look at the last row of the previous strip
+				filtered.clear();
+				for (int y = y0; y < y1; y++)
+					filterRow(getRow(y), y == 0 ? zeroRow.data() : getRow(y - 1), (int)stride, filtered);
+
+				Strip& strip = strips[s];
+				strip.Adler1 = 1;
+				strip.Adler2 = 0;
+				strip.Length = filtered.size();
+				adler32(strip.Adler1, strip.Adler2, filtered.data(), filtered.size());
+				Deflate(filtered.data(), filtered.size(), strip.Data);
+			}
+		};
+
+		threadCount = std::min(threadCount, stripCount);
+		std::vector<std::thread> threads;
+		for (int i = 1; i < threadCount; i++)
+			threads.push_back(std::thread(worker));
+		worker();
+		for (auto& thread : threads)
+			thread.join();
+
+		// each strip ends with a sync flush -> they can simply be written one after another
+		for (int s = 0; s < stripCount; s++) {
+			Strip& strip = strips[s];
+			if (!m_zlibHeader) {
+				strip.Data.insert(strip.Data.begin(), { 0x78, 0x01 });
+				m_zlibHeader = true;
+			}
+			m_writePNGChunk("IDAT", strip.Data.data(), strip.Data.size());
+			adler32Combine(m_adler1, m_adler2, strip.Adler1, strip.Adler2, strip.Length);
+		}
+
+		m_rowsWritten = m_height;
+		m_failed = ferror(m_file) != 0;
+		return !m_failed;
+	}
+	bool ImageWriter::Save(const std::string& file, int width, int height, const unsigned char* pixels, bool flipY, int threadCount)
+	{
+		ImageWriter writer;
+		if (!writer.Open(file, width, height))
+			return false;
+		bool success = writer.WriteImage(pixels, flipY, threadCount);
+		return writer.Close() && success;
+	}
+	bool ImageWriter::Close()
+	{
+		if (m_file == nullptr)
+			return false;
+
+		bool success = !m_failed && m_rowsWritten == m_height;
+		if (m_format == Format::PNG && success) {
+			// empty final block + adler32
+			unsigned char end[6] = { 0x03, 0x00 };
+			put32BE(end + 2, (m_adler2 << 16) | m_adler1);
+			m_writePNGChunk("IDAT", end, sizeof(end));
+			m_writePNGChunk("IEND", nullptr, 0);
+		}
+
+		success = success && !ferror(m_file);
+		fclose(m_file);
+		m_file = nullptr;
+
+		m_prevRow.clear();
+		m_filtered.clear();
+		m_compressed.clear();
+		m_filtered.shrink_to_fit();
+		m_compressed.shrink_to_fit();
+
+		return success;
+	}
+	void ImageWriter::Deflate(const unsigned char* data, size_t len, std::vector<unsigned char>& out)
+	{
+		BitStream bits(out);
+		bits.Add(0, 1); // BFINAL = 0
+		bits.Add(1, 2); // BTYPE = 1 -> fixed huffman
+
+		std::vector<int> head(1 << DEFLATE_HASH_BITS, -1);
+		std::vector<int> prev(DEFLATE_WINDOW_SIZE, -1);
+
+		size_t i = 0;
+		while (i + 3 <= len) {
+			unsigned int h = hash3(data + i);
+
+			// find the longest match in the hash chain
+			int bestLen = 0, bestDist = 0;
+			int maxLen = (int)std::min<size_t>(DEFLATE_MAX_MATCH, len - i);
+			int cand = head[h];
+			for (int chain = 0; cand >= 0 && chain < DEFLATE_MAX_CHAIN && i - cand <= DEFLATE_MAX_DISTANCE; chain++) {
+				const unsigned char* a = data + cand;
+				const unsigned char* b = data + i;
+				int l = 0;
+				if (a[bestLen] == b[bestLen]) // otherwise it can't be longer than the current best match
+					while (l < maxLen && a[l] == b[l])
+						l++;
+				if (l > bestLen) {
+					bestLen = l;
+					bestDist = (int)(i - cand);
+					if (l >= DEFLATE_NICE_MATCH || l == maxLen)
+						break; // good enough
+				}
+
+				int next = prev[cand & (DEFLATE_WINDOW_SIZE - 1)];
+				if (next >= cand)
+					break; // slot was reused
+				cand = next;
+			}
+
+			prev[i & (DEFLATE_WINDOW_SIZE - 1)] = head[h];
+			head[h] = (int)i;
+
+			if (bestLen >= 3) {
+				int j = 0;
+				while (bestLen > lengthBase[j + 1] - 1) j++;
+				writeSymbol(bits, j + 257);
+				if (lengthExtra[j]) bits.Add(bestLen - lengthBase[j], lengthExtra[j]);
+
+				j = 0;
+				while (bestDist > distBase[j + 1] - 1) j++;
+				bits.AddReversed(j, 5);
+				if (distExtra[j]) bits.Add(bestDist - distBase[j], distExtra[j]);
+
+				// the skipped positions can still be matched against
+				for (int k = 1; k < bestLen; k++) {
+					size_t p = i + k;
+					if (p + 3 > len)
+						break;
+					unsigned int hp = hash3(data + p);
+					prev[p & (DEFLATE_WINDOW_SIZE - 1)] = head[hp];
+					head[hp] = (int)p;
+				}
+				i += bestLen;
+			} else {
+				writeSymbol(bits, data[i]);
+				i++;
+			}
+		}
+		for (; i < len; i++)
+			writeSymbol(bits, data[i]);
+		writeSymbol(bits, 256); // end of block
+
+		// sync flush: empty stored block
+		bits.Add(0, 3);
+		bits.Align();
+		out.push_back(0x00); out.push_back(0x00);
+		out.push_back(0xFF); out.push_back(0xFF);
+	}
+	void ImageWriter::m_writePNGChunk(const char* type, const unsigned char* data, size_t len)
+	{
+		unsigned char header[8];
+		put32BE(header, (unsigned int)len);
+		memcpy(header + 4, type, 4);
+
+		uint32_t crc = crc32(0, (const unsigned char*)type, 4);
+		if (len > 0)
+			crc = crc32(crc, data, len);
+
+		unsigned char footer[4];
+		put32BE(footer, crc);
+
+		fwrite(header, 1, 8, m_file);
+		if (len > 0)
+			fwrite(data, 1, len, m_file);
+		fwrite(footer, 1, 4, m_file);
+	}
+}
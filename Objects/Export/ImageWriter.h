@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdint.h>
+
+namespace ed
+{
+	// writes an RGBA8 image a few rows at a time (top to bottom) so that the whole image never has to be in memory
+	// supported formats: png, bmp, tga
+	class ImageWriter
+	{
+	public:
+		ImageWriter();
+		~ImageWriter();
+
+		static bool IsSupported(const std::string& ext);
+		// flipY -> pixels are in GL order (rows from bottom to top)
+		static bool Save(const std::string& file, int width, int height, const unsigned char* pixels, bool flipY = true, int threadCount = 0);
+
+		bool Open(const std::string& file, int width, int height);
+		bool WriteRows(const unsigned char* pixels, int rowCount); // rowCount * width * 4 bytes
+		// whole image at once, png strips are compressed on threadCount threads (0 -> one per core)
+		bool WriteImage(const unsigned char* pixels, bool flipY = false, int threadCount = 0);
+		bool Close();
+
+		inline bool IsOpen() { return m_file != nullptr; }
+
+		// compresses the data as one non-final fixed Huffman block followed by an empty stored block
+		// -> the output ends on a byte boundary so any number of these can be concatenated into one deflate stream
+		static void Deflate(const unsigned char* data, size_t len, std::vector<unsigned char>& out);
+
+	private:
+		enum class Format
+		{
+			PNG,
+			BMP,
+			TGA
+		};
+
+		void m_writePNGChunk(const char* type, const unsigned char* data, size_t len);
+
+		FILE* m_file;
+		Format m_format;
+		int m_width, m_height, m_rowsWritten;
+		bool m_failed;
+
+		// png
+		std::vector<unsigned char> m_prevRow;
+		std::vector<unsigned char> m_filtered, m_compressed;
+		uint32_t m_adler1, m_adler2;
+		bool m_zlibHeader;
+	};
+}
@@ -0,0 +1,212 @@
+#include "VideoWriter.h"
+#include "../Logger.h"
+#include <string.h>
+#include <algorithm>
+
+#if defined(_WIN32)
+	#define popen _popen
+	#define pclose _pclose
+	#define POPEN_WRITE_MODE "wb"
+#else
+	#define POPEN_WRITE_MODE "w"
+#endif
+
+namespace ed
+{
+	// BT.601, limited range
+	static inline unsigned char rgbToY(int r, int g, int b) { return (unsigned char)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16); }
+	static inline unsigned char rgbToU(int r, int g, int b) { return (unsigned char)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128); }
+	static inline unsigned char rgbToV(int r, int g, int b) { return (unsigned char)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128); }
+
+	static void replaceAll(std::string& str, const std::string& from, const std::string& to)
+	{
+		size_t pos = 0;
+		while ((pos = str.find(from, pos)) != std::string::npos) {
+			str.replace(pos, from.size(), to);
+			pos += to.size();
+		}
+	}
+
+	VideoWriter::VideoWriter()
+	{
+		m_file = nullptr;
+		m_isPipe = false;
+		m_format = Format::RGBA;
+		m_width = m_height = 0;
+		m_failed = false;
+		m_nextFrame = 0;
+	}
+	VideoWriter::~VideoWriter()
+	{
+		if (m_file != nullptr)
+			Close();
+	}
+
+	bool VideoWriter::IsSupported(const std::string& ext)
+	{
+		return ext == "y4m" || ext == "rgba" || ext == "raw";
+	}
+
+	bool VideoWriter::Open(const std::string& file, int width, int height, int fps)
+	{
+		size_t lastDot = file.find_last_of('.');
+		std::string ext = lastDot == std::string::npos ? "" : file.substr(lastDot + 1);
+		if (!IsSupported(ext) || width <= 0 || height <= 0)
+			return false;
+
+		m_file = fopen(file.c_str(), "wb");
+		if (m_file == nullptr) {
+			Logger::Get().Log("Failed to open " + file + " for writing", true);
+			return false;
+		}
+
+		m_isPipe = false;
+		m_format = ext == "y4m" ? Format::Y4M : Format::RGBA;
+		m_width = width;
+		m_height = height;
+		m_failed = false;
+		m_nextFrame = 0;
+
+		return m_writeHeader(fps);
+	}
+	bool VideoWriter::OpenPipe(const std::string& command, int width, int height, int fps)
+	{
+		if (width <= 0 || height <= 0)
+			return false;
+
+		std::string cmd = command;
+		replaceAll(cmd, "{width}", std::to_string(width));
+		replaceAll(cmd, "{height}", std::to_string(height));
+		replaceAll(cmd, "{fps}", std::to_string(fps));
+
+		Logger::Get().Log("Piping the frames to: " + cmd);
+
+#if !defined(_WIN32)
+		// don't get killed if the encoder exits early, fwrite() will fail instead
+		m_oldSigPipe = signal(SIGPIPE, SIG_IGN);
+#endif
+
+		m_file = popen(cmd.c_str(), POPEN_WRITE_MODE);
+		if (m_file == nullptr) {
+#if !defined(_WIN32)
+			signal(SIGPIPE, m_oldSigPipe);
+#endif
+			Logger::Get().Log("Failed to run the encoder command", true);
+			return false;
+		}
+
+		m_isPipe = true;
+		m_format = Format::RGBA;
+		m_width = width;
+		m_height = height;
+		m_failed = false;
+		m_nextFrame = 0;
+
+		return true;
+	}
+	bool VideoWriter::Close()
+	{
+		if (m_file == nullptr)
+			return false;
+
+		bool success = !m_failed;
+		if (m_isPipe) {
+			int status = pclose(m_file);
+			if (status != 0) {
+				Logger::Get().Log("The encoder command exited with code " + std::to_string(status), true);
+				success = false;
+			}
+#if !defined(_WIN32)
+			signal(SIGPIPE, m_oldSigPipe);
+#endif
+		} else
+			success = fclose(m_file) == 0 && success;
+
+		m_file = nullptr;
+		return success;
+	}
+
+	size_t VideoWriter::GetFrameSize()
+	{
+		if (m_format == Format::Y4M) {
+			size_t chromaSize = (size_t)((m_width + 1) / 2) * ((m_height + 1) / 2);
+			return (size_t)m_width * m_height + chromaSize * 2;
+		}
+		return (size_t)m_width * m_height * 4;
+	}
+	void VideoWriter::Convert(const unsigned char* pixels, unsigned char* out)
+	{
+		size_t rowSize = (size_t)m_width * 4;
+
+		if (m_format == Format::RGBA) {
+			for (int y = 0; y < m_height; y++)
+				memcpy(out + y * rowSize, pixels + (m_height - 1 - y) * rowSize, rowSize);
+			return;
+		}
+
+		// Y4M: Y plane + U and V planes at half the resolution
+		int chromaW = (m_width + 1) / 2, chromaH = (m_height + 1) / 2;
+		unsigned char* yPlane = out;
+		unsigned char* uPlane = out + (size_t)m_width * m_height;
+		unsigned char* vPlane = uPlane + (size_t)chromaW * chromaH;
+
+		for (int y = 0; y < m_height; y++) {
+			const unsigned char* row = pixels + (m_height - 1 - y) * rowSize;
+			unsigned char* yRow = yPlane + (size_t)y * m_width;
+			for (int x = 0; x < m_width; x++)
+				yRow[x] = rgbToY(row[x * 4 + 0], row[x * 4 + 1], row[x * 4 + 2]);
+		}
+
+		for (int cy = 0; cy < chromaH; cy++) {
+			int y0 = cy * 2, y1 = std::min(y0 + 1, m_height - 1);
+			const unsigned char* row0 = pixels + (m_height - 1 - y0) * rowSize;
+			const unsigned char* row1 = pixels + (m_height - 1 - y1) * rowSize;
+
+			for (int cx = 0; cx < chromaW; cx++) {
+				int x0 = cx * 2 * 4, x1 = std::min(cx * 2 + 1, m_width - 1) * 4;
+
+				// average of the 2x2 block
+				int r = (row0[x0 + 0] + row0[x1 + 0] + row1[x0 + 0] + row1[x1 + 0] + 2) >> 2;
+				int g = (row0[x0 + 1] + row0[x1 + 1] + row1[x0 + 1] + row1[x1 + 1] + 2) >> 2;
+				int b = (row0[x0 + 2] + row0[x1 + 2] + row1[x0 + 2] + row1[x1 + 2] + 2) >> 2;
+
+				uPlane[(size_t)cy * chromaW + cx] = rgbToU(r, g, b);
+				vPlane[(size_t)cy * chromaW + cx] = rgbToV(r, g, b);
+			}
+		}
+	}
+	bool VideoWriter::WriteFrame(int index, const unsigned char* data)
+	{
+		std::unique_lock<std::mutex> lock(m_orderMutex);
+		m_orderCV.wait(lock, [&]() { return m_nextFrame == index; });
+
+		if (data != nullptr && !m_failed) {
+			if (m_format == Format::Y4M)
+				m_failed = fwrite("FRAME\n", 1, 6, m_file) != 6;
+
+			size_t frameSize = GetFrameSize();
+			if (!m_failed)
+				m_failed = fwrite(data, 1, frameSize, m_file) != frameSize;
+
+			if (m_failed)
+				Logger::Get().Log("Failed to write frame " + std::to_string(index) + " of the video", true);
+		}
+
+		m_nextFrame++;
+		lock.unlock();
+		m_orderCV.notify_all();
+
+		return !m_failed;
+	}
+
+	bool VideoWriter::m_writeHeader(int fps)
+	{
+		if (m_format != Format::Y4M)
+			return true;
+
+		char header[128];
+		int len = snprintf(header, sizeof(header), "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", m_width, m_height, fps);
+		m_failed = fwrite(header, 1, len, m_file) != len;
+		return !m_failed;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <stdio.h>
+#include <signal.h>
+
+namespace ed
+{
+	// writes a sequence of RGBA8 frames into a single stream: .y4m (YUV 4:2:0), .rgba/.raw (raw RGBA)
+	// or the stdin of an encoder command (raw RGBA, "{width}", "{height}" and "{fps}" are replaced in the command)
+	// Convert() can be called from any thread, WriteFrame() makes sure that the frames are written in order
+	class VideoWriter
+	{
+	public:
+		VideoWriter();
+		~VideoWriter();
+
+		static bool IsSupported(const std::string& ext);
+
+		bool Open(const std::string& file, int width, int height, int fps);
+		bool OpenPipe(const std::string& command, int width, int height, int fps);
+		bool Close();
+
+		inline bool IsOpen() { return m_file != nullptr; }
+
+		// size of a converted frame
+		size_t GetFrameSize();
+		// input: GL pixels (rows from bottom to top)
+		void Convert(const unsigned char* pixels, unsigned char* out);
+		// blocks until all the frames before index have been written, data == nullptr skips the frame
+		bool WriteFrame(int index, const unsigned char* data);
+
+	private:
+		enum class Format
+		{
+			Y4M,
+			RGBA
+		};
+
+		bool m_writeHeader(int fps);
+
+		FILE* m_file;
+		bool m_isPipe;
+		Format m_format;
+		int m_width, m_height;
+		bool m_failed;
+#if !defined(_WIN32)
+		void (*m_oldSigPipe)(int);
+#endif
+
+		std::mutex m_orderMutex;
+		std::condition_variable m_orderCV;
+		int m_nextFrame;
+	};
+}
@@ -0,0 +1,98 @@
+#include "FileCache.h"
+#include "MappedFile.h"
+
+#define FILE_CACHE_CAPACITY (16 * 1024 * 1024) // bytes
+#define FILE_CACHE_MAX_FILE_SIZE (1024 * 1024) // larger files are read every time
+
+namespace ed
+{
+	FileCache::FileCache()
+	{
+		m_size = 0;
+		m_useCounter = 0;
+	}
+	bool FileCache::Get(const std::string& path, std::string& content)
+	{
+		std::string key = Normalize(path);
+
+		// the write time only has a resolution of one second, so the size is compared too
+		std::error_code ec;
+		ghc::filesystem::file_time_type time = ghc::filesystem::last_write_time(key, ec);
+		uintmax_t size = ec ? 0 : ghc::filesystem::file_size(key, ec);
+		if (ec) {
+			Remove(key);
+			return false;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto it = m_files.find(key);
+			if (it != m_files.end() && it->second.Time == time && it->second.Content.size() == size) {
+				it->second.LastUse = ++m_useCounter;
+				content = it->second.Content;
+				return true;
+			}
+		}
+
+		MappedFile file;
+		if (!file.Open(key))
+			return false;
+
+		content.assign(file.GetData(), file.GetSize());
+		file.Close();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto it = m_files.find(key);
+		if (it != m_files.end()) {
+			m_size -= it->second.Content.size();
+			m_files.erase(it);
+		}
+
+		if (content.size() <= FILE_CACHE_MAX_FILE_SIZE) {
+			m_evict(content.size());
+
+			File& entry = m_files[key];
+			entry.Content = content;
+			entry.Time = time;
+			entry.LastUse = ++m_useCounter;
+			m_size += content.size();
+		}
+
+		return true;
+	}
+	void FileCache::Remove(const std::string& path)
+	{
+		std::string key = Normalize(path);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_files.find(key);
+		if (it != m_files.end()) {
+			m_size -= it->second.Content.size();
+			m_files.erase(it);
+		}
+	}
+	void FileCache::Clear()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_files.clear();
+		m_size = 0;
+	}
+	std::string FileCache::Normalize(const std::string& path)
+	{
+		return ghc::filesystem::path(path).lexically_normal().generic_string();
+	}
+
+	void FileCache::m_evict(size_t needed)
+	{
+		while (m_files.size() > 0 && m_size + needed > FILE_CACHE_CAPACITY) {
+			auto oldest = m_files.begin();
+			for (auto it = m_files.begin(); it != m_files.end(); it++)
+				if (it->second.LastUse < oldest->second.LastUse)
+					oldest = it;
+
+			m_size -= oldest->second.Content.size();
+			m_files.erase(oldest);
+		}
+	}
+}
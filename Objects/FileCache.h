@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <mutex>
+
+#include <ghc/filesystem.hpp>
+
+namespace ed
+{
+	// contents of the files that the project reads over and over again (shaders, includes, templates)
+	// a file is only read again (through MappedFile) if its last write time or its size has changed
+	// small files are kept until the cache is full, the least recently used ones are dropped first
+	class FileCache
+	{
+	public:
+		static inline FileCache& Instance()
+		{
+			static FileCache ret;
+			return ret;
+		}
+
+		FileCache();
+
+		// returns false if the file doesn't exist
+		bool Get(const std::string& path, std::string& content);
+		void Remove(const std::string& path); // call after writing to a file
+		void Clear();
+
+		inline size_t GetSize() { return m_size; } // bytes
+
+		static std::string Normalize(const std::string& path);
+
+	private:
+		struct File
+		{
+			std::string Content;
+			ghc::filesystem::file_time_type Time;
+			unsigned int LastUse;
+		};
+
+		void m_evict(size_t needed);
+
+		std::mutex m_mutex; // used by the TranscompilerPool threads & the file tracker thread
+		std::unordered_map<std::string, File> m_files;
+		size_t m_size;
+		unsigned int m_useCounter;
+	};
+}
@@ -0,0 +1,212 @@
+#include "GLState.h"
+
+namespace ed
+{
+	const GLenum TRACKED_CAPS[] = { GL_DEPTH_CLAMP, GL_CULL_FACE, GL_BLEND, GL_DEPTH_TEST, GL_STENCIL_TEST, GL_MULTISAMPLE };
+
+	GLState::GLState()
+	{
+		m_tracking = false;
+		m_calls = m_skipped = 0;
+		m_lastCalls = m_lastSkipped = 0;
+	}
+
+	void GLState::Begin()
+	{
+		Invalidate();
+		m_tracking = true;
+	}
+	void GLState::End()
+	{
+		m_tracking = false;
+		Invalidate();
+	}
+	void GLState::Invalidate()
+	{
+		for (int i = 0; i < sizeof(TRACKED_CAPS) / sizeof(GLenum); i++)
+			m_caps[i].Valid = false;
+		m_polygonMode.Valid = m_cullFace.Valid = m_frontFace.Valid = m_depthFunc.Valid = false;
+		m_depthMask.Valid = false;
+		m_polygonOffset.Valid = false;
+		m_blendEquation.Valid = m_blendFunc.Valid = m_blendColor.Valid = m_sampleCoverage.Valid = false;
+		m_stencilFunc[0].Valid = m_stencilFunc[1].Valid = false;
+		m_stencilOp[0].Valid = m_stencilOp[1].Valid = false;
+		m_stencilMask.Valid = false;
+		m_program.Valid = false;
+		m_drawFBO.Valid = m_readFBO.Valid = false;
+		m_viewport.Valid = false;
+		m_activeTexture.Valid = false;
+		for (int i = 0; i < GLSTATE_TEXTURE_UNITS; i++)
+			for (int j = 0; j < 3; j++)
+				m_textures[i][j].Valid = false;
+	}
+	void GLState::ResetStats()
+	{
+		m_lastCalls = m_calls;
+		m_lastSkipped = m_skipped;
+		m_calls = m_skipped = 0;
+	}
+
+	void GLState::Enable(GLenum cap, bool enabled)
+	{
+		int index = m_capIndex(cap);
+		if (index == -1)
+			m_calls++;
+		else if (!m_update(m_caps[index], enabled))
+			return;
+
+		if (enabled)
+			glEnable(cap);
+		else
+			glDisable(cap);
+	}
+	void GLState::PolygonMode(GLenum mode)
+	{
+		if (m_update(m_polygonMode, mode))
+			glPolygonMode(GL_FRONT_AND_BACK, mode);
+	}
+	void GLState::CullFace(GLenum mode)
+	{
+		if (m_update(m_cullFace, mode))
+			glCullFace(mode);
+	}
+	void GLState::FrontFace(GLenum mode)
+	{
+		if (m_update(m_frontFace, mode))
+			glFrontFace(mode);
+	}
+	void GLState::DepthMask(GLboolean mask)
+	{
+		if (m_update(m_depthMask, mask))
+			glDepthMask(mask);
+	}
+	void GLState::DepthFunc(GLenum func)
+	{
+		if (m_update(m_depthFunc, func))
+			glDepthFunc(func);
+	}
+	void GLState::PolygonOffset(GLfloat factor, GLfloat units)
+	{
+		if (m_update(m_polygonOffset, std::make_tuple(factor, units)))
+			glPolygonOffset(factor, units);
+	}
+	void GLState::BlendEquationSeparate(GLenum color, GLenum alpha)
+	{
+		if (m_update(m_blendEquation, std::make_tuple(color, alpha)))
+			glBlendEquationSeparate(color, alpha);
+	}
+	void GLState::BlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha)
+	{
+		if (m_update(m_blendFunc, std::make_tuple(srcRGB, dstRGB, srcAlpha, dstAlpha)))
+			glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+	}
+	void GLState::BlendColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+	{
+		if (m_update(m_blendColor, std::make_tuple(r, g, b, a)))
+			glBlendColor(r, g, b, a);
+	}
+	void GLState::SampleCoverage(GLfloat value, GLboolean invert)
+	{
+		if (m_update(m_sampleCoverage, std::make_tuple(value, invert)))
+			glSampleCoverage(value, invert);
+	}
+	void GLState::StencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint mask)
+	{
+		if (face != GL_FRONT && face != GL_BACK) {
+			m_stencilFunc[0].Valid = m_stencilFunc[1].Valid = false;
+			m_calls++;
+			glStencilFuncSeparate(face, func, ref, mask);
+			return;
+		}
+
+		if (m_update(m_stencilFunc[face == GL_BACK], std::make_tuple(func, ref, mask)))
+			glStencilFuncSeparate(face, func, ref, mask);
+	}
+	void GLState::StencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass)
+	{
+		if (face != GL_FRONT && face != GL_BACK) {
+			m_stencilOp[0].Valid = m_stencilOp[1].Valid = false;
+			m_calls++;
+			glStencilOpSeparate(face, sfail, dpfail, dppass);
+			return;
+		}
+
+		if (m_update(m_stencilOp[face == GL_BACK], std::make_tuple(sfail, dpfail, dppass)))
+			glStencilOpSeparate(face, sfail, dpfail, dppass);
+	}
+	void GLState::StencilMask(GLuint mask)
+	{
+		if (m_update(m_stencilMask, mask))
+			glStencilMask(mask);
+	}
+	void GLState::UseProgram(GLuint program)
+	{
+		if (m_update(m_program, program))
+			glUseProgram(program);
+	}
+	void GLState::DeleteProgram(GLuint program)
+	{
+		if (program == 0)
+			return;
+		if (m_program.Valid && m_program.Data == program)
+			m_program.Valid = false;
+		glDeleteProgram(program);
+	}
+	void GLState::BindFramebuffer(GLenum target, GLuint fbo)
+	{
+		if (target == GL_FRAMEBUFFER) {
+			// sets both the draw and the read framebuffer
+			if (m_tracking && m_drawFBO.Valid && m_readFBO.Valid && m_drawFBO.Data == fbo && m_readFBO.Data == fbo) {
+				m_skipped++;
+				return;
+			}
+
+			m_drawFBO.Data = m_readFBO.Data = fbo;
+			m_drawFBO.Valid = m_readFBO.Valid = m_tracking;
+			m_calls++;
+			glBindFramebuffer(target, fbo);
+		}
+		else if (m_update(target == GL_READ_FRAMEBUFFER ? m_readFBO : m_drawFBO, fbo))
+			glBindFramebuffer(target, fbo);
+	}
+	void GLState::Viewport(GLint x, GLint y, GLsizei w, GLsizei h)
+	{
+		if (m_update(m_viewport, std::make_tuple(x, y, w, h)))
+			glViewport(x, y, w, h);
+	}
+	void GLState::BindTexture(GLuint unit, GLenum target, GLuint texture)
+	{
+		int index = m_targetIndex(target);
+		if (unit >= GLSTATE_TEXTURE_UNITS || index == -1) {
+			m_activeTexture.Valid = false;
+			m_calls += 2;
+			glActiveTexture(GL_TEXTURE0 + unit);
+			glBindTexture(target, texture);
+			return;
+		}
+
+		if (!m_update(m_textures[unit][index], texture))
+			return;
+
+		if (m_update(m_activeTexture, unit))
+			glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(target, texture);
+	}
+
+	int GLState::m_capIndex(GLenum cap)
+	{
+		for (int i = 0; i < sizeof(TRACKED_CAPS) / sizeof(GLenum); i++)
+			if (TRACKED_CAPS[i] == cap)
+				return i;
+		return -1;
+	}
+	int GLState::m_targetIndex(GLenum target)
+	{
+		switch (target) {
+			case GL_TEXTURE_2D: return 0;
+			case GL_TEXTURE_CUBE_MAP: return 1;
+			case GL_TEXTURE_3D: return 2;
+		}
+		return -1;
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <GL/glew.h>
+#if defined(__APPLE__)
+	#include <OpenGL/gl.h>
+#else
+	#include <GL/gl.h>
+#endif
+
+#include <tuple>
+
+#define GLSTATE_TEXTURE_UNITS 32
+
+namespace ed
+{
+	// shadow copy of the GL state, calls are only issued if the value has changed
+	// the values are only trusted between Begin() and End() - outside of that (ImGui, gizmo, tools, ...) everything is passed through
+	class GLState
+	{
+	public:
+		static inline GLState& Instance()
+		{
+			static GLState ret;
+			return ret;
+		}
+
+		GLState();
+
+		void Begin(); // start trusting the shadow copy
+		void End();
+		void Invalidate(); // call after code that doesn't go through GLState (plugins, ...)
+
+		void Enable(GLenum cap, bool enabled);
+		void PolygonMode(GLenum mode); // GL_FRONT_AND_BACK
+		void CullFace(GLenum mode);
+		void FrontFace(GLenum mode);
+		void DepthMask(GLboolean mask);
+		void DepthFunc(GLenum func);
+		void PolygonOffset(GLfloat factor, GLfloat units);
+		void BlendEquationSeparate(GLenum color, GLenum alpha);
+		void BlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
+		void BlendColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+		void SampleCoverage(GLfloat value, GLboolean invert);
+		void StencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint mask); // GL_FRONT or GL_BACK
+		void StencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass);
+		void StencilMask(GLuint mask);
+		void UseProgram(GLuint program);
+		void DeleteProgram(GLuint program); // a recycled name must not match the shadow copy
+		void BindFramebuffer(GLenum target, GLuint fbo);
+		void Viewport(GLint x, GLint y, GLsizei w, GLsizei h);
+		void BindTexture(GLuint unit, GLenum target, GLuint texture); // also changes the active texture unit
+
+		// number of calls issued/skipped since the last ResetStats()
+		inline int GetCallCount() { return m_calls; }
+		inline int GetSkippedCount() { return m_skipped; }
+		void ResetStats();
+		inline int GetLastCallCount() { return m_lastCalls; }
+		inline int GetLastSkippedCount() { return m_lastSkipped; }
+
+	private:
+		template<typename T>
+		struct Value
+		{
+			Value() { Valid = false; }
+			T Data;
+			bool Valid;
+		};
+
+		// returns true if the GL call has to be made
+		template<typename T>
+		inline bool m_update(Value<T>& val, const T& data)
+		{
+			if (m_tracking && val.Valid && val.Data == data) {
+				m_skipped++;
+				return false;
+			}
+
+			val.Data = data;
+			val.Valid = m_tracking;
+			m_calls++;
+			return true;
+		}
+
+		int m_capIndex(GLenum cap);
+		int m_targetIndex(GLenum target);
+
+		bool m_tracking;
+
+		Value<bool> m_caps[6];
+		Value<GLenum> m_polygonMode, m_cullFace, m_frontFace, m_depthFunc;
+		Value<GLboolean> m_depthMask;
+		Value<std::tuple<GLfloat, GLfloat>> m_polygonOffset;
+		Value<std::tuple<GLenum, GLenum>> m_blendEquation;
+		Value<std::tuple<GLenum, GLenum, GLenum, GLenum>> m_blendFunc;
+		Value<std::tuple<GLfloat, GLfloat, GLfloat, GLfloat>> m_blendColor;
+		Value<std::tuple<GLfloat, GLboolean>> m_sampleCoverage;
+		Value<std::tuple<GLenum, GLint, GLuint>> m_stencilFunc[2];
+		Value<std::tuple<GLenum, GLenum, GLenum>> m_stencilOp[2];
+		Value<GLuint> m_stencilMask;
+		Value<GLuint> m_program;
+		Value<GLuint> m_drawFBO, m_readFBO;
+		Value<std::tuple<GLint, GLint, GLsizei, GLsizei>> m_viewport;
+		Value<GLuint> m_activeTexture;
+		Value<GLuint> m_textures[GLSTATE_TEXTURE_UNITS][3]; // 2D, cube map, 3D
+
+		int m_calls, m_skipped;
+		int m_lastCalls, m_lastSkipped;
+	};
+}
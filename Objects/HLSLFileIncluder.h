@@ -40,8 +40,10 @@
 #include <string>
 #include <fstream>
 #include <algorithm>
+#include <string.h>
 
 #include <glslang/Public/ShaderLang.h>
+#include "IncludeCache.h"
 
 namespace ed
 {
@@ -88,9 +90,13 @@ namespace ed
 
 		virtual ~HLSLFileIncluder() override { }
 
+		// paths of all the files that were included so far
+		const std::vector<std::string>& getIncludedFiles() const { return includedFiles; }
+
 	protected:
 		typedef char tUserDataElement;
 		std::vector<std::string> directoryStack;
+		std::vector<std::string> includedFiles;
 		int externalLocalDirectoryCount;
 
 		// Search for a valid "local" path based on combining the stack of include
@@ -107,10 +113,12 @@ namespace ed
 			for (auto it = directoryStack.rbegin(); it != directoryStack.rend(); ++it) {
 				std::string path = *it + '/' + headerName;
 				std::replace(path.begin(), path.end(), '\\', '/');
-				std::ifstream file(path, std::ios_base::binary | std::ios_base::ate);
-				if (file) {
+				std::string content;
+				if (IncludeCache::Instance().Get(path, content)) {
+					if (std::count(includedFiles.begin(), includedFiles.end(), path) == 0)
+						includedFiles.push_back(path);
 					directoryStack.push_back(getDirectory(path));
-					return newIncludeResult(path, file, (int)file.tellg());
+					return newIncludeResult(path, content);
 				}
 			}
 
@@ -124,13 +132,12 @@ namespace ed
 			return this->readLocalPath(headerName, "", 1);
 		}
 
-		// Do actual reading of the file, filling in a new include result.
-		virtual IncludeResult* newIncludeResult(const std::string& path, std::ifstream& file, int length) const
+		// Copy the (cached) file contents into a new include result.
+		virtual IncludeResult* newIncludeResult(const std::string& path, const std::string& content) const
 		{
-			char* content = new tUserDataElement[length];
-			file.seekg(0, file.beg);
-			file.read(content, length);
-			return new IncludeResult(path, content, length, content);
+			char* data = new tUserDataElement[content.size()];
+			memcpy(data, content.data(), content.size());
+			return new IncludeResult(path, data, content.size(), data);
 		}
 
 		// If no path markers, return current working directory.
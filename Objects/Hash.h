@@ -0,0 +1,43 @@
+#pragma once
+#include <string>
+#include <stdint.h>
+#include <stdio.h>
+
+namespace ed
+{
+	// 64-bit FNV-1a - used for the cache keys, not for security
+	class Hash
+	{
+	public:
+		Hash() { m_value = 0xCBF29CE484222325ULL; }
+
+		inline Hash& Add(const void* data, size_t len)
+		{
+			const unsigned char* bytes = (const unsigned char*)data;
+			for (size_t i = 0; i < len; i++) {
+				m_value ^= bytes[i];
+				m_value *= 0x100000001B3ULL;
+			}
+			return *this;
+		}
+		inline Hash& Add(const std::string& str)
+		{
+			uint64_t len = str.size(); // so that {"ab","c"} != {"a","bc"}
+			Add(&len, sizeof(len));
+			return Add(str.data(), str.size());
+		}
+		template<typename T>
+		inline Hash& AddValue(const T& val) { return Add(&val, sizeof(T)); }
+
+		inline uint64_t Get() const { return m_value; }
+		inline std::string ToString() const
+		{
+			char ret[17] = { 0 };
+			snprintf(ret, 17, "%016llx", (unsigned long long)m_value);
+			return std::string(ret);
+		}
+
+	private:
+		uint64_t m_value;
+	};
+}
@@ -0,0 +1,67 @@
+#include "IncludeCache.h"
+#include "FileCache.h"
+
+#include <algorithm>
+
+namespace ed
+{
+	IncludeCache::IncludeCache()
+	{
+		m_version = 0;
+	}
+	bool IncludeCache::Get(const std::string& path, std::string& content)
+	{
+		return FileCache::Instance().Get(path, content);
+	}
+	void IncludeCache::Clear()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_deps.clear();
+		m_version++;
+	}
+	void IncludeCache::SetDependencies(PipelineItem* item, const std::vector<std::string>& files)
+	{
+		std::vector<std::string> deps;
+		for (const auto& file : files) {
+			std::string path = Normalize(file);
+			if (std::count(deps.begin(), deps.end(), path) == 0)
+				deps.push_back(path);
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::vector<std::string>& cur = m_deps[item];
+		if (cur != deps) {
+			cur = deps;
+			m_version++;
+		}
+	}
+	void IncludeCache::RemoveDependencies(PipelineItem* item)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_deps.erase(item) > 0)
+			m_version++;
+	}
+	bool IncludeCache::DependsOn(PipelineItem* item, const std::string& file)
+	{
+		std::string path = Normalize(file);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_deps.find(item);
+		if (it == m_deps.end())
+			return false;
+
+		return std::count(it->second.begin(), it->second.end(), path) > 0;
+	}
+	std::vector<std::string> IncludeCache::GetDependencies(PipelineItem* item)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_deps.find(item);
+		if (it == m_deps.end())
+			return std::vector<std::string>();
+		return it->second;
+	}
+	std::string IncludeCache::Normalize(const std::string& path)
+	{
+		return FileCache::Normalize(path);
+	}
+}
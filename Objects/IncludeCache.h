@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+
+namespace ed
+{
+	struct PipelineItem;
+
+	// contents of the #include'd files (shared by the GLSL and the glslang paths) & which pipeline items include them
+	class IncludeCache
+	{
+	public:
+		static inline IncludeCache& Instance()
+		{
+			static IncludeCache ret;
+			return ret;
+		}
+
+		IncludeCache();
+
+		// goes through the FileCache, returns false if the file doesn't exist
+		bool Get(const std::string& path, std::string& content);
+		void Clear();
+
+		// dependency graph
+		void SetDependencies(PipelineItem* item, const std::vector<std::string>& files);
+		void RemoveDependencies(PipelineItem* item);
+		bool DependsOn(PipelineItem* item, const std::string& file);
+		std::vector<std::string> GetDependencies(PipelineItem* item);
+		inline int GetVersion() { return m_version; } // changes whenever the graph changes
+
+		static std::string Normalize(const std::string& path);
+
+	private:
+		std::mutex m_mutex; // used by the TranscompilerPool threads & the file tracker thread
+		std::unordered_map<PipelineItem*, std::vector<std::string>> m_deps;
+		std::atomic<int> m_version;
+	};
+}
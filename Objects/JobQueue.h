@@ -0,0 +1,88 @@
+#pragma once
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+namespace ed
+{
+	// bounded multi-producer multi-consumer queue
+	// Push() blocks while the queue is full, Pop() blocks while it is empty - both return false once the queue is closed
+	template<typename T>
+	class JobQueue
+	{
+	public:
+		JobQueue(size_t capacity = 16)
+		{
+			m_capacity = capacity == 0 ? 1 : capacity;
+			m_closed = false;
+		}
+
+		bool Push(const T& item)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_notFull.wait(lock, [&]() { return m_closed || m_items.size() < m_capacity; });
+
+				if (m_closed)
+					return false;
+
+				m_items.push_back(item);
+			}
+			m_notEmpty.notify_one();
+			return true;
+		}
+		// items that are still in the queue after Close() are returned before Pop() fails
+		bool Pop(T& item)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_notEmpty.wait(lock, [&]() { return m_closed || m_items.size() > 0; });
+
+				if (m_items.size() == 0)
+					return false;
+
+				item = m_items.front();
+				m_items.pop_front();
+			}
+			m_notFull.notify_one();
+			return true;
+		}
+		bool TryPop(T& item)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_items.size() == 0)
+					return false;
+
+				item = m_items.front();
+				m_items.pop_front();
+			}
+			m_notFull.notify_one();
+			return true;
+		}
+
+		void Close()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_closed = true;
+			}
+			m_notEmpty.notify_all();
+			m_notFull.notify_all();
+		}
+
+		inline size_t GetCapacity() { return m_capacity; }
+		size_t GetSize()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_items.size();
+		}
+
+	private:
+		size_t m_capacity;
+		bool m_closed;
+		std::deque<T> m_items;
+		std::mutex m_mutex;
+		std::condition_variable m_notEmpty, m_notFull;
+	};
+}
@@ -42,6 +42,7 @@ namespace ed
 		// message
 		data << msg;
 
+		std::lock_guard<std::mutex> lock(m_mutex);
 
 		if (Settings::Instance().General.PipeLogsToTerminal)
 			std::cout << data.str() << std::endl;
@@ -62,6 +63,8 @@ namespace ed
 		time_t now = time(0);
 		tm* ltm = localtime(&now);
 
+		std::lock_guard<std::mutex> lock(m_mutex);
+
 		std::ofstream file("log.txt");
 		file << "Log -> " << ltm->tm_mday << "." << ltm->tm_mon + 1 << "." << 1900 + ltm->tm_year << "\n";
 
@@ -1,6 +1,7 @@
 #pragma once
 #include "MessageStack.h"
 #include <string>
+#include <mutex>
 
 namespace ed
 {
@@ -23,5 +24,6 @@ namespace ed
 
 	private:
 		std::vector<std::string> m_msgs;
+		std::mutex m_mutex; // shaders are transcompiled on worker threads
 	};
 }
\ No newline at end of file
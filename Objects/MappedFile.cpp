@@ -0,0 +1,128 @@
+#include "MappedFile.h"
+#include <stdio.h>
+
+#if defined(_WIN32)
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+// smaller files are read into memory: if another program truncates a mapped file (saving a shader does),
+// reading the mapping raises SIGBUS - and on Windows the other program can't truncate it at all
+#define MAPPED_FILE_MIN_SIZE (1024 * 1024)
+
+namespace ed
+{
+	MappedFile::MappedFile()
+	{
+		m_isOpen = false;
+		m_data = "";
+		m_size = 0;
+		m_view = nullptr;
+#if defined(_WIN32)
+		m_mapping = nullptr;
+#endif
+	}
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	bool MappedFile::Open(const std::string& path)
+	{
+		Close();
+
+#if defined(_WIN32)
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize)) {
+			CloseHandle(file);
+			return false;
+		}
+		m_size = (size_t)fileSize.QuadPart;
+
+		if (m_size >= MAPPED_FILE_MIN_SIZE) {
+			m_mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (m_mapping != nullptr) {
+				m_view = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+				if (m_view == nullptr) {
+					CloseHandle(m_mapping);
+					m_mapping = nullptr;
+				}
+			}
+		}
+		CloseHandle(file);
+#else
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd == -1)
+			return false;
+
+		struct stat info;
+		if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+			close(fd);
+			return false;
+		}
+		m_size = (size_t)info.st_size;
+
+		if (m_size >= MAPPED_FILE_MIN_SIZE) {
+			void* view = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (view != MAP_FAILED) {
+				m_view = view;
+				madvise(m_view, m_size, MADV_SEQUENTIAL);
+			}
+		}
+		close(fd);
+#endif
+
+		if (m_view != nullptr)
+			m_data = (const char*)m_view;
+		else if (m_size > 0 && !m_readFile(path)) {
+			m_size = 0;
+			return false;
+		}
+
+		m_isOpen = true;
+		return true;
+	}
+	void MappedFile::Close()
+	{
+		if (m_view != nullptr) {
+#if defined(_WIN32)
+			UnmapViewOfFile(m_view);
+			CloseHandle(m_mapping);
+			m_mapping = nullptr;
+#else
+			munmap(m_view, m_size);
+#endif
+			m_view = nullptr;
+		}
+
+		m_buffer.clear();
+		m_buffer.shrink_to_fit();
+
+		m_isOpen = false;
+		m_data = "";
+		m_size = 0;
+	}
+
+	bool MappedFile::m_readFile(const std::string& path)
+	{
+		FILE* file = fopen(path.c_str(), "rb");
+		if (file == nullptr)
+			return false;
+
+		m_buffer.resize(m_size);
+		size_t read = fread(m_buffer.data(), 1, m_size, file);
+		fclose(file);
+
+		m_size = read;
+		m_data = m_buffer.data();
+		return true;
+	}
+}
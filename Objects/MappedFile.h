@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+namespace ed
+{
+	// read-only view of a whole file - large files (models, textures) are memory mapped, small ones or
+	// the ones that can't be mapped are read into memory
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const std::string& path);
+		void Close();
+
+		inline bool IsOpen() { return m_isOpen; }
+		inline const char* GetData() { return m_data; } // not null terminated
+		inline size_t GetSize() { return m_size; }
+
+	private:
+		bool m_readFile(const std::string& path);
+
+		bool m_isOpen;
+		const char* m_data;
+		size_t m_size;
+
+		void* m_view; // nullptr if the file wasn't mapped
+#if defined(_WIN32)
+		void* m_mapping;
+#endif
+		std::vector<char> m_buffer;
+	};
+}
@@ -0,0 +1,309 @@
+#include "MeshCache.h"
+#include "MappedFile.h"
+#include "Settings.h"
+#include "Logger.h"
+#include "Hash.h"
+#include "../Engine/Model.h"
+
+#include <ghc/filesystem.hpp>
+#include <algorithm>
+#include <fstream>
+#include <string.h>
+#include <stdint.h>
+
+#define MESH_CACHE_DIR "data/cache/meshes"
+#define MESH_CACHE_MAGIC 0x4D444553 // "SEDM"
+#define MESH_CACHE_VERSION 2
+
+namespace ed
+{
+	/*
+		MeshCacheHeader
+		MeshCacheDependency, path
+		...
+		MeshCacheEntry, name, vertices (Vertex[VertexCount]), indices (uint32_t[IndexCount])
+		...
+	*/
+	struct MeshCacheHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t VertexSize;
+		uint32_t MeshCount;
+		uint32_t DependencyCount;
+		float MinBound[3];
+		float MaxBound[3];
+	};
+	// other files that Assimp read during the import (.bin buffers, .mtl, ...) - the key only covers the model file
+	struct MeshCacheDependency
+	{
+		uint32_t PathLength;
+		uint32_t Reserved;
+		uint64_t Size;
+		uint64_t Hash;
+	};
+
+	static bool hashFile(const std::string& path, uint64_t& size, uint64_t& hash)
+	{
+		MappedFile file;
+		if (!file.Open(path))
+			return false;
+
+		size = file.GetSize();
+		hash = Hash().Add(file.GetData(), file.GetSize()).Get();
+		return true;
+	}
+	struct MeshCacheEntry
+	{
+		uint32_t NameLength;
+		uint32_t VertexCount;
+		uint32_t IndexCount;
+	};
+
+	MeshCache::MeshCache()
+	{
+		m_hits = m_misses = 0;
+	}
+	std::string MeshCache::GetKey(const std::string& path, unsigned int importFlags)
+	{
+		if (!Settings::Instance().General.MeshCache)
+			return "";
+
+		MappedFile file;
+		if (!file.Open(path))
+			return "";
+
+		Hash hash;
+		hash.AddValue<uint32_t>(MESH_CACHE_VERSION);
+		hash.AddValue<uint32_t>(sizeof(eng::Model::Mesh::Vertex));
+		hash.AddValue<uint32_t>(importFlags);
+		hash.Add(file.GetData(), file.GetSize());
+
+		return hash.ToString();
+	}
+	bool MeshCache::Load(const std::string& key, eng::Model& model)
+	{
+		if (key.empty() || !Settings::Instance().General.MeshCache)
+			return false;
+
+		std::string path = m_getPath(key);
+		MappedFile file;
+		if (!file.Open(path)) {
+			m_misses++;
+			return false;
+		}
+
+		const char* data = file.GetData();
+		size_t size = file.GetSize();
+
+		// check the whole file before creating any GL buffers
+		MeshCacheHeader header;
+		bool valid = size >= sizeof(header);
+		if (valid) {
+			memcpy(&header, data, sizeof(header));
+			valid = header.Magic == MESH_CACHE_MAGIC && header.Version == MESH_CACHE_VERSION && header.VertexSize == sizeof(eng::Model::Mesh::Vertex);
+		}
+
+		std::vector<std::pair<MeshCacheDependency, std::string>> dependencies;
+		size_t offset = sizeof(header);
+		for (uint32_t i = 0; valid && i < header.DependencyCount; i++) {
+			MeshCacheDependency dep;
+			if (size - offset < sizeof(dep)) {
+				valid = false;
+				break;
+			}
+			memcpy(&dep, data + offset, sizeof(dep));
+			offset += sizeof(dep);
+
+			if (dep.PathLength > size - offset) {
+				valid = false;
+				break;
+			}
+			dependencies.push_back(std::make_pair(dep, std::string(data + offset, dep.PathLength)));
+			offset += dep.PathLength;
+		}
+
+		std::vector<std::pair<MeshCacheEntry, size_t>> entries; // entry + offset of the name
+		for (uint32_t i = 0; valid && i < header.MeshCount; i++) {
+			MeshCacheEntry entry;
+			if (size - offset < sizeof(entry)) {
+				valid = false;
+				break;
+			}
+			memcpy(&entry, data + offset, sizeof(entry));
+			offset += sizeof(entry);
+
+			uint64_t entrySize = (uint64_t)entry.NameLength + (uint64_t)entry.VertexCount * header.VertexSize + (uint64_t)entry.IndexCount * sizeof(uint32_t);
+			if (entrySize > size - offset) {
+				valid = false;
+				break;
+			}
+
+			entries.push_back(std::make_pair(entry, offset));
+			offset += entrySize;
+		}
+
+		if (!valid || offset != size) {
+			file.Close();
+			Logger::Get().Log("Removing invalid mesh cache entry " + path, true);
+			std::error_code ec;
+			ghc::filesystem::remove(path, ec);
+			m_misses++;
+			return false;
+		}
+
+		// a changed side file doesn't change the key, the entry is stale
+		for (const auto& dep : dependencies) {
+			uint64_t depSize = 0, depHash = 0;
+			if (!hashFile(dep.second, depSize, depHash) || depSize != dep.first.Size || depHash != dep.first.Hash) {
+				file.Close();
+				Logger::Get().Log(dep.second + " has changed, removing the mesh cache entry " + path);
+				std::error_code ec;
+				ghc::filesystem::remove(path, ec);
+				m_misses++;
+				return false;
+			}
+		}
+
+		for (const auto& entry : entries) {
+			const char* ptr = data + entry.second;
+
+			std::string name(ptr, entry.first.NameLength);
+			ptr += entry.first.NameLength;
+
+			std::vector<eng::Model::Mesh::Vertex> vertices(entry.first.VertexCount);
+			memcpy(vertices.data(), ptr, vertices.size() * sizeof(eng::Model::Mesh::Vertex));
+			ptr += vertices.size() * sizeof(eng::Model::Mesh::Vertex);
+
+			std::vector<unsigned int> indices(entry.first.IndexCount);
+			memcpy(indices.data(), ptr, indices.size() * sizeof(unsigned int));
+
+			model.Meshes.push_back(eng::Model::Mesh(name, std::move(vertices), std::move(indices), std::vector<eng::Model::Mesh::Texture>()));
+		}
+
+		model.SetBounds(glm::vec3(header.MinBound[0], header.MinBound[1], header.MinBound[2]),
+			glm::vec3(header.MaxBound[0], header.MaxBound[1], header.MaxBound[2]));
+
+		file.Close();
+
+		// last write time is used for the LRU eviction
+		std::error_code ec;
+		ghc::filesystem::last_write_time(path, ghc::filesystem::file_time_type::clock::now(), ec);
+
+		m_hits++;
+		return true;
+	}
+	void MeshCache::Save(const std::string& key, eng::Model& model, const std::vector<std::string>& dependencies)
+	{
+		if (key.empty() || !Settings::Instance().General.MeshCache)
+			return;
+
+		// a side file that can't be read again can't be validated either
+		std::vector<MeshCacheDependency> deps(dependencies.size());
+		for (size_t i = 0; i < dependencies.size(); i++) {
+			deps[i].PathLength = dependencies[i].size();
+			deps[i].Reserved = 0;
+			if (!hashFile(dependencies[i], deps[i].Size, deps[i].Hash))
+				return;
+		}
+
+		std::error_code ec;
+		ghc::filesystem::create_directories(MESH_CACHE_DIR, ec);
+
+		std::ofstream file(m_getPath(key), std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			Logger::Get().Log("Failed to write the mesh cache entry " + m_getPath(key), true);
+			return;
+		}
+
+		glm::vec3 minBound = model.GetMinBound(), maxBound = model.GetMaxBound();
+
+		MeshCacheHeader header;
+		header.Magic = MESH_CACHE_MAGIC;
+		header.Version = MESH_CACHE_VERSION;
+		header.VertexSize = sizeof(eng::Model::Mesh::Vertex);
+		header.MeshCount = model.Meshes.size();
+		header.DependencyCount = deps.size();
+		for (int i = 0; i < 3; i++) {
+			header.MinBound[i] = minBound[i];
+			header.MaxBound[i] = maxBound[i];
+		}
+		file.write((const char*)&header, sizeof(header));
+
+		for (size_t i = 0; i < deps.size(); i++) {
+			file.write((const char*)&deps[i], sizeof(MeshCacheDependency));
+			file.write(dependencies[i].data(), dependencies[i].size());
+		}
+
+		for (const auto& mesh : model.Meshes) {
+			MeshCacheEntry entry;
+			entry.NameLength = mesh.Name.size();
+			entry.VertexCount = mesh.Vertices.size();
+			entry.IndexCount = mesh.Indices.size();
+			file.write((const char*)&entry, sizeof(entry));
+
+			file.write(mesh.Name.data(), mesh.Name.size());
+			file.write((const char*)mesh.Vertices.data(), mesh.Vertices.size() * sizeof(eng::Model::Mesh::Vertex));
+			file.write((const char*)mesh.Indices.data(), mesh.Indices.size() * sizeof(unsigned int));
+		}
+
+		bool written = (bool)file;
+		file.close();
+
+		if (!written) {
+			// disk full - don't leave a truncated file behind
+			Logger::Get().Log("Failed to write the mesh cache entry " + m_getPath(key), true);
+			ghc::filesystem::remove(m_getPath(key), ec);
+			return;
+		}
+
+		m_evict();
+	}
+	void MeshCache::Clear()
+	{
+		Logger::Get().Log("Clearing the mesh cache");
+
+		std::error_code ec;
+		ghc::filesystem::remove_all(MESH_CACHE_DIR, ec);
+		m_hits = m_misses = 0;
+	}
+	void MeshCache::m_evict()
+	{
+		struct Entry
+		{
+			ghc::filesystem::path Path;
+			ghc::filesystem::file_time_type Time;
+			uintmax_t Size;
+		};
+
+		std::error_code ec;
+		std::vector<Entry> entries;
+		uintmax_t total = 0;
+		for (const auto& entry : ghc::filesystem::directory_iterator(MESH_CACHE_DIR, ec)) {
+			if (!entry.is_regular_file(ec))
+				continue;
+
+			Entry e;
+			e.Path = entry.path();
+			e.Time = entry.last_write_time(ec);
+			e.Size = entry.file_size(ec);
+			total += e.Size;
+			entries.push_back(e);
+		}
+
+		uintmax_t limit = (uintmax_t)std::max<int>(Settings::Instance().General.MeshCacheSize, 1) * 1024 * 1024;
+		if (total <= limit)
+			return;
+
+		std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.Time < b.Time; });
+
+		for (size_t i = 0; i < entries.size() && total > limit; i++) {
+			ghc::filesystem::remove(entries[i].Path, ec);
+			total -= entries[i].Size;
+		}
+	}
+	std::string MeshCache::m_getPath(const std::string& key)
+	{
+		return std::string(MESH_CACHE_DIR) + "/" + key + ".mesh";
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace ed
+{
+	namespace eng
+	{
+		class Model;
+	}
+
+	// stores the meshes of imported 3D models in data/cache/meshes so that reopening
+	// a project doesn't have to run the Assimp import & post processing again
+	class MeshCache
+	{
+	public:
+		static inline MeshCache& Instance()
+		{
+			static MeshCache ret;
+			return ret;
+		}
+
+		MeshCache();
+
+		// key = hash of the model file + Assimp import flags, empty if the cache is disabled or the file can't be read
+		std::string GetKey(const std::string& path, unsigned int importFlags);
+
+		bool Load(const std::string& key, eng::Model& model); // fills model.Meshes and the bounds
+		void Save(const std::string& key, eng::Model& model, const std::vector<std::string>& dependencies); // dependencies = other files read by the import, checked by Load()
+		void Clear();
+
+		inline int GetHitCount() { return m_hits; }
+		inline int GetMissCount() { return m_misses; }
+
+	private:
+		void m_evict(); // remove the least recently used meshes until the cache fits in Settings::General.MeshCacheSize
+		std::string m_getPath(const std::string& key);
+
+		int m_hits, m_misses;
+	};
+}
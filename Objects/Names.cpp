@@ -266,6 +266,20 @@ const char* ATTRIBUTE_VALUE_NAMES[] = {
 	"Bitangent",
 	"Color"
 };
+const char* PASS_CACHE_MODE_NAMES[] = {
+	"Dynamic",
+	"Auto",
+	"Static"
+};
+const char* TEXTURE_FILTER_NAMES[] = {
+	"Nearest",
+	"Linear"
+};
+const char* TEXTURE_WRAP_NAMES[] = {
+	"Repeat",
+	"MirroredRepeat",
+	"ClampToEdge"
+};
 const char* EDITOR_SHORTCUT_NAMES[] =
 {
 	"Undo",
@@ -463,6 +477,17 @@ const unsigned int TOPOLOGY_ITEM_VALUES[] =
 	GL_TRIANGLES_ADJACENCY,
 	GL_TRIANGLE_STRIP_ADJACENCY
 };
+const unsigned int TEXTURE_FILTER_VALUES[] =
+{
+	GL_NEAREST,
+	GL_LINEAR
+};
+const unsigned int TEXTURE_WRAP_VALUES[] =
+{
+	GL_REPEAT,
+	GL_MIRRORED_REPEAT,
+	GL_CLAMP_TO_EDGE
+};
 
 namespace ed
 {
@@ -15,6 +15,9 @@ extern const char* STENCIL_OPERATION_NAMES[9];
 extern const char* CULL_MODE_NAMES[4];
 extern const char* FORMAT_NAMES[66];
 extern const char* ATTRIBUTE_VALUE_NAMES[6];
+extern const char* PASS_CACHE_MODE_NAMES[3];
+extern const char* TEXTURE_FILTER_NAMES[2];
+extern const char* TEXTURE_WRAP_NAMES[3];
 extern const char* EDITOR_SHORTCUT_NAMES[55];
 
 // VALUES //
@@ -25,6 +28,8 @@ extern const unsigned int COMPARISON_FUNCTION_VALUES[9];
 extern const unsigned int STENCIL_OPERATION_VALUES[9];
 extern const unsigned int CULL_MODE_VALUES[4];
 extern const unsigned int TOPOLOGY_ITEM_VALUES[10];
+extern const unsigned int TEXTURE_FILTER_VALUES[2];
+extern const unsigned int TEXTURE_WRAP_VALUES[3];
 
 namespace ed
 {
@@ -4,22 +4,75 @@
 #include "Logger.h"
 #include "../Engine/GLUtils.h"
 
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <string.h>
+#include <stdint.h>
+
 #include <SFML/Audio/Sound.hpp>
 #include <SFML/Audio/SoundBuffer.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 
+#define TEXTURE_UPLOAD_BUDGET (64 * 1024 * 1024) // bytes uploaded per frame while the textures are loading
+#define TEXTURE_PLACEHOLDER_COLOR 0.5f, 0.5f, 0.5f, 1.0f
+
 namespace ed
 {
+	static bool isCompressedFormatSupported(GLenum format)
+	{
+		switch (format) {
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+			return GLEW_EXT_texture_compression_s3tc;
+		case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+			return GLEW_EXT_texture_compression_s3tc && GLEW_EXT_texture_sRGB;
+		case GL_COMPRESSED_RED_RGTC1:
+		case GL_COMPRESSED_SIGNED_RED_RGTC1:
+		case GL_COMPRESSED_RG_RGTC2:
+		case GL_COMPRESSED_SIGNED_RG_RGTC2:
+			return true; // core since GL 3.0
+		case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+		case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+		case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+			return GLEW_ARB_texture_compression_bptc;
+		}
+		return false;
+	}
+	static int getMipCount(int width, int height)
+	{
+		int levels = 1;
+		for (int size = std::max(width, height); size > 1; size /= 2)
+			levels++;
+		return levels;
+	}
+
 	ObjectManager::ObjectManager(ProjectParser* parser, RenderEngine* rnd) :
 		m_parser(parser), m_renderer(rnd)
 	{
 		m_binds.clear();
+		m_indexDirty = true;
+		m_loadEpoch = 0;
+		m_texturesLoaded = 0;
+		m_uploadPBO = 0;
+		m_helperFBOs[0] = m_helperFBOs[1] = 0;
 	}
 	ObjectManager::~ObjectManager()
 	{
 		Clear();
+
+		if (m_uploadPBO != 0)
+			glDeleteBuffers(1, &m_uploadPBO);
+		if (m_helperFBOs[0] != 0)
+			glDeleteFramebuffers(2, m_helperFBOs);
 	}
 
 	void loadCubemapFace(GLuint face, const std::string& path, int& w, int& h)
@@ -72,8 +125,16 @@ namespace ed
 		
 		m_binds.clear();
 		m_uniformBinds.clear();
+		m_bindIDs.clear();
+		m_uniformBindIDs.clear();
 		m_items.clear();
 		m_itemData.clear();
+		m_names.clear();
+		m_slots.clear();
+		m_freeSlots.clear();
+		m_indexDirty = true;
+
+		m_loadEpoch++; // textures that are still being decoded belong to the old items
 	}
 	bool ObjectManager::CreateRenderTexture(const std::string & name)
 	{
@@ -87,8 +148,7 @@ namespace ed
 		m_parser->ModifyProject();
 
 		ObjectManagerItem* item = new ObjectManagerItem();
-		m_itemData.push_back(item);
-		m_items.push_back(name);
+		m_addItem(name, item);
 
 		ed::RenderTextureObject* rtObj = item->RT = new ed::RenderTextureObject();
 		glm::ivec2 size = m_renderer->GetLastRenderSize();
@@ -138,98 +198,60 @@ namespace ed
 			return false;
 		}
 
+		// only the header is read here, the pixels are decoded on the TextureLoader threads
 		std::string path = m_parser->GetProjectPath(file);
-		int width, height, nrChannels;
-		unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
-		unsigned char* paddedData = nullptr;
-
-		if (data == nullptr)
+		TextureLoader::Info info;
+		if (!TextureLoader::ReadInfo(path, info)) {
+			Logger::Get().Log("Failed to load a texture " + file + " from file", true);
 			return false;
+		}
+		if (info.Compressed && !isCompressedFormatSupported(info.Format)) {
+			Logger::Get().Log("Cannot create a texture " + file + " because the GPU doesn't support " + TextureLoader::GetFormatName(info.Format) + " textures", true);
+			return false;
+		}
 
 		m_parser->ModifyProject();
 
 		ObjectManagerItem* item = new ObjectManagerItem();
-		m_itemData.push_back(item);
-		m_items.push_back(file);
+		m_addItem(file, item);
 
 		item->IsTexture = true;
-
-		if (data == nullptr)
-			Logger::Get().Log("Failed to load a texture " + file + " from file", true);
-
-		GLenum fmt = GL_RGB;
-		if (nrChannels == 4)
-			fmt = GL_RGBA;
-		else if (nrChannels == 1)
-			fmt = GL_LUMINANCE;
-
-		if (nrChannels != 4) {
-			paddedData = (unsigned char*)malloc(width * height * 4);
-			for (int x = 0; x < width; x++) {
-				for (int y = 0; y < height; y++) {
-					if (nrChannels == 3) {
-						paddedData[(y * width + x) * 4 + 0] = data[(y * width + x) * 3 + 0];
-						paddedData[(y * width + x) * 4 + 1] = data[(y * width + x) * 3 + 1];
-						paddedData[(y * width + x) * 4 + 2] = data[(y * width + x) * 3 + 2];
-					} else if (nrChannels == 1) {
-						unsigned char val = data[(y * width + x) * 1 + 0];
-						paddedData[(y * width + x) * 4 + 0] = val;
-						paddedData[(y * width + x) * 4 + 1] = val;
-						paddedData[(y * width + x) * 4 + 2] = val;
-					}
-					paddedData[(y * width + x) * 4 + 3] = 255;
-				}
-			}
-		}
-
-		// normal texture
+		item->ImageSize = glm::ivec2(info.Width, info.Height);
+		item->TextureFormat = info.Format;
+		item->TextureCompressed = info.Compressed;
+		item->TextureLevels = item->FileLevels = info.Levels;
+
+		// allocate the storage now so that the GL name never changes - the texture shows a placeholder until the pixels are uploaded
+		// compressed levels are allocated when they are uploaded, the texture is incomplete (black) until then
+		// the flipped copy is only created if something asks for it (GetFlippedTexture)
 		glGenTextures(1, &item->Texture);
-		glBindTexture(GL_TEXTURE_2D, item->Texture);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexImage2D(GL_TEXTURE_2D,0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, paddedData == nullptr ? data : paddedData);
-		glBindTexture(GL_TEXTURE_2D, 0);
-
-
+		if (!info.Compressed)
+			m_allocateTexture(item->Texture, info.Width, info.Height, info.Format, info.Levels);
+		m_applySampler(item);
 
-		// flipped texture
-		unsigned char* flippedData = (unsigned char*)malloc(width * height * 4);
-
-		for (int x = 0; x < width; x++) {
-			for (int y = 0; y < height; y++) {
-				if (nrChannels == 4) { // use data
-					flippedData[(y * width + x) * 4 + 0] = data[((height - y - 1) * width + x) * 4 + 0];
-					flippedData[(y * width + x) * 4 + 1] = data[((height - y - 1) * width + x) * 4 + 1];
-					flippedData[(y * width + x) * 4 + 2] = data[((height - y - 1) * width + x) * 4 + 2];
-					flippedData[(y * width + x) * 4 + 3] = data[((height - y - 1) * width + x) * 4 + 3];
-				} else { // use paddedData
-					flippedData[(y * width + x) * 4 + 0] = paddedData[((height - y - 1) * width + x) * 4 + 0];
-					flippedData[(y * width + x) * 4 + 1] = paddedData[((height - y - 1) * width + x) * 4 + 1];
-					flippedData[(y * width + x) * 4 + 2] = paddedData[((height - y - 1) * width + x) * 4 + 2];
-					flippedData[(y * width + x) * 4 + 3] = paddedData[((height - y - 1) * width + x) * 4 + 3];
-				}
-			}
+		if (m_textureLoader.GetPendingCount() == 0) {
+			m_loadStart = std::chrono::steady_clock::now();
+			m_texturesLoaded = 0;
 		}
 
-		glGenTextures(1, &item->FlippedTexture);
-		glBindTexture(GL_TEXTURE_2D, item->FlippedTexture);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, flippedData);
-		glBindTexture(GL_TEXTURE_2D, 0);
-
-
-
-		item->ImageSize = glm::ivec2(width, height);
-
-		free(flippedData);
-		if (paddedData != nullptr)
-			free(paddedData);
-
-		stbi_image_free(data);
+		std::shared_ptr<TextureLoader::Task> task = std::make_shared<TextureLoader::Task>();
+		task->Owner = item->Handle;
+		task->Epoch = m_loadEpoch;
+		task->Name = file;
+		task->Path = path;
+		task->Header = info;
+		m_textureLoader.Add(task);
 
 		return true;
 	}
+	void ObjectManager::WaitForTextures()
+	{
+		while (m_textureLoader.GetPendingCount() > 0) {
+			m_uploadTextures(SIZE_MAX);
+			if (m_textureLoader.GetPendingCount() > 0)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
 	bool ObjectManager::CreateCubemap(const std::string& name, const std::string& left, const std::string& top, const std::string& front, const std::string& bottom, const std::string& right, const std::string& back)
 	{
 		Logger::Get().Log("Creating a cubemap " + name + " ...");
@@ -242,8 +264,7 @@ namespace ed
 		m_parser->ModifyProject();
 
 		ObjectManagerItem* item = new ObjectManagerItem();
-		m_itemData.push_back(item);
-		m_items.push_back(name);
+		m_addItem(name, item);
 
 		item->IsCube = true;
 
@@ -307,9 +328,8 @@ namespace ed
 			return false;
 		}
 
-		m_itemData.push_back(item);
 		m_parser->ModifyProject();
-		m_items.push_back(file);
+		m_addItem(file, item);
 
 		glGenTextures(1, &item->Texture);
 		glBindTexture(GL_TEXTURE_2D, item->Texture);
@@ -340,8 +360,7 @@ namespace ed
 		m_parser->ModifyProject();
 
 		ObjectManagerItem* item = new ObjectManagerItem();
-		m_itemData.push_back(item);
-		m_items.push_back(name);
+		m_addItem(name, item);
 
 		ed::BufferObject* bObj = item->Buffer = new ed::BufferObject();
 		glm::ivec2 size = m_renderer->GetLastRenderSize();
@@ -351,9 +370,7 @@ namespace ed
 		strcpy(bObj->ViewFormat, "float");
 
 		glGenBuffers(1, &bObj->ID);
-		glBindBuffer(GL_UNIFORM_BUFFER, bObj->ID);
-		glBufferData(GL_UNIFORM_BUFFER, 0, NULL, GL_STATIC_DRAW); // allocate 0 bytes of memory
-		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		UploadBuffer(bObj); // allocate 0 bytes of memory
 
 		return true;
 	}
@@ -369,8 +386,7 @@ namespace ed
 		m_parser->ModifyProject();
 
 		ObjectManagerItem* item = new ObjectManagerItem();
-		m_itemData.push_back(item);
-		m_items.push_back(name);
+		m_addItem(name, item);
 
 		ed::ImageObject* iObj = item->Image = new ImageObject();
 
@@ -398,8 +414,7 @@ namespace ed
 		m_parser->ModifyProject();
 
 		ObjectManagerItem* item = new ObjectManagerItem();
-		m_itemData.push_back(item);
-		m_items.push_back(name);
+		m_addItem(name, item);
 
 		ed::Image3DObject* iObj = item->Image3D = new Image3DObject();
 		iObj->Size = size;
@@ -426,8 +441,7 @@ namespace ed
 		m_parser->ModifyProject();
 
 		ObjectManagerItem* item = new ObjectManagerItem();
-		m_itemData.push_back(item);
-		m_items.push_back(name);
+		m_addItem(name, item);
 
 		PluginObject* pObj = item->Plugin = new PluginObject();
 		strcpy(pObj->Type, objtype.c_str());
@@ -501,6 +515,9 @@ namespace ed
 	
 	void ObjectManager::Update(float delta)
 	{
+		if (m_textureLoader.GetPendingCount() > 0 && m_uploadTextures(TEXTURE_UPLOAD_BUDGET) && m_renderer->IsPaused())
+			m_renderer->Render(); // show the new textures in the paused preview
+
 		for (auto& it : m_itemData) {
 			if (it->SoundBuffer == nullptr)
 				continue;
@@ -529,178 +546,140 @@ namespace ed
 	}
 	void ObjectManager::Remove(const std::string & file)
 	{
+		ObjectHandle handle = GetHandle(file);
+		ObjectManagerItem* item = GetObjectManagerItem(handle);
+		if (item == nullptr)
+			return;
+
 		m_parser->ModifyProject();
 
-		GLuint srv = GetTexture(file);
-		if (IsImage3D(file))
-			srv = GetImage3D(file)->Texture;
-		else if (IsImage(file))
-			srv = GetImage(file)->Texture;
-		else if (IsBuffer(file))
-			srv = GetBuffer(file)->ID;
-		else if (IsPluginObject(file))
-			srv = GetPluginObject(file)->ID;
-
-		for (auto& i : m_binds)
-			for (int j = 0; j < i.second.size(); j++)
-				if (i.second[j] == srv) {
-					i.second.erase(i.second.begin() + j);
-					j--;
-				}
-		for (auto& i : m_uniformBinds)
-			for (int j = 0; j < i.second.size(); j++)
-				if (i.second[j] == srv) {
-					i.second.erase(i.second.begin() + j);
-					j--;
-				}
-		
-		int index = 0;
-		for (; index < m_items.size(); index++)
-			if (m_items[index] == file) break;
+		m_removeHandle(m_binds, m_bindIDs, handle);
+		m_removeHandle(m_uniformBinds, m_uniformBindIDs, handle);
 
-		if (IsPluginObject(file)) {
-			PluginObject* pobj = GetPluginObject(file);
+		if (item->Plugin != nullptr) {
+			PluginObject* pobj = item->Plugin;
 			pobj->Owner->RemoveObject(file.c_str(), pobj->Type, pobj->Data, pobj->ID);
 		}
 
-		delete m_itemData[index];
+		// invalidate the handle - the slot can be reused by a new item
+		unsigned int slot = (handle & OBJECT_HANDLE_SLOT_MASK) - 1;
+		m_slots[slot].Item = nullptr;
+		m_slots[slot].Generation = (m_slots[slot].Generation + 1) & OBJECT_HANDLE_GENERATION_MASK;
+		m_freeSlots.push_back(slot);
+		m_names.erase(file);
+
+		int index = std::find(m_itemData.begin(), m_itemData.end(), item) - m_itemData.begin();
+		delete item;
 		m_itemData.erase(m_itemData.begin() + index);
 		m_items.erase(m_items.begin() + index);
+		m_indexDirty = true;
 	}
 
 	void ObjectManager::Bind(const std::string & file, PipelineItem * pass)
 	{
+		ObjectHandle handle = GetHandle(file);
+		if (handle == 0)
+			return;
+
 		if (IsBound(file, pass) == -1) {
 			m_parser->ModifyProject();
 
-			if (IsImage(file))
-				m_binds[pass].push_back(GetImage(file)->Texture);
-			else if (IsImage3D(file))
-				m_binds[pass].push_back(GetImage3D(file)->Texture);
-			else if (IsPluginObject(file))
-				m_binds[pass].push_back(GetPluginObject(file)->ID);
-			else
-				m_binds[pass].push_back(GetTexture(file));
+			m_binds[pass].push_back(handle);
+			m_updateBindIDs(m_binds, m_bindIDs, pass);
 		}
 	}
 	void ObjectManager::Unbind(const std::string & file, PipelineItem * pass)
 	{
-		std::vector<GLuint>& srvs = m_binds[pass];
-
-		GLuint srv = GetTexture(file);
-		if (IsImage(file))
-			srv = GetImage(file)->Texture;
-		else if (IsImage3D(file))
-			srv = GetImage3D(file)->Texture;
-		else if (IsPluginObject(file))
-			srv = GetPluginObject(file)->ID;
-
-		for (int i = 0; i < srvs.size(); i++)
-			if (srvs[i] == srv) {
-				m_parser->ModifyProject();
+		int index = IsBound(file, pass);
+		if (index != -1) {
+			m_parser->ModifyProject();
 
-				srvs.erase(srvs.begin() + i);
-				return;
-			}
+			std::vector<ObjectHandle>& srvs = m_binds[pass];
+			srvs.erase(srvs.begin() + index);
+			m_updateBindIDs(m_binds, m_bindIDs, pass);
+		}
 	}
 	int ObjectManager::IsBound(const std::string & file, PipelineItem * pass)
 	{
-		if (m_binds.count(pass) == 0)
+		auto it = m_binds.find(pass);
+		if (it == m_binds.end())
 			return -1;
 
-		if (IsImage(file)) {
-			for (int i = 0; i < m_binds[pass].size(); i++)
-				if (m_binds[pass][i] == GetImage(file)->Texture)
-					return i;
-		} else if (IsImage3D(file)) {
-			for (int i = 0; i < m_binds[pass].size(); i++)
-				if (m_binds[pass][i] == GetImage3D(file)->Texture)
-					return i;
-		} else if (IsPluginObject(file)) {
-			for (int i = 0; i < m_binds[pass].size(); i++)
-				if (m_binds[pass][i] == GetPluginObject(file)->ID)
-					return i;
-		} else {
-			for (int i = 0; i < m_binds[pass].size(); i++)
-				if (m_binds[pass][i] == GetTexture(file))
-					return i;
-		}
+		ObjectHandle handle = GetHandle(file);
+		for (int i = 0; i < it->second.size(); i++)
+			if (it->second[i] == handle)
+				return i;
 
 		return -1;
 	}
+	void ObjectManager::SwapBind(PipelineItem* pass, int first, int second)
+	{
+		std::vector<ObjectHandle>& srvs = m_binds[pass];
+		if (first < 0 || second < 0 || first >= srvs.size() || second >= srvs.size())
+			return;
+
+		m_parser->ModifyProject();
+
+		std::swap(srvs[first], srvs[second]);
+		m_updateBindIDs(m_binds, m_bindIDs, pass);
+	}
 
 	void ObjectManager::BindUniform(const std::string & file, PipelineItem * pass)
 	{
+		ObjectHandle handle = GetHandle(file);
+		if (handle == 0)
+			return;
+
 		if (IsUniformBound(file, pass) == -1) {
-			if (IsBuffer(file)) 
-				m_uniformBinds[pass].push_back(GetBuffer(file)->ID);
-			else if (IsImage3D(file))
-				m_uniformBinds[pass].push_back(GetImage3D(file)->Texture);
-			else if (IsPluginObject(file))
-				m_uniformBinds[pass].push_back(GetPluginObject(file)->ID);
-			else
-				m_uniformBinds[pass].push_back(GetImage(file)->Texture);
+			m_uniformBinds[pass].push_back(handle);
+			m_updateBindIDs(m_uniformBinds, m_uniformBindIDs, pass);
 
 			m_parser->ModifyProject();
 		}
 	}
 	void ObjectManager::UnbindUniform(const std::string & file, PipelineItem * pass)
 	{
-		std::vector<GLuint>& ubos = m_uniformBinds[pass];
-		GLuint itemID = 0;
+		int index = IsUniformBound(file, pass);
+		if (index != -1) {
+			std::vector<ObjectHandle>& ubos = m_uniformBinds[pass];
+			ubos.erase(ubos.begin() + index);
+			m_updateBindIDs(m_uniformBinds, m_uniformBindIDs, pass);
 
-		if (IsBuffer(file)) 
-			itemID = GetBuffer(file)->ID;
-		else if (IsImage3D(file))
-			itemID = GetImage3D(file)->Texture;
-		else if (IsPluginObject(file))
-			itemID = GetPluginObject(file)->ID;
-		else
-			itemID = GetImage(file)->Texture;
-		
-		for (int i = 0; i < ubos.size(); i++)
-			if (ubos[i] == itemID) {
-				ubos.erase(ubos.begin() + i);
-				m_parser->ModifyProject();
-				return;
-			}
+			m_parser->ModifyProject();
+		}
 	}
 	int ObjectManager::IsUniformBound(const std::string & file, PipelineItem * pass)
 	{
-		if (m_uniformBinds.count(pass) == 0)
+		auto it = m_uniformBinds.find(pass);
+		if (it == m_uniformBinds.end())
 			return -1;
 
-		GLuint itemID = 0;
-		if (IsBuffer(file)) 
-			itemID = GetBuffer(file)->ID;
-		else if (IsImage3D(file))
-			itemID = GetImage3D(file)->Texture;
-		else if (IsPluginObject(file))
-			itemID = GetPluginObject(file)->ID;
-		else
-			itemID = GetImage(file)->Texture;
-
-		for (int i = 0; i < m_uniformBinds[pass].size(); i++)
-			if (m_uniformBinds[pass][i] == itemID)
+		ObjectHandle handle = GetHandle(file);
+		for (int i = 0; i < it->second.size(); i++)
+			if (it->second[i] == handle)
 				return i;
 
 		return -1;
 	}
+	void ObjectManager::SwapUniformBind(PipelineItem* pass, int first, int second)
+	{
+		std::vector<ObjectHandle>& ubos = m_uniformBinds[pass];
+		if (first < 0 || second < 0 || first >= ubos.size() || second >= ubos.size())
+			return;
+
+		m_parser->ModifyProject();
+
+		std::swap(ubos[first], ubos[second]);
+		m_updateBindIDs(m_uniformBinds, m_uniformBindIDs, pass);
+	}
 
 	std::string ObjectManager::GetItemNameByTextureID(GLuint texID)
 	{
-		for (int i = 0; i < m_itemData.size(); i++) {
-			ObjectManagerItem* item = m_itemData[i];
-			if (item->Texture == texID ||
-				(item->Image != nullptr && item->Image->Texture == texID) ||
-				(item->Image3D != nullptr && item->Image3D->Texture == texID) ||
-				(item->Buffer != nullptr && item->Buffer->ID == texID))
-			{
-				return m_items[i];
-			}
-		}
+		IndexEntry* entry = m_findID(m_textureIndex, texID);
+		if (entry == nullptr)
+			entry = m_findID(m_bufferIndex, texID);
 
-		return "";
+		return entry == nullptr ? "" : entry->Item->Name;
 	}
 	glm::ivec2 ObjectManager::GetRenderTextureSize(const std::string & name)
 	{
@@ -710,251 +689,249 @@ namespace ed
 	}
 	const std::vector<std::string>& ObjectManager::GetCubemapTextures(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == name)
-				return m_itemData[i]->CubemapPaths;
-		return m_emptyCBTexs;
+		ObjectManagerItem* item = m_getItem(name);
+		return item == nullptr ? m_emptyCBTexs : item->CubemapPaths;
 	}
 
 	bool ObjectManager::IsRenderTexture(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == name)
-				return m_itemData[i]->RT != nullptr;
-		return false;
+		ObjectManagerItem* item = m_getItem(name);
+		return item != nullptr && item->RT != nullptr;
+	}
+	bool ObjectManager::IsTexture(const std::string& name)
+	{
+		ObjectManagerItem* item = m_getItem(name);
+		return item != nullptr && item->IsTexture;
 	}
 	bool ObjectManager::IsCubeMap(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == name)
-				return m_itemData[i]->IsCube;
-		return false;
+		ObjectManagerItem* item = m_getItem(name);
+		return item != nullptr && item->IsCube;
 	}
 	bool ObjectManager::IsAudio(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == name)
-				return m_itemData[i]->Sound != nullptr;
-		return false;
+		ObjectManagerItem* item = m_getItem(name);
+		return item != nullptr && item->Sound != nullptr;
 	}
 	bool ObjectManager::IsAudioMuted(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == name)
-				return m_itemData[i]->SoundMuted;
-		return false;
+		ObjectManagerItem* item = m_getItem(name);
+		return item != nullptr && item->SoundMuted;
 	}
 	bool ObjectManager::IsBuffer(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == name)
-				return m_itemData[i]->Buffer != nullptr;
-		return false;
+		ObjectManagerItem* item = m_getItem(name);
+		return item != nullptr && item->Buffer != nullptr;
 	}
 	bool ObjectManager::IsImage(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == name)
-				return m_itemData[i]->Image != nullptr;
-		return false;
+		ObjectManagerItem* item = m_getItem(name);
+		return item != nullptr && item->Image != nullptr;
 	}
 	bool ObjectManager::IsImage3D(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == name)
-				return m_itemData[i]->Image3D != nullptr;
-		return false;
+		ObjectManagerItem* item = m_getItem(name);
+		return item != nullptr && item->Image3D != nullptr;
 	}
 	bool ObjectManager::IsPluginObject(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == name)
-				return m_itemData[i]->Plugin != nullptr;
-		return false;
+		ObjectManagerItem* item = m_getItem(name);
+		return item != nullptr && item->Plugin != nullptr;
 	}
 	bool ObjectManager::IsPluginObject(GLuint id)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_itemData[i]->Plugin != nullptr && m_itemData[i]->Plugin->ID == id)
-				return true;
-		return false;
+		return m_findID(m_pluginIndex, id) != nullptr;
 	}
 	bool ObjectManager::IsCubeMap(GLuint id)
 	{
-		for (const auto& i : m_itemData)
-			if (i->Texture == id)
-				return i->IsCube;
-		return false;
+		IndexEntry* entry = m_findID(m_textureIndex, id);
+		return entry != nullptr && entry->Type == ObjectType::CubeMap;
 	}
 	bool ObjectManager::IsImage(GLuint id)
 	{
-		for (const auto& i : m_itemData)
-			if (i->Image != nullptr && i->Image->Texture == id)
-				return true;
-		return false;
+		IndexEntry* entry = m_findID(m_textureIndex, id);
+		return entry != nullptr && entry->Type == ObjectType::Image;
 	}
 	bool ObjectManager::IsImage3D(GLuint id)
 	{
-		for (const auto& i : m_itemData)
-			if (i->Image3D != nullptr && i->Image3D->Texture == id)
-				return true;
-		return false;
+		IndexEntry* entry = m_findID(m_textureIndex, id);
+		return entry != nullptr && entry->Type == ObjectType::Image3D;
+	}
+	bool ObjectManager::IsBuffer(GLuint id)
+	{
+		return m_findID(m_bufferIndex, id) != nullptr;
+	}
+	ObjectType ObjectManager::GetObjectTypeByTextureID(GLuint id)
+	{
+		IndexEntry* entry = m_findID(m_textureIndex, id);
+		return entry == nullptr ? ObjectType::Unknown : entry->Type;
 	}
 
 	GLuint ObjectManager::GetTexture(const std::string& file)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == file)
-				return m_itemData[i]->Texture;
-		return 0;
+		ObjectManagerItem* item = m_getItem(file);
+		return item == nullptr ? 0 : item->Texture;
 	}
 	GLuint ObjectManager::GetFlippedTexture(const std::string& file)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == file)
-				return m_itemData[i]->FlippedTexture;
-		return 0;
+		ObjectManagerItem* item = m_getItem(file);
+		if (item == nullptr)
+			return 0;
+
+		// BC6H & BC7 levels couldn't be flipped when they were loaded, they are already in the file's row order
+		if (item->IsTexture && item->TextureCompressed && !TextureLoader::CanFlip(item->TextureFormat, true))
+			return item->Texture;
+
+		if (item->IsTexture && item->FlippedTexture == 0) {
+			glGenTextures(1, &item->FlippedTexture);
+			if (item->TextureCompressed) {
+				if (item->TextureLoaded) // otherwise it's loaded together with Texture
+					m_loadFlippedCompressed(item, file);
+			} else {
+				m_allocateTexture(item->FlippedTexture, item->ImageSize.x, item->ImageSize.y, item->TextureFormat);
+				m_updateFlippedTexture(item);
+			}
+		}
+
+		return item->FlippedTexture;
 	}
 	glm::ivec2 ObjectManager::GetTextureSize(const std::string& file)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == file)
-				return m_itemData[i]->ImageSize;
-		return glm::ivec2(0,0);
+		ObjectManagerItem* item = m_getItem(file);
+		return item == nullptr ? glm::ivec2(0,0) : item->ImageSize;
 	}
 	sf::SoundBuffer* ObjectManager::GetSoundBuffer(const std::string& file)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == file)
-				return m_itemData[i]->SoundBuffer;
-		return nullptr;
+		ObjectManagerItem* item = m_getItem(file);
+		return item == nullptr ? nullptr : item->SoundBuffer;
 	}
 	sf::Sound* ObjectManager::GetAudioPlayer(const std::string& file)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == file)
-				return m_itemData[i]->Sound;
-		return nullptr;
+		ObjectManagerItem* item = m_getItem(file);
+		return item == nullptr ? nullptr : item->Sound;
 	}
 	BufferObject* ObjectManager::GetBuffer(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == name)
-				return m_itemData[i]->Buffer;
-		return nullptr;
+		ObjectManagerItem* item = m_getItem(name);
+		return item == nullptr ? nullptr : item->Buffer;
 	}
 	ImageObject* ObjectManager::GetImage(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == name)
-				return m_itemData[i]->Image;
-		return nullptr;
+		ObjectManagerItem* item = m_getItem(name);
+		return item == nullptr ? nullptr : item->Image;
 	}
 	Image3DObject* ObjectManager::GetImage3D(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == name)
-				return m_itemData[i]->Image3D;
-		return nullptr;
+		ObjectManagerItem* item = m_getItem(name);
+		return item == nullptr ? nullptr : item->Image3D;
 	}
 	glm::ivec2 ObjectManager::GetImageSize(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == name)
-				return m_itemData[i]->Image->Size;
-		return glm::ivec2(0,0);
+		ObjectManagerItem* item = m_getItem(name);
+		if (item == nullptr || item->Image == nullptr)
+			return glm::ivec2(0,0);
+		return item->Image->Size;
 	}
 	glm::ivec3 ObjectManager::GetImage3DSize(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == name)
-				return m_itemData[i]->Image3D->Size;
-		return glm::ivec3(0, 0, 0);
+		ObjectManagerItem* item = m_getItem(name);
+		if (item == nullptr || item->Image3D == nullptr)
+			return glm::ivec3(0, 0, 0);
+		return item->Image3D->Size;
 	}
 	RenderTextureObject* ObjectManager::GetRenderTexture(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == name)
-				return m_itemData[i]->RT;
-		return nullptr;
+		ObjectManagerItem* item = m_getItem(name);
+		return item == nullptr ? nullptr : item->RT;
 	}
 	PluginObject* ObjectManager::GetPluginObject(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == name)
-				return m_itemData[i]->Plugin;
-		return nullptr;
+		ObjectManagerItem* item = m_getItem(name);
+		return item == nullptr ? nullptr : item->Plugin;
 	}
 	PluginObject* ObjectManager::GetPluginObject(GLuint id)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_itemData[i]->Plugin != nullptr && m_itemData[i]->Plugin->ID == id)
-				return m_itemData[i]->Plugin;
-		return nullptr;
+		IndexEntry* entry = m_findID(m_pluginIndex, id);
+		return entry == nullptr ? nullptr : entry->Item->Plugin;
+	}
+	ImageObject* ObjectManager::GetImage(GLuint id)
+	{
+		IndexEntry* entry = m_findID(m_textureIndex, id);
+		return entry == nullptr ? nullptr : entry->Item->Image;
+	}
+	Image3DObject* ObjectManager::GetImage3D(GLuint id)
+	{
+		IndexEntry* entry = m_findID(m_textureIndex, id);
+		return entry == nullptr ? nullptr : entry->Item->Image3D;
 	}
 
 	RenderTextureObject* ObjectManager::GetRenderTexture(GLuint tex)
 	{
-		for (const auto& i : m_itemData)
-			if (i->Texture == tex)
-				return i->RT;
-		return nullptr;
+		IndexEntry* entry = m_findID(m_textureIndex, tex);
+		return entry == nullptr ? nullptr : entry->Item->RT;
 	}
 	std::string ObjectManager::GetBufferNameByID(int id)
 	{
-		for (int i = 0; i < m_itemData.size(); i++)
-			if (m_itemData[i]->Buffer != nullptr && m_itemData[i]->Buffer->ID == id)
-				return m_items[i];
-		return "";
+		IndexEntry* entry = m_findID(m_bufferIndex, id);
+		return entry == nullptr ? "" : entry->Item->Name;
 	}
 	std::string ObjectManager::GetImageNameByID(GLuint id)
 	{
-		for (int i = 0; i < m_itemData.size(); i++)
-			if (m_itemData[i]->Image != nullptr && m_itemData[i]->Image->Texture == id)
-				return m_items[i];
-		return "";
+		IndexEntry* entry = m_findID(m_textureIndex, id);
+		if (entry == nullptr || entry->Type != ObjectType::Image)
+			return "";
+		return entry->Item->Name;
 	}
 	std::string ObjectManager::GetImage3DNameByID(GLuint id)
 	{
-		for (int i = 0; i < m_itemData.size(); i++)
-			if (m_itemData[i]->Image3D != nullptr && m_itemData[i]->Image3D->Texture == id)
-				return m_items[i];
-		return "";
+		IndexEntry* entry = m_findID(m_textureIndex, id);
+		if (entry == nullptr || entry->Type != ObjectType::Image3D)
+			return "";
+		return entry->Item->Name;
 	}
 
 	ObjectManagerItem* ObjectManager::GetObjectManagerItem(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++)
-			if (m_items[i] == name)
-				return m_itemData[i];
-		return nullptr;
+		return m_getItem(name);
+	}
+	ObjectManagerItem* ObjectManager::GetObjectManagerItem(ObjectHandle handle)
+	{
+		unsigned int slot = handle & OBJECT_HANDLE_SLOT_MASK;
+		if (slot == 0 || slot > m_slots.size())
+			return nullptr;
+
+		const HandleSlot& data = m_slots[slot - 1];
+		if (data.Item == nullptr || data.Generation != (handle >> OBJECT_HANDLE_SLOT_BITS))
+			return nullptr;
+
+		return data.Item;
+	}
+	ObjectHandle ObjectManager::GetHandle(const std::string& name)
+	{
+		auto it = m_names.find(name);
+		if (it == m_names.end())
+			return 0;
+		return it->second;
 	}
 	std::string ObjectManager::GetObjectManagerItemName(ObjectManagerItem* item)
 	{
-		for (int i = 0; i < m_itemData.size(); i++)
-			if (m_itemData[i] == item)
-				return m_items[i];
-		return "";
+		return item == nullptr ? "" : item->Name;
 	}
 
 	void ObjectManager::Mute(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++) {
-			if (m_items[i] == name) {
-				m_itemData[i]->SoundMuted = true;
-				m_itemData[i]->Sound->setVolume(0);
-				break;
-			}
+		ObjectManagerItem* item = m_getItem(name);
+		if (item != nullptr && item->Sound != nullptr) {
+			item->SoundMuted = true;
+			item->Sound->setVolume(0);
 		}
 	}
 	void ObjectManager::Unmute(const std::string& name)
 	{
-		for (int i = 0; i < m_items.size(); i++) {
-			if (m_items[i] == name) {
-				m_itemData[i]->SoundMuted = false;
-				m_itemData[i]->Sound->setVolume(100);
-				break;
-			}
+		ObjectManagerItem* item = m_getItem(name);
+		if (item != nullptr && item->Sound != nullptr) {
+			item->SoundMuted = false;
+			item->Sound->setVolume(100);
 		}
 	}
 
@@ -1003,4 +980,442 @@ namespace ed
 		glTexImage3D(GL_TEXTURE_3D, 0, iobj->Format, iobj->Size.x, iobj->Size.y, iobj->Size.z, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 		glBindTexture(GL_TEXTURE_3D, 0);
 	}
+	void ObjectManager::UploadBuffer(BufferObject* buf)
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, buf->ID);
+		glBufferData(GL_UNIFORM_BUFFER, buf->Size, buf->Data, GL_STATIC_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+		// passes that read the buffer can't reuse their last result
+		m_renderer->TouchBuffer(buf->ID);
+	}
+	void ObjectManager::UpdateTextureSampler(const std::string& name)
+	{
+		ObjectManagerItem* item = m_getItem(name);
+		if (item == nullptr || !item->IsTexture)
+			return;
+
+		m_parser->ModifyProject();
+
+		// mip levels stored in the file are used as they are, the others are generated on the GPU
+		int levels = item->FileLevels;
+		if (item->Sampler.Mipmaps && levels == 1 && !item->TextureCompressed)
+			levels = getMipCount(item->ImageSize.x, item->ImageSize.y);
+		if (levels != item->TextureLevels)
+			m_reallocateTexture(item, levels);
+
+		m_applySampler(item);
+		m_renderer->TouchTexture(item->Texture);
+	}
+
+	ObjectManager::IndexEntry* ObjectManager::m_findID(std::unordered_map<GLuint, IndexEntry>& index, GLuint id)
+	{
+		if (m_indexDirty)
+			m_buildIndex();
+
+		auto it = index.find(id);
+		if (it == index.end())
+			return nullptr;
+		return &it->second;
+	}
+	void ObjectManager::m_buildIndex()
+	{
+		m_textureIndex.clear();
+		m_bufferIndex.clear();
+		m_pluginIndex.clear();
+
+		for (int i = 0; i < m_itemData.size(); i++) {
+			ObjectManagerItem* item = m_itemData[i];
+			IndexEntry entry;
+			entry.Item = item;
+
+			if (item->Plugin != nullptr) {
+				entry.Type = ObjectType::PluginObject;
+				m_pluginIndex[item->Plugin->ID] = entry;
+			} else if (item->Buffer != nullptr) {
+				entry.Type = ObjectType::Buffer;
+				m_bufferIndex[item->Buffer->ID] = entry;
+			} else if (item->Image != nullptr) {
+				entry.Type = ObjectType::Image;
+				m_textureIndex[item->Image->Texture] = entry;
+			} else if (item->Image3D != nullptr) {
+				entry.Type = ObjectType::Image3D;
+				m_textureIndex[item->Image3D->Texture] = entry;
+			} else if (item->Texture != 0) {
+				if (item->RT != nullptr)
+					entry.Type = ObjectType::RenderTexture;
+				else if (item->IsCube)
+					entry.Type = ObjectType::CubeMap;
+				else if (item->Sound != nullptr)
+					entry.Type = ObjectType::Audio;
+				else
+					entry.Type = ObjectType::Texture;
+				m_textureIndex[item->Texture] = entry;
+			}
+		}
+
+		m_indexDirty = false;
+	}
+
+	void ObjectManager::m_allocateTexture(GLuint tex, int width, int height, GLenum format, int levels)
+	{
+		glBindTexture(GL_TEXTURE_2D, tex);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+		if (GLEW_ARB_texture_storage)
+			glTexStorage2D(GL_TEXTURE_2D, levels, format, width, height);
+		else {
+			for (int i = 0; i < levels; i++)
+				glTexImage2D(GL_TEXTURE_2D, i, format, std::max(1, width >> i), std::max(1, height >> i), 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		// fill it with the placeholder color
+		GLint oldFBO = 0;
+		GLfloat oldClearColor[4];
+		GLboolean scissor = glIsEnabled(GL_SCISSOR_TEST);
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING, &oldFBO);
+		glGetFloatv(GL_COLOR_CLEAR_VALUE, oldClearColor);
+
+		if (m_helperFBOs[0] == 0)
+			glGenFramebuffers(2, m_helperFBOs);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_helperFBOs[0]);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+		glDisable(GL_SCISSOR_TEST);
+		glClearColor(TEXTURE_PLACEHOLDER_COLOR);
+		glClear(GL_COLOR_BUFFER_BIT);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, oldFBO);
+		glClearColor(oldClearColor[0], oldClearColor[1], oldClearColor[2], oldClearColor[3]);
+		if (scissor)
+			glEnable(GL_SCISSOR_TEST);
+
+		if (levels > 1) {
+			glBindTexture(GL_TEXTURE_2D, tex);
+			glGenerateMipmap(GL_TEXTURE_2D);
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
+	}
+	void ObjectManager::m_applySampler(ObjectManagerItem* item)
+	{
+		const TextureSampler& sampler = item->Sampler;
+		int levels = sampler.Mipmaps ? item->TextureLevels : 1;
+
+		GLint minFilter = sampler.MinFilter;
+		if (levels > 1)
+			minFilter = sampler.MinFilter == GL_NEAREST ? GL_NEAREST_MIPMAP_NEAREST : GL_LINEAR_MIPMAP_LINEAR;
+
+		glBindTexture(GL_TEXTURE_2D, item->Texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, sampler.MagFilter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, sampler.WrapS);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, sampler.WrapT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+	void ObjectManager::m_reallocateTexture(ObjectManagerItem* item, int levels)
+	{
+		int width = item->ImageSize.x, height = item->ImageSize.y;
+
+		GLuint tex = 0;
+		glGenTextures(1, &tex);
+		m_allocateTexture(tex, width, height, item->TextureFormat, levels);
+
+		// keep the pixels that were already uploaded
+		if (item->TextureLoaded) {
+			m_blitTexture(item->Texture, tex, width, height, false);
+			if (levels > 1) {
+				glBindTexture(GL_TEXTURE_2D, tex);
+				glGenerateMipmap(GL_TEXTURE_2D);
+				glBindTexture(GL_TEXTURE_2D, 0);
+			}
+		}
+
+		glDeleteTextures(1, &item->Texture);
+		item->Texture = tex;
+		item->TextureLevels = levels;
+
+		m_indexDirty = true;
+		m_refreshHandle(item->Handle);
+	}
+	void ObjectManager::m_loadFlippedCompressed(ObjectManagerItem* item, const std::string& name)
+	{
+		TextureLoader::Task task;
+		task.Name = name;
+		task.Path = m_parser->GetProjectPath(name);
+		task.Header.Container = true;
+		task.Flip = false;
+		m_textureLoader.Run(task);
+
+		if (task.Failed || task.Header.Format != item->TextureFormat || task.Levels.size() == 0) {
+			Logger::Get().Log("Failed to create the flipped copy of " + name, true);
+			return;
+		}
+
+		// same parameters as the flipped copies of the uncompressed textures
+		glBindTexture(GL_TEXTURE_2D, item->FlippedTexture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		m_uploadCompressed(item->FlippedTexture, item->TextureFormat, task, 1);
+		m_renderer->TouchTexture(item->FlippedTexture);
+	}
+	void ObjectManager::m_updateFlippedTexture(ObjectManagerItem* item)
+	{
+		m_blitTexture(item->Texture, item->FlippedTexture, item->ImageSize.x, item->ImageSize.y, true);
+		m_renderer->TouchTexture(item->FlippedTexture);
+	}
+	void ObjectManager::m_blitTexture(GLuint src, GLuint dst, int width, int height, bool flip)
+	{
+		GLint oldReadFBO = 0, oldDrawFBO = 0;
+		GLboolean scissor = glIsEnabled(GL_SCISSOR_TEST);
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &oldReadFBO);
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &oldDrawFBO);
+
+		if (m_helperFBOs[0] == 0)
+			glGenFramebuffers(2, m_helperFBOs);
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_helperFBOs[1]);
+		glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, src, 0);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_helperFBOs[0]);
+		glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dst, 0);
+		glDisable(GL_SCISSOR_TEST);
+		if (flip)
+			glBlitFramebuffer(0, 0, width, height, 0, height, width, 0, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		else
+			glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_helperFBOs[1]);
+		glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, oldReadFBO);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, oldDrawFBO);
+		if (scissor)
+			glEnable(GL_SCISSOR_TEST);
+	}
+	void* ObjectManager::m_mapUploadBuffer(size_t size)
+	{
+		// orphan the previous upload so that the driver can copy it to the texture while this one is being filled
+		if (m_uploadPBO == 0)
+			glGenBuffers(1, &m_uploadPBO);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_uploadPBO);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+		void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+		if (dst == nullptr)
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		return dst;
+	}
+	void ObjectManager::m_uploadPixels(GLuint tex, int level, const unsigned char* pixels, int width, int height)
+	{
+		size_t size = (size_t)width * height * 4;
+		void* dst = m_mapUploadBuffer(size);
+
+		glBindTexture(GL_TEXTURE_2D, tex);
+		if (dst != nullptr) {
+			memcpy(dst, pixels, size);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		} else
+			glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+	void ObjectManager::m_uploadCompressed(GLuint tex, GLenum format, TextureLoader::Task& task, int levelCount)
+	{
+		levelCount = std::min<int>(levelCount, (int)task.Levels.size());
+
+		// pack all the levels into one upload
+		size_t size = 0;
+		for (int i = 0; i < levelCount; i++)
+			size += task.Levels[i].Size;
+
+		unsigned char* dst = (unsigned char*)m_mapUploadBuffer(size);
+		if (dst != nullptr) {
+			size_t offset = 0;
+			for (int i = 0; i < levelCount; i++) {
+				const TextureLoader::Level& level = task.Levels[i];
+				memcpy(dst + offset, task.Data.data() + level.Offset, level.Size);
+				offset += level.Size;
+			}
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		}
+
+		glBindTexture(GL_TEXTURE_2D, tex);
+		size_t offset = 0;
+		for (int i = 0; i < levelCount; i++) {
+			const TextureLoader::Level& level = task.Levels[i];
+			const void* data = dst != nullptr ? (const void*)offset : (const void*)(task.Data.data() + level.Offset);
+			glCompressedTexImage2D(GL_TEXTURE_2D, i, format, level.Width, level.Height, 0, (GLsizei)level.Size, data);
+			offset += level.Size;
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		if (dst != nullptr)
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+	bool ObjectManager::m_uploadTextures(size_t budget)
+	{
+		bool uploadedAny = false;
+		size_t uploaded = 0;
+
+		std::shared_ptr<TextureLoader::Task> task;
+		while (uploaded < budget && m_textureLoader.Poll(task)) {
+			ObjectManagerItem* item = GetObjectManagerItem(task->Owner);
+			if (task->Epoch != m_loadEpoch || item == nullptr)
+				continue; // removed while it was loading
+
+			if (task->Failed) {
+				Logger::Get().Log("Failed to load a texture " + task->Name + " from file", true);
+				continue;
+			}
+			if (task->Width != item->ImageSize.x || task->Height != item->ImageSize.y ||
+				task->Header.Format != item->TextureFormat || task->Header.Levels != item->FileLevels) {
+				Logger::Get().Log("Texture " + task->Name + " was modified while it was loading", true);
+				continue;
+			}
+
+			auto uploadStart = std::chrono::steady_clock::now();
+			if (item->TextureCompressed)
+				m_uploadCompressed(item->Texture, item->TextureFormat, *task, (int)task->Levels.size());
+			else if (task->Levels.size() > 0) {
+				for (int i = 0; i < task->Levels.size(); i++) {
+					const TextureLoader::Level& level = task->Levels[i];
+					m_uploadPixels(item->Texture, i, task->Data.data() + level.Offset, level.Width, level.Height);
+				}
+			} else
+				m_uploadPixels(item->Texture, 0, task->Pixels, task->Width, task->Height);
+
+			if (item->TextureLevels > item->FileLevels) {
+				glBindTexture(GL_TEXTURE_2D, item->Texture);
+				glGenerateMipmap(GL_TEXTURE_2D);
+				glBindTexture(GL_TEXTURE_2D, 0);
+			}
+			m_applySampler(item);
+			item->TextureLoaded = true;
+
+			if (item->FlippedTexture != 0) { // requested while the texture was still loading
+				if (item->TextureCompressed)
+					m_loadFlippedCompressed(item, task->Name);
+				else
+					m_updateFlippedTexture(item);
+			}
+			auto uploadEnd = std::chrono::steady_clock::now();
+
+			m_renderer->TouchTexture(item->Texture);
+
+			char report[512];
+			snprintf(report, sizeof(report), "Loaded texture %s (%dx%d, %s, %d levels): decoded in %.1f ms, uploaded in %.1f ms, ready %.1f ms after it was added",
+				task->Name.c_str(), task->Width, task->Height, TextureLoader::GetFormatName(item->TextureFormat), item->TextureLevels, task->DecodeTime,
+				std::chrono::duration<float, std::milli>(uploadEnd - uploadStart).count(),
+				std::chrono::duration<float, std::milli>(uploadEnd - task->QueueTime).count());
+			Logger::Get().Log(report);
+
+			uploaded += task->Data.size() > 0 ? task->Data.size() : (size_t)task->Width * task->Height * 4;
+			uploadedAny = true;
+			m_texturesLoaded++;
+		}
+		task = nullptr;
+
+		if (uploadedAny && m_textureLoader.GetPendingCount() == 0) {
+			float loadTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_loadStart).count();
+
+			// VRAM that the flipped copies and uncompressed levels would have taken
+			size_t saved = 0, used = 0, savedCompressed = 0;
+			for (ObjectManagerItem* it : m_itemData) {
+				if (!it->IsTexture)
+					continue;
+
+				if (it->FlippedTexture == 0 && !it->TextureCompressed)
+					saved += (size_t)it->ImageSize.x * it->ImageSize.y * 4;
+
+				for (int i = 0; i < it->TextureLevels; i++) {
+					int w = std::max(1, it->ImageSize.x >> i), h = std::max(1, it->ImageSize.y >> i);
+					size_t levelSize = TextureLoader::GetLevelSize(it->TextureFormat, it->TextureCompressed, w, h);
+					used += levelSize;
+					savedCompressed += (size_t)w * h * 4 - levelSize;
+				}
+			}
+
+			Logger::Get().Log("Loaded " + std::to_string(m_texturesLoaded) + " textures in " + std::to_string((int)loadTime) + " ms, " +
+				std::to_string(used / (1024 * 1024)) + " MB of VRAM used, " +
+				std::to_string(saved / (1024 * 1024)) + " MB saved by not creating flipped copies, " +
+				std::to_string(savedCompressed / (1024 * 1024)) + " MB saved by block compression");
+		}
+
+		return uploadedAny;
+	}
+	void ObjectManager::m_addItem(const std::string& name, ObjectManagerItem* item)
+	{
+		unsigned int slot = 0;
+		if (m_freeSlots.empty()) {
+			slot = m_slots.size();
+			m_slots.push_back(HandleSlot());
+			m_slots[slot].Generation = 0;
+		} else {
+			slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+
+		m_slots[slot].Item = item;
+
+		item->Name = name;
+		item->Handle = (m_slots[slot].Generation << OBJECT_HANDLE_SLOT_BITS) | (slot + 1);
+
+		m_names[name] = item->Handle;
+		m_items.push_back(name);
+		m_itemData.push_back(item);
+		m_indexDirty = true;
+	}
+	ObjectManagerItem* ObjectManager::m_getItem(const std::string& name)
+	{
+		return GetObjectManagerItem(GetHandle(name));
+	}
+	GLuint ObjectManager::m_getID(ObjectManagerItem* item)
+	{
+		if (item->Plugin != nullptr)
+			return item->Plugin->ID;
+		if (item->Buffer != nullptr)
+			return item->Buffer->ID;
+		if (item->Image != nullptr)
+			return item->Image->Texture;
+		if (item->Image3D != nullptr)
+			return item->Image3D->Texture;
+		return item->Texture;
+	}
+	void ObjectManager::m_updateBindIDs(std::unordered_map<PipelineItem*, std::vector<ObjectHandle>>& binds, std::unordered_map<PipelineItem*, std::vector<GLuint>>& ids, PipelineItem* pass)
+	{
+		const std::vector<ObjectHandle>& handles = binds[pass];
+		std::vector<GLuint>& out = ids[pass];
+
+		out.resize(handles.size());
+		for (int i = 0; i < handles.size(); i++) {
+			ObjectManagerItem* item = GetObjectManagerItem(handles[i]);
+			out[i] = item == nullptr ? 0 : m_getID(item);
+		}
+	}
+	void ObjectManager::m_refreshHandle(ObjectHandle handle)
+	{
+		for (auto& bind : m_binds)
+			if (std::find(bind.second.begin(), bind.second.end(), handle) != bind.second.end())
+				m_updateBindIDs(m_binds, m_bindIDs, bind.first);
+		for (auto& bind : m_uniformBinds)
+			if (std::find(bind.second.begin(), bind.second.end(), handle) != bind.second.end())
+				m_updateBindIDs(m_uniformBinds, m_uniformBindIDs, bind.first);
+	}
+	void ObjectManager::m_removeHandle(std::unordered_map<PipelineItem*, std::vector<ObjectHandle>>& binds, std::unordered_map<PipelineItem*, std::vector<GLuint>>& ids, ObjectHandle handle)
+	{
+		for (auto& bind : binds) {
+			std::vector<ObjectHandle>& handles = bind.second;
+			auto last = std::remove(handles.begin(), handles.end(), handle);
+			if (last != handles.end()) {
+				handles.erase(last, handles.end());
+				m_updateBindIDs(binds, ids, bind.first);
+			}
+		}
+	}
 }
\ No newline at end of file
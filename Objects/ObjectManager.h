@@ -10,11 +10,33 @@
 #include "PipelineItem.h"
 #include "ProjectParser.h"
 #include "AudioAnalyzer.h"
+#include "TextureLoader.h"
+
+#include <chrono>
 
 namespace ed
 {
 	class RenderEngine;
 
+	enum class ObjectType
+	{
+		Unknown,
+		Texture,
+		CubeMap,
+		RenderTexture,
+		Audio,
+		Buffer,
+		Image,
+		Image3D,
+		PluginObject
+	};
+
+	// slot index + 1 in the lower bits, generation of the slot in the upper bits - 0 is never a valid handle
+	typedef unsigned int ObjectHandle;
+	#define OBJECT_HANDLE_SLOT_BITS 20
+	#define OBJECT_HANDLE_SLOT_MASK ((1u << OBJECT_HANDLE_SLOT_BITS) - 1)
+	#define OBJECT_HANDLE_GENERATION_MASK ((1u << (32 - OBJECT_HANDLE_SLOT_BITS)) - 1)
+
 	struct RenderTextureObject
 	{
 		GLuint DepthStencilBuffer, DepthStencilBufferMS, BufferMS; // ColorBuffer is stored in ObjectManager
@@ -71,6 +93,16 @@ namespace ed
 		void* Data;
 	};
 
+	struct TextureSampler
+	{
+		TextureSampler() : MinFilter(GL_LINEAR), MagFilter(GL_NEAREST),
+			WrapS(GL_REPEAT), WrapT(GL_REPEAT), Mipmaps(false) {}
+
+		GLint MinFilter, MagFilter; // GL_NEAREST or GL_LINEAR - the mip filter is added when Mipmaps is on
+		GLint WrapS, WrapT;
+		bool Mipmaps; // generated on the GPU unless the file already has them
+	};
+
 	/* Use this to remove all the maps */
 	class ObjectManagerItem
 	{
@@ -81,6 +113,10 @@ namespace ed
 			FlippedTexture = 0;
 			IsCube = false;
 			IsTexture = false;
+			TextureFormat = GL_RGBA8;
+			TextureCompressed = false;
+			TextureLevels = FileLevels = 1;
+			TextureLoaded = false;
 			CubemapPaths.clear();
 			SoundBuffer = nullptr;
 			Sound = nullptr;
@@ -90,6 +126,7 @@ namespace ed
 			Image = nullptr;
 			Image3D = nullptr;
 			Plugin = nullptr;
+			Handle = 0;
 		}
 		~ObjectManagerItem() {
 			if (Buffer != nullptr) {
@@ -134,6 +171,14 @@ namespace ed
 		bool IsCube;
 		bool IsTexture;
 		std::vector<std::string> CubemapPaths;
+
+		// IsTexture only
+		TextureSampler Sampler;
+		GLenum TextureFormat;
+		bool TextureCompressed;
+		int TextureLevels; // mip levels of Texture
+		int FileLevels; // mip levels stored in the file
+		bool TextureLoaded;
 		
 		sf::SoundBuffer* SoundBuffer;
 		sf::Sound* Sound;
@@ -145,6 +190,9 @@ namespace ed
 		Image3DObject* Image3D;
 
 		PluginObject* Plugin;
+
+		std::string Name;
+		ObjectHandle Handle;
 	};
 
 	class ObjectManager
@@ -164,11 +212,16 @@ namespace ed
 
 		void Update(float delta);
 
+		// textures are decoded in the background and uploaded in Update()
+		inline bool IsLoadingTextures() { return m_textureLoader.GetPendingCount() > 0; }
+		void WaitForTextures(); // upload all of them now
+
 		void Remove(const std::string& file);
 		
 		glm::ivec2 GetRenderTextureSize(const std::string& name);
 		RenderTextureObject* GetRenderTexture(GLuint tex);
 		bool IsRenderTexture(const std::string& name);
+		bool IsTexture(const std::string& name); // loaded from an image file
 		bool IsCubeMap(const std::string& name);
 		bool IsAudio(const std::string& name);
 		bool IsAudioMuted(const std::string& name);
@@ -180,16 +233,20 @@ namespace ed
 		bool IsImage3D(GLuint id);
 		bool IsImage(GLuint id);
 		bool IsCubeMap(GLuint id);
+		bool IsBuffer(GLuint id);
+		ObjectType GetObjectTypeByTextureID(GLuint id);
 
 		void ResizeRenderTexture(const std::string& name, glm::ivec2 size);
+		void UpdateTextureSampler(const std::string& name); // call after changing ObjectManagerItem::Sampler
 		void ResizeImage(const std::string& name, glm::ivec2 size);
 		void ResizeImage3D(const std::string& name, glm::ivec3 size);
+		void UploadBuffer(BufferObject* buf); // call after changing BufferObject::Data or Size
 
 		void Clear();
 
 		const std::vector<std::string>& GetObjects() { return m_items; }
 		GLuint GetTexture(const std::string& file);
-		GLuint GetFlippedTexture(const std::string& file);
+		GLuint GetFlippedTexture(const std::string& file); // created on first use
 		glm::ivec2 GetTextureSize(const std::string& file);
 		sf::SoundBuffer* GetSoundBuffer(const std::string& file);
 		sf::Sound* GetAudioPlayer(const std::string& file);
@@ -202,11 +259,15 @@ namespace ed
 		glm::ivec3 GetImage3DSize(const std::string& name);
 
 		PluginObject* GetPluginObject(GLuint id);
+		ImageObject* GetImage(GLuint id);
+		Image3DObject* GetImage3D(GLuint id);
 		std::string GetBufferNameByID(int id);
 		std::string GetImageNameByID(GLuint id);
 		std::string GetImage3DNameByID(GLuint id);
 
 		ObjectManagerItem* GetObjectManagerItem(const std::string& name);
+		ObjectManagerItem* GetObjectManagerItem(ObjectHandle handle); // nullptr if the object was removed
+		ObjectHandle GetHandle(const std::string& name);
 		std::string GetObjectManagerItemName(ObjectManagerItem* item);
 		
 		void Mute(const std::string& name);
@@ -219,20 +280,34 @@ namespace ed
 		void Bind(const std::string& file, PipelineItem* pass);
 		void Unbind(const std::string& file, PipelineItem* pass);
 		int IsBound(const std::string& file, PipelineItem* pass);
-		inline std::vector<GLuint>& GetBindList(PipelineItem* pass) {
-			if (m_binds.count(pass) > 0) return m_binds[pass];
+		void SwapBind(PipelineItem* pass, int first, int second);
+		inline const std::vector<GLuint>& GetBindList(PipelineItem* pass) {
+			auto it = m_bindIDs.find(pass);
+			if (it != m_bindIDs.end()) return it->second;
 			return m_emptyResVec;
 		}
+		inline const std::vector<ObjectHandle>& GetBindHandles(PipelineItem* pass) {
+			auto it = m_binds.find(pass);
+			if (it != m_binds.end()) return it->second;
+			return m_emptyHandleVec;
+		}
 
 		void BindUniform(const std::string& file, PipelineItem* pass);
 		void UnbindUniform(const std::string& file, PipelineItem* pass);
 		int IsUniformBound(const std::string& file, PipelineItem* pass);
-		inline std::vector<GLuint>& GetUniformBindList(PipelineItem* pass) {
-			if (m_uniformBinds.count(pass) > 0) return m_uniformBinds[pass];
+		void SwapUniformBind(PipelineItem* pass, int first, int second);
+		inline const std::vector<GLuint>& GetUniformBindList(PipelineItem* pass) {
+			auto it = m_uniformBindIDs.find(pass);
+			if (it != m_uniformBindIDs.end()) return it->second;
 			return m_emptyResVec;
 		}
+		inline const std::vector<ObjectHandle>& GetUniformBindHandles(PipelineItem* pass) {
+			auto it = m_uniformBinds.find(pass);
+			if (it != m_uniformBinds.end()) return it->second;
+			return m_emptyHandleVec;
+		}
 
-		inline bool Exists(const std::string& name) { return std::count(m_items.begin(), m_items.end(), name) > 0; }
+		inline bool Exists(const std::string& name) { return m_names.count(name) > 0; }
 
 		const std::vector<std::string>& GetCubemapTextures(const std::string& name);
 		inline std::vector<ObjectManagerItem*>& GetItemDataList() { return m_itemData; }
@@ -241,17 +316,69 @@ namespace ed
 		RenderEngine* m_renderer;
 		ProjectParser* m_parser;
 
-		std::vector<std::string> m_items; // TODO: move item name to item data
+		// m_items & m_itemData only keep the order in which the objects were added
+		// lookups go through the name -> handle map and the handle table
+		std::vector<std::string> m_items;
 		std::vector<ObjectManagerItem*> m_itemData; 
 
+		struct HandleSlot
+		{
+			ObjectManagerItem* Item;
+			unsigned int Generation;
+		};
+		void m_addItem(const std::string& name, ObjectManagerItem* item);
+		ObjectManagerItem* m_getItem(const std::string& name);
+		std::vector<HandleSlot> m_slots;
+		std::vector<unsigned int> m_freeSlots;
+		std::unordered_map<std::string, ObjectHandle> m_names;
+
 		std::vector<GLuint> m_emptyResVec;
+		std::vector<ObjectHandle> m_emptyHandleVec;
 		std::vector<char> m_emptyResVecChar;
 		std::vector<std::string> m_emptyCBTexs;
 
+		TextureLoader m_textureLoader;
+		unsigned int m_loadEpoch; // increased by Clear()
+		int m_texturesLoaded;
+		std::chrono::steady_clock::time_point m_loadStart;
+		GLuint m_uploadPBO;
+		GLuint m_helperFBOs[2]; // draw, read - placeholder fill & flipped copies
+		void m_allocateTexture(GLuint tex, int width, int height, GLenum format = GL_RGBA8, int levels = 1);
+		void m_applySampler(ObjectManagerItem* item);
+		void m_reallocateTexture(ObjectManagerItem* item, int levels); // the GL name changes
+		void m_blitTexture(GLuint src, GLuint dst, int width, int height, bool flip);
+		void m_updateFlippedTexture(ObjectManagerItem* item); // copies Texture to FlippedTexture upside down
+		void* m_mapUploadBuffer(size_t size); // binds the upload PBO, returns nullptr if it can't be mapped
+		void m_uploadPixels(GLuint tex, int level, const unsigned char* pixels, int width, int height);
+		void m_uploadCompressed(GLuint tex, GLenum format, TextureLoader::Task& task, int levelCount);
+		void m_loadFlippedCompressed(ObjectManagerItem* item, const std::string& name); // BCn blocks can't be blitted, FlippedTexture gets the levels in the file's row order
+		bool m_uploadTextures(size_t budget); // returns true if a texture was uploaded
+
 		ed::AudioAnalyzer m_audioAnalyzer;
 		float m_audioTempTexData[ed::AudioAnalyzer::SampleCount * 2];
 
-		std::unordered_map<PipelineItem*, std::vector<GLuint>> m_binds;
-		std::unordered_map<PipelineItem*, std::vector<GLuint>> m_uniformBinds;
+		// bind lists store handles, the GL names used while rendering are resolved when a list changes
+		std::unordered_map<PipelineItem*, std::vector<ObjectHandle>> m_binds;
+		std::unordered_map<PipelineItem*, std::vector<ObjectHandle>> m_uniformBinds;
+		std::unordered_map<PipelineItem*, std::vector<GLuint>> m_bindIDs;
+		std::unordered_map<PipelineItem*, std::vector<GLuint>> m_uniformBindIDs;
+		GLuint m_getID(ObjectManagerItem* item);
+		void m_updateBindIDs(std::unordered_map<PipelineItem*, std::vector<ObjectHandle>>& binds, std::unordered_map<PipelineItem*, std::vector<GLuint>>& ids, PipelineItem* pass);
+		void m_refreshHandle(ObjectHandle handle); // the GL name of the object changed
+		void m_removeHandle(std::unordered_map<PipelineItem*, std::vector<ObjectHandle>>& binds, std::unordered_map<PipelineItem*, std::vector<GLuint>>& ids, ObjectHandle handle);
+
+		// GL name -> item lookups used while rendering, rebuilt after items are added or removed
+		// textures, buffers and plugin objects have separate name spaces so each one gets its own map
+		struct IndexEntry
+		{
+			ObjectType Type;
+			ObjectManagerItem* Item;
+		};
+		IndexEntry* m_findID(std::unordered_map<GLuint, IndexEntry>& index, GLuint id);
+		void m_buildIndex();
+		bool m_indexDirty;
+		std::unordered_map<GLuint, IndexEntry> m_textureIndex;
+		std::unordered_map<GLuint, IndexEntry> m_bufferIndex;
+		std::unordered_map<GLuint, IndexEntry> m_pluginIndex;
 	};
 }
\ No newline at end of file
@@ -97,6 +97,8 @@ namespace ed
 				RTCount = 0;
 				GSUsed = false;
 				Active = true;
+				Batching = false;
+				Cache = CacheMode::Dynamic;
 				Macros.clear();
 				memset(VSPath, 0, sizeof(char) * MAX_PATH);
 				memset(PSPath, 0, sizeof(char) * MAX_PATH);
@@ -112,6 +114,16 @@ namespace ed
 			GLuint FBO; // actual framebuffer
 
 			bool Active;
+			bool Batching; // draw geometry items that only differ in transform with one instanced draw call
+
+			// Dynamic -> always render, Auto -> render only when the inputs change, Static -> render once (until the pass or its size changes)
+			enum class CacheMode
+			{
+				Dynamic,
+				Auto,
+				Static
+			};
+			CacheMode Cache;
 
 			char VSPath[MAX_PATH];
 			char VSEntry[32];
@@ -1,5 +1,6 @@
 #include "PipelineManager.h"
 #include "ProjectParser.h"
+#include "RenderEngine.h"
 #include "Logger.h"
 #include "../Options.h"
 #include "SystemVariableManager.h"
@@ -19,9 +20,10 @@ int strcmpcase(const char* s1, const char* s2)
 
 namespace ed
 {
-	PipelineManager::PipelineManager(ProjectParser* project)
+	PipelineManager::PipelineManager(ProjectParser* project, RenderEngine* renderer)
 	{
 		m_project = project;
+		m_renderer = renderer;
 	}
 	PipelineManager::~PipelineManager()
 	{
@@ -32,6 +34,8 @@ namespace ed
 		Logger::Get().Log("Clearing PipelineManager contents");
 
 		for (int i = 0; i < m_items.size(); i++) {
+			m_renderer->RemoveItemCache(m_items[i]);
+
 			if (m_items[i]->Type == PipelineItem::ItemType::ShaderPass) {
 				// delete pass' child items and their data
 				pipe::ShaderPass* pass = (pipe::ShaderPass*)m_items[i]->Data;
@@ -194,6 +198,8 @@ namespace ed
 			m_items.push_back(pitem);
 			strcpy(pitem->Name, name);
 
+			m_renderer->AddItemCache(pitem);
+
 			return true;
 		}
 
@@ -213,6 +219,8 @@ namespace ed
 		m_items.push_back(new PipelineItem("\0", PipelineItem::ItemType::ShaderPass, data));
 		strcpy(m_items.at(m_items.size() - 1)->Name, name);
 
+		m_renderer->AddItemCache(m_items.back());
+
 		return true;
 	}
 	bool PipelineManager::AddComputePass(const char *name, pipe::ComputePass *data)
@@ -229,6 +237,8 @@ namespace ed
 		m_items.push_back(new PipelineItem("\0", PipelineItem::ItemType::ComputePass, data));
 		strcpy(m_items.at(m_items.size() - 1)->Name, name);
 
+		m_renderer->AddItemCache(m_items.back());
+
 		return true;
 	}
 	bool PipelineManager::AddAudioPass(const char *name, pipe::AudioPass *data)
@@ -245,6 +255,8 @@ namespace ed
 		m_items.push_back(new PipelineItem("\0", PipelineItem::ItemType::AudioPass, data));
 		strcpy(m_items.at(m_items.size() - 1)->Name, name);
 
+		m_renderer->AddItemCache(m_items.back());
+
 		return true;
 	}
 	void PipelineManager::Remove(const char* name)
@@ -253,6 +265,8 @@ namespace ed
 		
 		for (int i = 0; i < m_items.size(); i++) {
 			if (strcmp(m_items[i]->Name, name) == 0) {
+				m_renderer->RemoveItemCache(m_items[i]);
+
 				if (m_items[i]->Type == PipelineItem::ItemType::ShaderPass) {
 					pipe::ShaderPass* data = (pipe::ShaderPass*)m_items[i]->Data;
 					glDeleteFramebuffers(1, &data->FBO);
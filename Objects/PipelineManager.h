@@ -6,12 +6,13 @@
 namespace ed
 {
 	class ProjectParser;
+	class RenderEngine;
 
 	class PipelineManager
 	{
 	public:
 
-		PipelineManager(ProjectParser* project);
+		PipelineManager(ProjectParser* project, RenderEngine* renderer);
 		~PipelineManager();
 
 		void Clear();
@@ -34,6 +35,7 @@ namespace ed
 	private:
 
 		ProjectParser* m_project;
+		RenderEngine* m_renderer;
 		std::vector<PipelineItem*> m_items;
 	};
 }
\ No newline at end of file
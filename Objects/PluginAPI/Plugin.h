@@ -18,6 +18,7 @@ namespace ed
 		typedef void (*RemoveObjectFn)(void* objects, const char* name);
 
 		typedef void (*GetProjectPathFn)(void* project, const char* filename, char* out);
+		typedef int (*LoadProjectFileFn)(void* project, const char* filename, char* out, int outSize); // returns the file size or -1, out can be nullptr
 		typedef void (*GetRelativePathFn)(void* project, const char* filename, char* out);
 		typedef void (*GetProjectFilenameFn)(void* project, char* out);
 		typedef const char* (*GetProjectDirectoryFn)(void* project);
@@ -253,5 +254,8 @@ namespace ed
 		pluginfn::GetOpenDirectoryDialogFn GetOpenDirectoryDialog;
 		pluginfn::GetOpenFileDialogFn GetOpenFileDialog;
 		pluginfn::GetSaveFileDialogFn GetSaveFileDialog;
+
+		// plugin API version 2+
+		pluginfn::LoadProjectFileFn LoadProjectFile;
 	};
 }
\ No newline at end of file
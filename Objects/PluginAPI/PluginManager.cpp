@@ -2,7 +2,9 @@
 #include "../Logger.h"
 #include "../Settings.h"
 #include "../DefaultState.h"
+#include "../GLState.h"
 #include "../SystemVariableManager.h"
+#include "../FileCache.h"
 #include "../../InterfaceManager.h"
 #include "../../GUIManager.h"
 #include "../../UI/CodeEditorUI.h"
@@ -392,6 +394,7 @@ namespace ed
 					h = tsize.y;
 				};
 				plugin->BindDefaultState = []() {
+					GLState::Instance().Invalidate(); // the plugin might have changed the state on its own
 					DefaultState::Bind();
 				};
 				plugin->OpenInCodeEditor = [](void* codeed, void* item, const char* filename, int id) {
@@ -438,6 +441,21 @@ namespace ed
 					return ret;
 				};
 
+				// older plugins don't have the fields that were added after their API version
+				if (apiVer >= 2) {
+					// reads the file through the FileCache
+					plugin->LoadProjectFile = [](void* project, const char* filename, char* out, int outSize) -> int {
+						ProjectParser* proj = (ProjectParser*)project;
+						std::string content;
+						if (!FileCache::Instance().Get(proj->GetProjectPath(filename), content))
+							return -1;
+
+						if (out != nullptr && outSize > 0)
+							memcpy(out, content.data(), std::min<size_t>(content.size(), outSize));
+						return (int)content.size();
+					};
+				}
+
 				// now we can add the plugin and the proc to the list, init the plugin, etc...
 				plugin->Init();
 				m_plugins.push_back(plugin);
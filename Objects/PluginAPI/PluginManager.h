@@ -6,7 +6,7 @@
 #include <vector>
 #include <string>
 
-#define CURRENT_PLUGINAPI_VERSION 1
+#define CURRENT_PLUGINAPI_VERSION 2
 
 namespace ed
 {
@@ -0,0 +1,248 @@
+#include "Profiler.h"
+#include "PipelineItem.h"
+#include "Logger.h"
+
+#include <fstream>
+#include <iomanip>
+
+namespace ed
+{
+	static const char* STAGE_NAMES[] = { "Item", "Uniforms", "FBO", "Plugin" };
+
+	static std::string escapeJSON(const std::string& str)
+	{
+		std::string ret;
+		ret.reserve(str.size());
+		for (char c : str) {
+			if (c == '"' || c == '\\')
+				ret += '\\';
+			if ((unsigned char)c < 0x20)
+				continue;
+			ret += c;
+		}
+		return ret;
+	}
+
+	Profiler::Profiler()
+	{
+		m_enabled = m_requestEnabled = m_inFrame = false;
+		m_frameTiming = m_requestFrameTiming = false;
+		m_curFrame = 0;
+		m_curItem = -1;
+		m_frameCPU = m_frameGPU = 0.0f;
+		m_epoch = std::chrono::high_resolution_clock::now();
+
+		for (int i = 0; i < PROFILER_QUERY_RING_SIZE; i++) {
+			m_ring[i].Pending = false;
+			m_ring[i].QueryCount = 0;
+		}
+		for (int i = 0; i < (int)Stage::Count; i++)
+			m_stageStart[i] = 0.0;
+	}
+	Profiler::~Profiler()
+	{
+		for (int i = 0; i < PROFILER_QUERY_RING_SIZE; i++)
+			if (m_ring[i].Queries.size() > 0)
+				glDeleteQueries(m_ring[i].Queries.size(), m_ring[i].Queries.data());
+	}
+
+	void Profiler::BeginFrame()
+	{
+		// only toggle between frames
+		m_enabled = m_requestEnabled;
+		m_frameTiming = m_requestEnabled || m_requestFrameTiming;
+		if (!m_frameTiming)
+			return;
+
+		m_curFrame = (m_curFrame + 1) % PROFILER_QUERY_RING_SIZE;
+		Frame& frame = m_ring[m_curFrame];
+
+		// this slot was used PROFILER_QUERY_RING_SIZE frames ago - its queries should be done by now
+		if (frame.Pending)
+			m_resolve(frame);
+
+		frame.CPU.clear();
+		frame.GPU.clear();
+		frame.Items.clear();
+		frame.QueryCount = 0;
+		frame.Start = m_now();
+		glQueryCounter(m_query(frame), GL_TIMESTAMP);
+
+		m_curItem = -1;
+		m_inFrame = true;
+	}
+	void Profiler::EndFrame()
+	{
+		if (!m_inFrame)
+			return;
+
+		EndItem();
+
+		Frame& frame = m_ring[m_curFrame];
+		glQueryCounter(m_query(frame), GL_TIMESTAMP);
+		frame.Duration = m_now() - frame.Start;
+		frame.Pending = true;
+
+		m_inFrame = false;
+	}
+
+	void Profiler::BeginItem(PipelineItem* item)
+	{
+		if (!m_inFrame || !m_enabled)
+			return;
+
+		EndItem();
+
+		Frame& frame = m_ring[m_curFrame];
+		frame.CPU.push_back({ item->Name, Stage::Item, m_now(), 0.0 });
+		frame.Items.push_back(item->Name);
+		m_curItem = frame.CPU.size() - 1;
+
+		glQueryCounter(m_query(frame), GL_TIMESTAMP);
+	}
+	void Profiler::EndItem()
+	{
+		if (!m_inFrame || m_curItem == -1)
+			return;
+
+		Frame& frame = m_ring[m_curFrame];
+		glQueryCounter(m_query(frame), GL_TIMESTAMP);
+
+		Event& ev = frame.CPU[m_curItem];
+		ev.Duration = m_now() - ev.Start;
+
+		m_curItem = -1;
+	}
+
+	void Profiler::BeginStage(Stage stage)
+	{
+		if (!m_inFrame || !m_enabled)
+			return;
+
+		m_stageStart[(int)stage] = m_now();
+	}
+	void Profiler::EndStage(Stage stage)
+	{
+		if (!m_inFrame || !m_enabled)
+			return;
+
+		double start = m_stageStart[(int)stage];
+		m_ring[m_curFrame].CPU.push_back({ STAGE_NAMES[(int)stage], stage, start, m_now() - start });
+	}
+
+	bool Profiler::ExportTrace(const std::string& file)
+	{
+		std::ofstream out(file);
+		if (!out.is_open()) {
+			Logger::Get().Log("Failed to export profiler trace to " + file, true);
+			return false;
+		}
+
+		out << std::fixed << std::setprecision(3);
+		out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+		out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}}," << std::endl;
+		out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+		auto writeEvent = [&](const std::string& name, const char* cat, int tid, double start, double dur) {
+			out << "," << std::endl << "{\"name\":\"" << escapeJSON(name) << "\",\"cat\":\"" << cat << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+				<< ",\"ts\":" << start << ",\"dur\":" << dur << "}";
+		};
+
+		for (const auto& frame : m_history) {
+			writeEvent("Frame", "frame", 1, frame.Start, frame.Duration);
+			for (const auto& ev : frame.CPU)
+				writeEvent(ev.Name, STAGE_NAMES[(int)ev.Type], 1, ev.Start, ev.Duration);
+			for (const auto& ev : frame.GPU)
+				writeEvent(ev.Name, "gpu", 2, ev.Start, ev.Duration);
+		}
+
+		out << std::endl << "]}" << std::endl;
+		out.close();
+
+		Logger::Get().Log("Exported profiler trace (" + std::to_string(m_history.size()) + " frames) to " + file);
+
+		return true;
+	}
+
+	void Profiler::Clear()
+	{
+		m_history.clear();
+		m_results.clear();
+		m_frameCPU = m_frameGPU = 0.0f;
+	}
+
+	double Profiler::m_now()
+	{
+		return std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - m_epoch).count();
+	}
+	GLuint Profiler::m_query(Frame& frame)
+	{
+		if (frame.QueryCount >= frame.Queries.size()) {
+			GLuint query = 0;
+			glGenQueries(1, &query);
+			frame.Queries.push_back(query);
+		}
+		return frame.Queries[frame.QueryCount++];
+	}
+	void Profiler::m_resolve(Frame& frame)
+	{
+		frame.Pending = false;
+
+		// timestamps complete in order -> if the last one is available, all of them are
+		// never wait for the GPU here, just drop the GPU times if they are late
+		GLint available = 0;
+		if (frame.QueryCount > 0)
+			glGetQueryObjectiv(frame.Queries[frame.QueryCount - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+		std::vector<GLuint64> stamps;
+		if (available) {
+			stamps.resize(frame.QueryCount);
+			for (int i = 0; i < frame.QueryCount; i++)
+				glGetQueryObjectui64v(frame.Queries[i], GL_QUERY_RESULT, &stamps[i]);
+
+			// GPU events are placed relative to the start of the CPU frame
+			frame.GPU.push_back({ "Frame", Stage::Item, frame.Start, (stamps[frame.QueryCount - 1] - stamps[0]) / 1000.0 });
+			for (int i = 0; i < frame.Items.size() && 2 + i * 2 < frame.QueryCount - 1; i++) {
+				GLuint64 start = stamps[1 + i * 2], end = stamps[2 + i * 2];
+				frame.GPU.push_back({ frame.Items[i], Stage::Item, frame.Start + (start - stamps[0]) / 1000.0, (end - start) / 1000.0 });
+			}
+		}
+
+		// build per item results
+		m_results.clear();
+		int itemIndex = 0;
+		for (const auto& ev : frame.CPU) {
+			if (ev.Type == Stage::Item) {
+				ItemTime time;
+				time.Name = ev.Name;
+				time.GPU = (1 + itemIndex < frame.GPU.size()) ? frame.GPU[1 + itemIndex].Duration / 1000.0f : -1.0f;
+				for (int i = 0; i < (int)Stage::Count; i++)
+					time.CPU[i] = 0.0f;
+				time.CPU[(int)Stage::Item] = ev.Duration / 1000.0f;
+				m_results.push_back(time);
+				itemIndex++;
+			}
+			else if (m_results.size() > 0)
+				m_results.back().CPU[(int)ev.Type] += ev.Duration / 1000.0f;
+		}
+
+		m_frameCPU = frame.Duration / 1000.0f;
+		m_frameGPU = available ? frame.GPU[0].Duration / 1000.0f : -1.0f;
+
+		// frame timing only
+		if (!m_enabled)
+			return;
+
+		// keep the events for the trace export
+		Frame hist;
+		hist.Pending = false;
+		hist.Start = frame.Start;
+		hist.Duration = frame.Duration;
+		hist.CPU = frame.CPU;
+		hist.GPU = frame.GPU;
+		hist.QueryCount = 0;
+		m_history.push_back(hist);
+		while (m_history.size() > PROFILER_HISTORY_SIZE)
+			m_history.pop_front();
+	}
+}
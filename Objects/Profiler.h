@@ -0,0 +1,107 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <chrono>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <GL/glew.h>
+#if defined(__APPLE__)
+	#include <OpenGL/gl.h>
+#else
+	#include <GL/gl.h>
+#endif
+
+#define PROFILER_QUERY_RING_SIZE 4 // GPU results are read this many frames later
+#define PROFILER_HISTORY_SIZE 120 // number of frames kept for the trace export
+
+namespace ed
+{
+	struct PipelineItem;
+
+	class Profiler
+	{
+	public:
+		Profiler();
+		~Profiler();
+
+		enum class Stage
+		{
+			Item,		// whole pipeline item
+			Uniforms,	// binding shader variables
+			FBO,		// creating/updating the shader pass FBO
+			Plugin,		// plugin's ExecutePipelineItem
+			Count
+		};
+
+		struct ItemTime
+		{
+			std::string Name;
+			float GPU; // ms, -1 if the GPU result wasn't ready in time
+			float CPU[(int)Stage::Count]; // ms
+		};
+
+		inline void SetEnabled(bool enabled) { m_requestEnabled = enabled; }
+		inline bool IsEnabled() { return m_requestEnabled; }
+		// only measure the GPU time of whole frames (GetFrameGPUTime) - used by the dynamic resolution
+		inline void SetFrameTimingEnabled(bool enabled) { m_requestFrameTiming = enabled; }
+
+		void BeginFrame();
+		void EndFrame();
+
+		void BeginItem(PipelineItem* item);
+		void EndItem();
+
+		void BeginStage(Stage stage);
+		void EndStage(Stage stage);
+
+		// results of the last resolved frame
+		inline const std::vector<ItemTime>& GetResults() { return m_results; }
+		inline float GetFrameCPUTime() { return m_frameCPU; }
+		inline float GetFrameGPUTime() { return m_frameGPU; }
+
+		// chrome://tracing compatible .json file
+		bool ExportTrace(const std::string& file);
+
+		void Clear();
+
+	private:
+		struct Event
+		{
+			std::string Name;
+			Stage Type;
+			double Start; // us
+			double Duration; // us
+		};
+		struct Frame
+		{
+			bool Pending;
+			double Start; // us
+			double Duration; // us
+			std::vector<Event> CPU;
+			std::vector<Event> GPU;
+			std::vector<std::string> Items; // item name for each begin/end query pair
+			std::vector<GLuint> Queries; // [0] is the frame begin, then a begin/end pair for each item, [QueryCount - 1] is the frame end
+			int QueryCount;
+		};
+
+		double m_now();
+		GLuint m_query(Frame& frame);
+		void m_resolve(Frame& frame);
+
+		bool m_enabled, m_requestEnabled, m_inFrame;
+		bool m_frameTiming, m_requestFrameTiming;
+		int m_curFrame;
+		Frame m_ring[PROFILER_QUERY_RING_SIZE];
+		std::deque<Frame> m_history;
+		std::chrono::time_point<std::chrono::high_resolution_clock> m_epoch;
+
+		int m_curItem; // index in m_ring[m_curFrame].CPU, -1 if no item is being profiled
+		double m_stageStart[(int)Stage::Count];
+
+		std::vector<ItemTime> m_results;
+		float m_frameCPU, m_frameGPU;
+	};
+}
@@ -0,0 +1,205 @@
+#include "ProgramBinaryCache.h"
+#include "Settings.h"
+#include "Logger.h"
+#include "Hash.h"
+
+#include <ghc/filesystem.hpp>
+#include <algorithm>
+#include <fstream>
+#include <stdint.h>
+
+#define PROGRAM_CACHE_DIR "data/cache/programs"
+#define PROGRAM_CACHE_MAGIC 0x50444553 // "SEDP"
+#define PROGRAM_CACHE_VERSION 1
+
+namespace ed
+{
+	struct ProgramBinaryHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t Format;
+		uint32_t Length;
+	};
+
+	ProgramBinaryCache::ProgramBinaryCache()
+	{
+		m_checked = m_supported = false;
+		m_hits = m_misses = 0;
+	}
+	bool ProgramBinaryCache::IsEnabled()
+	{
+		if (!Settings::Instance().General.ProgramCache)
+			return false;
+
+		if (!m_checked) {
+			m_checked = true;
+
+			GLint formatCount = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+			m_supported = formatCount > 0;
+
+			// binaries are only valid for the driver that created them
+			const char* vendor = (const char*)glGetString(GL_VENDOR);
+			const char* renderer = (const char*)glGetString(GL_RENDERER);
+			const char* version = (const char*)glGetString(GL_VERSION);
+			m_driver = std::string(vendor ? vendor : "") + "|" + std::string(renderer ? renderer : "") + "|" + std::string(version ? version : "");
+
+			if (!m_supported)
+				Logger::Get().Log("Driver doesn't support program binaries - program cache disabled");
+		}
+
+		return m_supported;
+	}
+	std::string ProgramBinaryCache::GetKey(const std::vector<std::string>& sources)
+	{
+		if (!IsEnabled())
+			return "";
+
+		Hash hash;
+		hash.Add(m_driver);
+		for (const auto& src : sources)
+			hash.Add(src);
+
+		return hash.ToString();
+	}
+	GLuint ProgramBinaryCache::Load(const std::string& key)
+	{
+		if (key.empty() || !IsEnabled())
+			return 0;
+
+		std::string path = m_getPath(key);
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open()) {
+			m_misses++;
+			return 0;
+		}
+
+		ProgramBinaryHeader header;
+		file.read((char*)&header, sizeof(header));
+		if (!file || header.Magic != PROGRAM_CACHE_MAGIC || header.Version != PROGRAM_CACHE_VERSION || header.Length == 0) {
+			file.close();
+			Logger::Get().Log("Removing invalid program binary " + path, true);
+			std::error_code ec;
+			ghc::filesystem::remove(path, ec);
+			m_misses++;
+			return 0;
+		}
+
+		std::vector<char> data(header.Length);
+		file.read(data.data(), header.Length);
+		bool readAll = (bool)file;
+		file.close();
+
+		GLuint program = 0;
+		if (readAll) {
+			program = glCreateProgram();
+			glProgramBinary(program, header.Format, data.data(), header.Length);
+
+			GLint linked = 0;
+			glGetProgramiv(program, GL_LINK_STATUS, &linked);
+			if (!linked) {
+				glDeleteProgram(program);
+				program = 0;
+			}
+		}
+
+		std::error_code ec;
+		if (program == 0) {
+			// driver update or corrupted file
+			ghc::filesystem::remove(path, ec);
+			m_misses++;
+			return 0;
+		}
+
+		// last write time is used for the LRU eviction
+		ghc::filesystem::last_write_time(path, ghc::filesystem::file_time_type::clock::now(), ec);
+
+		m_hits++;
+		return program;
+	}
+	void ProgramBinaryCache::Save(const std::string& key, GLuint program)
+	{
+		if (key.empty() || program == 0 || !IsEnabled())
+			return;
+
+		GLint linked = 0, length = 0;
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (!linked || length <= 0)
+			return;
+
+		std::vector<char> data(length);
+		GLenum format = 0;
+		glGetProgramBinary(program, length, &length, &format, data.data());
+		if (length <= 0)
+			return;
+
+		std::error_code ec;
+		ghc::filesystem::create_directories(PROGRAM_CACHE_DIR, ec);
+
+		std::ofstream file(m_getPath(key), std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			Logger::Get().Log("Failed to write program binary " + m_getPath(key), true);
+			return;
+		}
+
+		ProgramBinaryHeader header;
+		header.Magic = PROGRAM_CACHE_MAGIC;
+		header.Version = PROGRAM_CACHE_VERSION;
+		header.Format = format;
+		header.Length = length;
+		file.write((const char*)&header, sizeof(header));
+		file.write(data.data(), length);
+		file.close();
+
+		m_evict();
+	}
+	void ProgramBinaryCache::Clear()
+	{
+		Logger::Get().Log("Clearing the program binary cache");
+
+		std::error_code ec;
+		ghc::filesystem::remove_all(PROGRAM_CACHE_DIR, ec);
+		m_hits = m_misses = 0;
+	}
+	void ProgramBinaryCache::m_evict()
+	{
+		struct Entry
+		{
+			ghc::filesystem::path Path;
+			ghc::filesystem::file_time_type Time;
+			uintmax_t Size;
+		};
+
+		std::error_code ec;
+		std::vector<Entry> entries;
+		uintmax_t total = 0;
+		for (const auto& entry : ghc::filesystem::directory_iterator(PROGRAM_CACHE_DIR, ec)) {
+			if (!entry.is_regular_file(ec))
+				continue;
+
+			Entry e;
+			e.Path = entry.path();
+			e.Time = entry.last_write_time(ec);
+			e.Size = entry.file_size(ec);
+			total += e.Size;
+			entries.push_back(e);
+		}
+
+		uintmax_t limit = (uintmax_t)std::max<int>(Settings::Instance().General.ProgramCacheSize, 1) * 1024 * 1024;
+		if (total <= limit)
+			return;
+
+		std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.Time < b.Time; });
+
+		for (size_t i = 0; i < entries.size() && total > limit; i++) {
+			ghc::filesystem::remove(entries[i].Path, ec);
+			total -= entries[i].Size;
+		}
+	}
+	std::string ProgramBinaryCache::m_getPath(const std::string& key)
+	{
+		return std::string(PROGRAM_CACHE_DIR) + "/" + key + ".bin";
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <GL/glew.h>
+#if defined(__APPLE__)
+	#include <OpenGL/gl.h>
+#else
+	#include <GL/gl.h>
+#endif
+
+namespace ed
+{
+	// stores linked programs (glGetProgramBinary) in data/cache/programs so that
+	// reopening a project doesn't have to compile every shader again
+	class ProgramBinaryCache
+	{
+	public:
+		static inline ProgramBinaryCache& Instance()
+		{
+			static ProgramBinaryCache ret;
+			return ret;
+		}
+
+		ProgramBinaryCache();
+
+		// is the cache turned on & does the driver support at least one binary format
+		bool IsEnabled();
+
+		// key = hash of the final GLSL sources + driver vendor/renderer/version, empty if the cache is disabled
+		std::string GetKey(const std::vector<std::string>& sources);
+
+		GLuint Load(const std::string& key); // returns 0 if the binary is missing or the driver rejected it
+		void Save(const std::string& key, GLuint program);
+		void Clear();
+
+		inline int GetHitCount() { return m_hits; }
+		inline int GetMissCount() { return m_misses; }
+
+	private:
+		void m_evict(); // remove the least recently used binaries until the cache fits in Settings::General.ProgramCacheSize
+		std::string m_getPath(const std::string& key);
+
+		bool m_checked, m_supported;
+		std::string m_driver;
+		int m_hits, m_misses;
+	};
+}
@@ -12,6 +12,8 @@
 #include "Names.h"
 #include "Logger.h"
 #include "DefaultState.h"
+#include "FileCache.h"
+#include "MappedFile.h"
 #include "PluginAPI/PluginManager.h"
 
 #include "../UI/PinnedUI.h"
@@ -22,6 +24,7 @@
 #include "../Engine/GeometryFactory.h"
 
 #include <fstream>
+#include <algorithm>
 #include <ghc/filesystem.hpp>
 
 #define HARRAYSIZE(a) (sizeof(a)/sizeof(*a))
@@ -63,10 +66,12 @@ namespace ed
 	{
 		ResetProjectDirectory();
 		m_ui = gui;
+		m_modified = false;
+		m_modifyCount = 0;
 	}
 	ProjectParser::~ProjectParser()
 	{}
-	void ProjectParser::Open(const std::string & file)
+	bool ProjectParser::Open(const std::string & file)
 	{
 		Logger::Get().Log("Openning a project file " + file);
 
@@ -74,7 +79,7 @@ namespace ed
 		pugi::xml_parse_result result = doc.load_file(file.c_str());
 		if (!result) {
 			Logger::Get().Log("Failed to parse a project file", true);
-			return;
+			return false;
 		}
 
 		// check if user has all required plugins
@@ -93,24 +98,28 @@ namespace ed
 
 				std::string msg = "The project you are trying to open requires plugin " + pname + ".\nDo you want to install the plugin?";
 
-				const SDL_MessageBoxButtonData buttons[] = {
-					{ /* .flags, .buttonid, .text */        0, 1, "NO" },
-					{ SDL_MESSAGEBOX_BUTTON_RETURNKEY_DEFAULT, 0, "YES" },
-				};
-				const SDL_MessageBoxData messageboxdata = {
-					SDL_MESSAGEBOX_INFORMATION, /* .flags */
-					m_ui->GetSDLWindow(), /* .window */
-					"SHADERed", /* .title */
-					msg.c_str(), /* .message */
-					SDL_arraysize(buttons), /* .numbuttons */
-					buttons, /* .buttons */
-					NULL /* .colorScheme */
-				};
-				int buttonid;
-				if (SDL_ShowMessageBox(&messageboxdata, &buttonid) < 0) {}
-
-				if (buttonid == 0) {
-					// TODO: redirect to .../plugin?name=pname
+				if (m_ui == nullptr) // headless, nobody to ask
+					Logger::Get().Log(msg, true);
+				else {
+					const SDL_MessageBoxButtonData buttons[] = {
+						{ /* .flags, .buttonid, .text */        0, 1, "NO" },
+						{ SDL_MESSAGEBOX_BUTTON_RETURNKEY_DEFAULT, 0, "YES" },
+					};
+					const SDL_MessageBoxData messageboxdata = {
+						SDL_MESSAGEBOX_INFORMATION, /* .flags */
+						m_ui->GetSDLWindow(), /* .window */
+						"SHADERed", /* .title */
+						msg.c_str(), /* .message */
+						SDL_arraysize(buttons), /* .numbuttons */
+						buttons, /* .buttons */
+						NULL /* .colorScheme */
+					};
+					int buttonid;
+					if (SDL_ShowMessageBox(&messageboxdata, &buttonid) < 0) {}
+
+					if (buttonid == 0) {
+						// TODO: redirect to .../plugin?name=pname
+					}
 				}
 
 				break;
@@ -121,36 +130,11 @@ namespace ed
 
 				std::string msg = "The project you are trying to open requires plugin " + pname + " which you have installed.\nEnable the plugin in the options.";
 
-				const SDL_MessageBoxButtonData buttons[] = {
-					{ SDL_MESSAGEBOX_BUTTON_RETURNKEY_DEFAULT, 0, "OK" },
-				};
-				const SDL_MessageBoxData messageboxdata = {
-					SDL_MESSAGEBOX_INFORMATION, /* .flags */
-					m_ui->GetSDLWindow(), /* .window */
-					"SHADERed", /* .title */
-					msg.c_str(), /* .message */
-					SDL_arraysize(buttons), /* .numbuttons */
-					buttons, /* .buttons */
-					NULL /* .colorScheme */
-				};
-				int buttonid;
-				if (SDL_ShowMessageBox(&messageboxdata, &buttonid) < 0) {}
-
-				if (buttonid == 0) { }
-
-				pluginTest = false;
-			}
-			else {
-				int instPVer = m_plugins->GetPluginVersion(pname);
-				if (instPVer < pver) {
-					pluginTest = false;
-
-					std::string msg = "The project you are trying to open requires plugin " + pname + " version " + std::to_string(pver) + 
-						" while you have version " + std::to_string(instPVer) + " installed.\nDo you want to update your plugin?";
-
+				if (m_ui == nullptr) // headless, nobody to ask
+					Logger::Get().Log(msg, true);
+				else {
 					const SDL_MessageBoxButtonData buttons[] = {
-						{ /* .flags, .buttonid, .text */        0, 1, "NO" },
-						{ SDL_MESSAGEBOX_BUTTON_RETURNKEY_DEFAULT, 0, "YES" },
+						{ SDL_MESSAGEBOX_BUTTON_RETURNKEY_DEFAULT, 0, "OK" },
 					};
 					const SDL_MessageBoxData messageboxdata = {
 						SDL_MESSAGEBOX_INFORMATION, /* .flags */
@@ -162,10 +146,43 @@ namespace ed
 						NULL /* .colorScheme */
 					};
 					int buttonid;
-					if (SDL_ShowMessageBox(&messageboxdata, &buttonid) < 0) { }
+					if (SDL_ShowMessageBox(&messageboxdata, &buttonid) < 0) {}
 
-					if (buttonid == 0) {
-						// TODO: redirect to .../plugin?name=pname
+					if (buttonid == 0) { }
+				}
+
+				pluginTest = false;
+			}
+			else {
+				int instPVer = m_plugins->GetPluginVersion(pname);
+				if (instPVer < pver) {
+					pluginTest = false;
+
+					std::string msg = "The project you are trying to open requires plugin " + pname + " version " + std::to_string(pver) + 
+						" while you have version " + std::to_string(instPVer) + " installed.\nDo you want to update your plugin?";
+
+					if (m_ui == nullptr) // headless, nobody to ask
+						Logger::Get().Log(msg, true);
+					else {
+						const SDL_MessageBoxButtonData buttons[] = {
+							{ /* .flags, .buttonid, .text */        0, 1, "NO" },
+							{ SDL_MESSAGEBOX_BUTTON_RETURNKEY_DEFAULT, 0, "YES" },
+						};
+						const SDL_MessageBoxData messageboxdata = {
+							SDL_MESSAGEBOX_INFORMATION, /* .flags */
+							m_ui->GetSDLWindow(), /* .window */
+							"SHADERed", /* .title */
+							msg.c_str(), /* .message */
+							SDL_arraysize(buttons), /* .numbuttons */
+							buttons, /* .buttons */
+							NULL /* .colorScheme */
+						};
+						int buttonid;
+						if (SDL_ShowMessageBox(&messageboxdata, &buttonid) < 0) { }
+
+						if (buttonid == 0) {
+							// TODO: redirect to .../plugin?name=pname
+						}
 					}
 
 					break;
@@ -175,7 +192,7 @@ namespace ed
 		
 		if (!pluginTest) {
 			Logger::Get().Log("Missing plugin - project not loaded", true);
-			return;
+			return false;
 		}
 
 		CameraSnapshots::Clear();
@@ -200,6 +217,7 @@ namespace ed
 		Settings::Instance().Project.FPCamera = false;
 		Settings::Instance().Project.ClearColor = glm::vec4(0, 0, 0, 0);
 		Settings::Instance().Project.UseAlphaChannel = false;
+		Settings::Instance().Project.SystemUniformBuffer = false;
 
 		pugi::xml_node projectNode = doc.child("project");
 		int projectVersion = 1; // if no project version is specified == using first project file
@@ -210,15 +228,18 @@ namespace ed
 		for (const auto& pname : m_pluginList)
 			m_plugins->GetPlugin(pname)->BeginProjectLoading();
 
+		bool parsed = true;
 		switch (projectVersion) {
 			case 1: m_parseV1(projectNode); break;
 			case 2: m_parseV2(projectNode); break;
 			default: 
 				Logger::Get().Log("Tried to open a project that is newer version", true);
+				parsed = false;
 			break;
 		}
 
 		m_modified = false;
+		m_modifyCount++;
 
 		// reset time, frame index, etc...
 		SystemVariableManager::Instance().Reset();
@@ -228,6 +249,8 @@ namespace ed
 			m_plugins->GetPlugin(pname)->EndProjectLoading();
 			
 		Logger::Get().Log("Finished with parsing a project file");
+
+		return parsed;
 	}
 	void ProjectParser::OpenTemplate()
 	{
@@ -337,6 +360,12 @@ namespace ed
 
 				passNode.append_attribute("type").set_value("shader");
 				passNode.append_attribute("active").set_value(passData->Active);
+				if (passData->Batching)
+					passNode.append_attribute("batching").set_value(true);
+				if (passData->Cache == pipe::ShaderPass::CacheMode::Auto)
+					passNode.append_attribute("cache").set_value("auto");
+				else if (passData->Cache == pipe::ShaderPass::CacheMode::Static)
+					passNode.append_attribute("cache").set_value("static");
 
 				/* collapsed="true" attribute */
 				for (int i = 0; i < collapsedSP.size(); i++)
@@ -601,6 +630,28 @@ namespace ed
 					textureNode.append_attribute("back").set_value(texmaps[4].c_str());
 				}
 
+				// sampler settings, only the ones that differ from the defaults
+				ObjectManagerItem* texItem = m_objects->GetObjectManagerItem(texs[i]);
+				if (texItem != nullptr && texItem->IsTexture) {
+					const TextureSampler& sampler = texItem->Sampler;
+					const TextureSampler defaults;
+
+					if (sampler.Mipmaps != defaults.Mipmaps)
+						textureNode.append_attribute("mipmaps").set_value(sampler.Mipmaps);
+					for (int k = 0; k < HARRAYSIZE(TEXTURE_FILTER_NAMES); k++) {
+						if (sampler.MinFilter != defaults.MinFilter && sampler.MinFilter == TEXTURE_FILTER_VALUES[k])
+							textureNode.append_attribute("min_filter").set_value(TEXTURE_FILTER_NAMES[k]);
+						if (sampler.MagFilter != defaults.MagFilter && sampler.MagFilter == TEXTURE_FILTER_VALUES[k])
+							textureNode.append_attribute("mag_filter").set_value(TEXTURE_FILTER_NAMES[k]);
+					}
+					for (int k = 0; k < HARRAYSIZE(TEXTURE_WRAP_NAMES); k++) {
+						if (sampler.WrapS != defaults.WrapS && sampler.WrapS == TEXTURE_WRAP_VALUES[k])
+							textureNode.append_attribute("wrap_s").set_value(TEXTURE_WRAP_NAMES[k]);
+						if (sampler.WrapT != defaults.WrapT && sampler.WrapT == TEXTURE_WRAP_VALUES[k])
+							textureNode.append_attribute("wrap_t").set_value(TEXTURE_WRAP_NAMES[k]);
+					}
+				}
+
 				if (isImage) {
 					ImageObject *iobj = m_objects->GetImage(texs[i]);
 
@@ -820,6 +871,13 @@ namespace ed
 				alphaNode.append_attribute("val").set_value(settings.Project.UseAlphaChannel);
 			}
 
+			// sysubo
+			if (settings.Project.SystemUniformBuffer) {
+				pugi::xml_node uboNode = settingsNode.append_child("entry");
+				uboNode.append_attribute("type").set_value("sysubo");
+				uboNode.append_attribute("val").set_value(settings.Project.SystemUniformBuffer);
+			}
+
 			// include paths
 			if (settings.Project.IncludePaths.size() > 0) {
 				pugi::xml_node pathsNode = settingsNode.append_child("entry");
@@ -868,41 +926,26 @@ namespace ed
 	}
 	std::string ProjectParser::LoadFile(const std::string & file)
 	{
-		std::ifstream in(file);
-		if (in.is_open()) {
-			in.seekg(0, std::ios::beg);
-
-			std::string content((std::istreambuf_iterator<char>(in)), (std::istreambuf_iterator<char>()));
-			in.close();
-			return content;
-		}
-		return "";
+		std::string content;
+		FileCache::Instance().Get(file, content);
+		return content;
 	}
 	std::string ProjectParser::LoadProjectFile(const std::string & file)
 	{
-		std::ifstream in(GetProjectPath(file));
-		if (in.is_open()) {
-			in.seekg(0, std::ios::beg);
-
-			std::string content((std::istreambuf_iterator<char>(in)), (std::istreambuf_iterator<char>()));
-			in.close();
-			return content;
-		}
-		return "";
+		return LoadFile(GetProjectPath(file));
 	}
 	char * ProjectParser::LoadProjectFile(const std::string& file, size_t& fsize)
 	{
-		std::string actual = GetProjectPath(file);
+		MappedFile mapped;
+		if (!mapped.Open(GetProjectPath(file))) {
+			fsize = 0;
+			return nullptr;
+		}
 
-		FILE *f = fopen(actual.c_str(), "rb");
-		fseek(f, 0, SEEK_END);
-		fsize = ftell(f);
-		fseek(f, 0, SEEK_SET);  //same as rewind(f);
+		fsize = mapped.GetSize();
 
 		char *string = (char*)malloc(fsize + 1);
-		fread(string, fsize, 1, f);
-		fclose(f);
-
+		memcpy(string, mapped.GetData(), fsize);
 		string[fsize] = 0;
 
 		return string;
@@ -928,9 +971,13 @@ namespace ed
 	}
 	void ProjectParser::SaveProjectFile(const std::string & file, const std::string & data)
 	{
-		std::ofstream out(GetProjectPath(file));
+		std::string path = GetProjectPath(file);
+
+		std::ofstream out(path);
 		out << data;
 		out.close();
+
+		FileCache::Instance().Remove(path);
 	}
 	std::string ProjectParser::GetRelativePath(const std::string& to)
 	{
@@ -1111,6 +1158,44 @@ namespace ed
 				return CULL_MODE_VALUES[k];
 		return GL_BACK;
 	}
+	GLenum ProjectParser::m_toTextureFilter(const char* str)
+	{
+		for (int k = 0; k < HARRAYSIZE(TEXTURE_FILTER_NAMES); k++)
+			if (strcmp(str, TEXTURE_FILTER_NAMES[k]) == 0)
+				return TEXTURE_FILTER_VALUES[k];
+		return GL_LINEAR;
+	}
+	GLenum ProjectParser::m_toTextureWrap(const char* str)
+	{
+		for (int k = 0; k < HARRAYSIZE(TEXTURE_WRAP_NAMES); k++)
+			if (strcmp(str, TEXTURE_WRAP_NAMES[k]) == 0)
+				return TEXTURE_WRAP_VALUES[k];
+		return GL_REPEAT;
+	}
+	void ProjectParser::m_parseTextureSampler(pugi::xml_node& node, const std::string& name)
+	{
+		ObjectManagerItem* item = m_objects->GetObjectManagerItem(name);
+		if (item == nullptr || !item->IsTexture)
+			return;
+
+		if (node.attribute("mipmaps").empty() && node.attribute("min_filter").empty() && node.attribute("mag_filter").empty() &&
+			node.attribute("wrap_s").empty() && node.attribute("wrap_t").empty())
+			return;
+
+		TextureSampler& sampler = item->Sampler;
+		if (!node.attribute("mipmaps").empty())
+			sampler.Mipmaps = node.attribute("mipmaps").as_bool();
+		if (!node.attribute("min_filter").empty())
+			sampler.MinFilter = m_toTextureFilter(node.attribute("min_filter").as_string());
+		if (!node.attribute("mag_filter").empty())
+			sampler.MagFilter = m_toTextureFilter(node.attribute("mag_filter").as_string());
+		if (!node.attribute("wrap_s").empty())
+			sampler.WrapS = m_toTextureWrap(node.attribute("wrap_s").as_string());
+		if (!node.attribute("wrap_t").empty())
+			sampler.WrapT = m_toTextureWrap(node.attribute("wrap_t").as_string());
+
+		m_objects->UpdateTextureSampler(name);
+	}
 
 	void ProjectParser::m_exportItems(pugi::xml_node& node, std::vector<PipelineItem*>& items, const std::string& oldProjectPath)
 	{
@@ -1555,7 +1640,7 @@ namespace ed
 			// check if it should be collapsed
 			if (!passNode.attribute("collapsed").empty()) {
 				bool cs = passNode.attribute("collapsed").as_bool();
-				if (cs)
+				if (cs && m_ui != nullptr)
 					((PipelineUI*)m_ui->Get(ViewID::Pipeline))->Collapse(data);
 			}
 
@@ -1928,8 +2013,8 @@ namespace ed
 
 				if (isCube)
 					m_objects->CreateCubemap(name, cubeLeft, cubeTop, cubeFront, cubeBottom, cubeRight, cubeBack);
-				else
-					m_objects->CreateTexture(name);
+				else if (m_objects->CreateTexture(name))
+					m_parseTextureSampler(objectNode, name);
 
 				for (pugi::xml_node bindNode : objectNode.children("bind")) {
 					const pugi::char_t* passBindName = bindNode.attribute("name").as_string();
@@ -2033,14 +2118,14 @@ namespace ed
 		for (pugi::xml_node settingItem : projectNode.child("settings").children("entry")) {
 			if (!settingItem.attribute("type").empty()) {
 				std::string type = settingItem.attribute("type").as_string();
-				if (type == "property") {
+				if (type == "property" && m_ui != nullptr) {
 					PropertyUI* props = ((PropertyUI*)m_ui->Get(ViewID::Properties));
 					if (!settingItem.attribute("name").empty()) {
 						PipelineItem* item = m_pipe->Get(settingItem.attribute("name").as_string());
 						props->Open(item);
 					}
 				}
-				else if (type == "file" && Settings::Instance().General.ReopenShaders) {
+				else if (type == "file" && m_ui != nullptr && Settings::Instance().General.ReopenShaders) {
 					CodeEditorUI* editor = ((CodeEditorUI*)m_ui->Get(ViewID::Code));
 					if (!settingItem.attribute("name").empty()) {
 						PipelineItem* item = m_pipe->Get(settingItem.attribute("name").as_string());
@@ -2062,7 +2147,7 @@ namespace ed
 							editor->OpenGS(item);
 					}
 				}
-				else if (type == "pinned") {
+				else if (type == "pinned" && m_ui != nullptr) {
 					PinnedUI* pinned = ((PinnedUI*)m_ui->Get(ViewID::Pinned));
 					if (!settingItem.attribute("name").empty()) {
 						const pugi::char_t* item = settingItem.attribute("name").as_string();
@@ -2168,10 +2253,23 @@ namespace ed
 				if (!passNode.attribute("active").empty())
 					data->Active = passNode.attribute("active").as_bool();
 
+				data->Batching = false;
+				if (!passNode.attribute("batching").empty())
+					data->Batching = passNode.attribute("batching").as_bool();
+
+				data->Cache = pipe::ShaderPass::CacheMode::Dynamic;
+				if (!passNode.attribute("cache").empty()) {
+					std::string cacheMode = passNode.attribute("cache").as_string();
+					if (cacheMode == "auto")
+						data->Cache = pipe::ShaderPass::CacheMode::Auto;
+					else if (cacheMode == "static")
+						data->Cache = pipe::ShaderPass::CacheMode::Static;
+				}
+
 				// check if it should be collapsed
 				if (!passNode.attribute("collapsed").empty()) {
 					bool cs = passNode.attribute("collapsed").as_bool();
-					if (cs)
+					if (cs && m_ui != nullptr)
 						((PipelineUI*)m_ui->Get(ViewID::Pipeline))->Collapse(data);
 				}
 
@@ -2635,8 +2733,8 @@ namespace ed
 
 				if (isCube)
 					m_objects->CreateCubemap(name, cubeLeft, cubeTop, cubeFront, cubeBottom, cubeRight, cubeBack);
-				else
-					m_objects->CreateTexture(name);
+				else if (m_objects->CreateTexture(name))
+					m_parseTextureSampler(objectNode, name);
 
 				for (pugi::xml_node bindNode : objectNode.children("bind")) {
 					const pugi::char_t* passBindName = bindNode.attribute("name").as_string();
@@ -2876,14 +2974,11 @@ namespace ed
 					strcpy(buf->ViewFormat, objectNode.attribute("format").as_string());
 				
 				std::string bPath = GetProjectPath("buffers/" + std::string(objName) + ".buf");
-				std::ifstream bufRead(bPath, std::ios::binary);
-				if (bufRead.is_open())
-					bufRead.read((char*)buf->Data, buf->Size);
-				bufRead.close();
-
-				glBindBuffer(GL_UNIFORM_BUFFER, buf->ID);
-				glBufferData(GL_UNIFORM_BUFFER, buf->Size, buf->Data, GL_STATIC_DRAW); // allocate 0 bytes of memory
-				glBindBuffer(GL_UNIFORM_BUFFER, 0);
+				MappedFile bufRead;
+				if (bufRead.Open(bPath))
+					memcpy(buf->Data, bufRead.GetData(), std::min<size_t>(bufRead.GetSize(), buf->Size));
+
+				m_objects->UploadBuffer(buf);
 				
 				for (pugi::xml_node bindNode : objectNode.children("bind")) {
 					const pugi::char_t* passBindName = bindNode.attribute("name").as_string();
@@ -2980,7 +3075,7 @@ namespace ed
 		for (pugi::xml_node settingItem : projectNode.child("settings").children("entry")) {
 			if (!settingItem.attribute("type").empty()) {
 				std::string type = settingItem.attribute("type").as_string();
-				if (type == "property") {
+				if (type == "property" && m_ui != nullptr) {
 					PropertyUI* props = ((PropertyUI*)m_ui->Get(ViewID::Properties));
 					if (!settingItem.attribute("name").empty()) {
 						int type = 0; // pipeline item
@@ -3000,7 +3095,7 @@ namespace ed
 							props->Open(itemName, m_objects->GetObjectManagerItem(itemName));
 					}
 				}
-				else if (type == "file" && Settings::Instance().General.ReopenShaders) {
+				else if (type == "file" && m_ui != nullptr && Settings::Instance().General.ReopenShaders) {
 					CodeEditorUI* editor = ((CodeEditorUI*)m_ui->Get(ViewID::Code));
 					if (!settingItem.attribute("name").empty()) {
 						PipelineItem* item = m_pipe->Get(settingItem.attribute("name").as_string());
@@ -3031,7 +3126,7 @@ namespace ed
 						}
 					}
 				}
-				else if (type == "pinned") {
+				else if (type == "pinned" && m_ui != nullptr) {
 					PinnedUI* pinned = ((PinnedUI*)m_ui->Get(ViewID::Pinned));
 					if (!settingItem.attribute("name").empty()) {
 						const pugi::char_t* item = settingItem.attribute("name").as_string();
@@ -3099,6 +3194,12 @@ namespace ed
 					else 
 						Settings::Instance().Project.UseAlphaChannel = false;
 				}
+				else if (type == "sysubo") {
+					if (!settingItem.attribute("val").empty())
+						Settings::Instance().Project.SystemUniformBuffer = settingItem.attribute("val").as_bool();
+					else
+						Settings::Instance().Project.SystemUniformBuffer = false;
+				}
 				else if (type == "ipaths") {
 					Settings::Instance().Project.IncludePaths.clear();
 					for (pugi::xml_node pathNode : settingItem.children("path"))
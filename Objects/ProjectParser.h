@@ -33,7 +33,7 @@ namespace ed
 		ProjectParser(PipelineManager* pipeline, ObjectManager* objects, RenderEngine* renderer, PluginManager* plugins, MessageStack* msgs, DebugInformation* debugger, GUIManager* gui);
 		~ProjectParser();
 
-		void Open(const std::string& file);
+		bool Open(const std::string& file); // false if the project couldn't be loaded (parse error, missing plugin, ...)
 		void OpenTemplate();
 		inline void SetTemplate(const std::string& str) { m_template = str; }
 
@@ -58,8 +58,9 @@ namespace ed
 		inline const std::string& GetOpenedFile() { return m_file; }
 		inline const std::string& GetTemplate() { return m_template; }
 
-		inline void ModifyProject() { m_modified = true; }
+		inline void ModifyProject() { m_modified = true; m_modifyCount++; }
 		inline bool IsProjectModified() { return m_modified; }
+		inline unsigned int GetModifyCount() { return m_modifyCount; } // increased on every ModifyProject() call
 
 	private:
 		void m_parseV1(pugi::xml_node& projectNode); // old
@@ -73,6 +74,9 @@ namespace ed
 		GLenum m_toComparisonFunc(const char* str);
 		GLenum m_toStencilOp(const char* str);
 		GLenum m_toCullMode(const char* str);
+		GLenum m_toTextureFilter(const char* str);
+		GLenum m_toTextureWrap(const char* str);
+		void m_parseTextureSampler(pugi::xml_node& node, const std::string& name);
 
 		void m_exportItems(pugi::xml_node& node, std::vector<PipelineItem*>& items, const std::string& oldProjectPath);
 		void m_importItems(const char* owner, pipe::ShaderPass* data, const pugi::xml_node& node, const std::vector<InputLayoutItem>& inpLayout,
@@ -80,6 +84,7 @@ namespace ed
 			std::map<pipe::Model*, std::pair<std::string, pipe::ShaderPass*>>& modelUBOs);
 
 		bool m_modified;
+		unsigned int m_modifyCount;
 
 		GUIManager* m_ui;
 		PipelineManager* m_pipe;
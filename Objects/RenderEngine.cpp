@@ -3,7 +3,12 @@
 #include "Settings.h"
 #include "ShaderTranscompiler.h"
 #include "DefaultState.h"
+#include "GLState.h"
 #include "ObjectManager.h"
+#include "ProgramBinaryCache.h"
+#include "IncludeCache.h"
+#include "FunctionVariableManager.h"
+#include "Hash.h"
 #include "PipelineManager.h"
 #include "SystemVariableManager.h"
 #include "../Engine/GeometryFactory.h"
@@ -11,8 +16,11 @@
 #include "../Engine/Ray.h"
 
 #include <algorithm>
+#include <thread>
+#include <chrono>
 #include <ghc/filesystem.hpp>
 #include <glm/gtx/intersect.hpp>
+#include <glm/gtc/type_ptr.hpp>
 
 static const GLenum fboBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3, GL_COLOR_ATTACHMENT4, GL_COLOR_ATTACHMENT5, GL_COLOR_ATTACHMENT6, GL_COLOR_ATTACHMENT7, GL_COLOR_ATTACHMENT8, GL_COLOR_ATTACHMENT9, GL_COLOR_ATTACHMENT10, GL_COLOR_ATTACHMENT11, GL_COLOR_ATTACHMENT12, GL_COLOR_ATTACHMENT13, GL_COLOR_ATTACHMENT14, GL_COLOR_ATTACHMENT15 };
 static const char* PixelDebugShaderCode = R"(
@@ -58,6 +66,10 @@ void main()
 )";
 #define DEBUG_ID_START 1
 
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
 namespace ed
 {
 	RenderEngine::RenderEngine(PipelineManager * pipeline, ObjectManager* objects, ProjectParser* project, MessageStack* msgs, PluginManager* plugins, DebugInformation* debugger) :
@@ -71,17 +83,42 @@ namespace ed
 		m_pickAwaiting(false),
 		m_rtColor(0),
 		m_rtDepth(0),
-		m_fbosNeedUpdate(false),
 		m_computeSupported(true),
-		m_wasMultiPick(false)
+		m_wasMultiPick(false),
+		m_compileDone(0),
+		m_compileTotal(0),
+		m_transcompiler(project)
 	{
 		m_paused = false;
 
+		// let the driver compile on its own threads, we just poll GL_COMPLETION_STATUS_KHR
+		m_parallelCompile = false;
+		GLint extCount = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &extCount);
+		for (GLint i = 0; i < extCount; i++) {
+			const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, i);
+			if (ext != nullptr && (strcmp(ext, "GL_KHR_parallel_shader_compile") == 0 || strcmp(ext, "GL_ARB_parallel_shader_compile") == 0))
+				m_parallelCompile = true;
+		}
+#ifdef GL_KHR_parallel_shader_compile
+		if (m_parallelCompile && glMaxShaderCompilerThreadsKHR != nullptr)
+			glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+#endif
+		if (m_parallelCompile)
+			Logger::Get().Log("Using GL_KHR_parallel_shader_compile");
+
 		glGenTextures(1, &m_rtColor);
 		glGenTextures(1, &m_rtDepth);
 		glGenTextures(1, &m_rtColorMS);
 		glGenTextures(1, &m_rtDepthMS);
 
+		glGenBuffers(1, &m_batchVBO);
+		m_batchCount = 0;
+
+		m_pluginEpoch = 0;
+		m_programGeneration = 0;
+		m_skippedPasses = m_lastSkippedPasses = 0;
+
 		GLchar msg[1024];
 		m_debugPixelShader = gl::CompileShader(GL_FRAGMENT_SHADER, PixelDebugShaderCode);
 		bool psCompiled = gl::CheckShaderCompilationStatus(m_debugPixelShader, msg);
@@ -100,17 +137,21 @@ namespace ed
 	}
 	RenderEngine::~RenderEngine()
 	{
+		m_transcompiler.Stop();
 		glDeleteTextures(1, &m_rtColor);
 		glDeleteTextures(1, &m_rtDepth);
 		glDeleteTextures(1, &m_rtColorMS);
 		glDeleteTextures(1, &m_rtDepthMS);
+		glDeleteBuffers(1, &m_batchVBO);
 		glDeleteShader(m_debugPixelShader);
 		glDeleteShader(m_debugVertexPickShader);
 		glDeleteShader(m_debugInstancePickShader);
-		FlushCache();
+		m_clearCache();
 	}
 	void RenderEngine::Render(int width, int height, bool isDebug)
 	{
+		SystemVariableManager::Instance().Invalidate(); // new frame -> recompute the system & function values once
+
 		bool isMSAA = (Settings::Instance().Preview.MSAA != 1) && !isDebug;
 
 		if (isMSAA)
@@ -153,8 +194,16 @@ namespace ed
 		// cache elements
 		m_cache();
 
+		// from here on all state changes go through GLState
+		GLState& glState = GLState::Instance();
+		glState.Begin();
+
 		auto& systemVM = SystemVariableManager::Instance();
 
+		// tiled rendering: width & height are the tile's size, screen quads are positioned in the whole image
+		glm::vec4 tile = systemVM.GetTile();
+		glm::vec2 fullSize(width / tile.z, height / tile.w);
+
 		auto& itemVarValues = GetItemVariableValues();
 		GLuint previousTexture[MAX_RENDER_TEXTURES] = { 0 }; // dont clear the render target if we use it two times in a row
 		GLuint previousDepth = 0;
@@ -162,9 +211,21 @@ namespace ed
 		int debugID = DEBUG_ID_START;
 
 		m_plugins->BeginRender();
+		glState.Invalidate();
 
-		for (int i = 0; i < m_items.size(); i++) {
-			PipelineItem* it = m_items[i];
+		if (!isDebug) {
+			m_profiler.BeginFrame();
+			ShaderVariableContainer::ResetUploadStats();
+			glState.ResetStats();
+
+			m_lastSkippedPasses = m_skippedPasses;
+			m_skippedPasses = 0;
+		}
+
+		std::vector<PipelineItem*>& items = m_pipeline->GetList();
+		for (int i = 0; i < items.size(); i++) {
+			PipelineItem* it = items[i];
+			PassCache& cache = m_getCache(it);
 
 			if (it->Type == PipelineItem::ItemType::ShaderPass) {
 				pipe::ShaderPass* data = (pipe::ShaderPass*)it->Data;
@@ -172,23 +233,42 @@ namespace ed
 				if (!data->Active || data->Items.size() <= 0 || data->RTCount == 0 || (isDebug && data->GSUsed))
 					continue;
 
-				const std::vector<GLuint>& srvs = m_objects->GetBindList(m_items[i]);
-				const std::vector<GLuint>& ubos = m_objects->GetUniformBindList(m_items[i]);
+				const std::vector<GLuint>& srvs = m_objects->GetBindList(it);
+				const std::vector<GLuint>& ubos = m_objects->GetUniformBindList(it);
+
+				m_profiler.BeginItem(it);
 
 				// create/update fbo if necessary
-				m_updatePassFBO(data);
+				m_profiler.BeginStage(Profiler::Stage::FBO);
+				m_updatePassFBO(data, cache);
+				m_profiler.EndStage(Profiler::Stage::FBO);
+
+				if (cache.Program == 0) {
+					m_profiler.EndItem();
+					continue;
+				}
 
-				if (m_shaders[i] == 0)
+				systemVM.SetTile(tile); // the previous pass might have rendered whole
+
+				// nothing that this pass depends on has changed -> reuse the render textures
+				if (m_canSkipPass(it, cache, srvs, ubos, width, height, isDebug)) {
+					for (int i = 0; i < data->RTCount; i++)
+						previousTexture[i] = data->RenderTextures[i];
+					previousDepth = data->DepthTexture;
+
+					m_skippedPasses++;
+					m_profiler.EndItem();
 					continue;
+				}
 
 				// bind fbo and buffers
-				glBindFramebuffer(GL_FRAMEBUFFER, isMSAA ? m_fboMS[data] : data->FBO);
+				glState.BindFramebuffer(GL_FRAMEBUFFER, isMSAA ? cache.FBOMS : data->FBO);
 				glDrawBuffers(data->RTCount, fboBuffers);
 
 				// clear depth texture
 				if (data->DepthTexture != previousDepth) {
 					if ((data->DepthTexture == m_rtDepth && !clearedWindow) || data->DepthTexture != m_rtDepth) {
-						glStencilMask(0xFFFFFFFF);
+						glState.StencilMask(0xFFFFFFFF);
 						glClearBufferfi(GL_DEPTH_STENCIL, 0, 1.0f, 0);
 					}
 
@@ -198,6 +278,7 @@ namespace ed
 				// bind RTs
 				int rtCount = MAX_RENDER_TEXTURES;
 				glm::vec2 rtSize(width, height);
+				bool isCropped = true; // fixed size render textures are always rendered whole
 				for (int i = 0; i < MAX_RENDER_TEXTURES; i++) {
 					if (data->RenderTextures[i] == 0) {
 						rtCount = i;
@@ -210,6 +291,8 @@ namespace ed
 						ed::RenderTextureObject* rtObject = m_objects->GetRenderTexture(rt);
 
 						rtSize = rtObject->CalculateSize(width, height);
+						if (rtObject->FixedSize.x != -1)
+							isCropped = false;
 
 						// clear and bind rt (only if not used in last shader pass)
 						bool usedPreviously = false;
@@ -232,33 +315,43 @@ namespace ed
 					previousTexture[i] = data->RenderTextures[i];
 
 				// update viewport value
-				systemVM.SetViewportSize(rtSize.x, rtSize.y);
-				glViewport(0, 0, rtSize.x, rtSize.y);
+				if (isCropped) {
+					systemVM.SetTile(tile);
+					systemVM.SetViewportSize(rtSize.x / tile.z, rtSize.y / tile.w);
+				} else {
+					systemVM.SetTile(glm::vec4(0, 0, 1, 1));
+					systemVM.SetViewportSize(rtSize.x, rtSize.y);
+				}
+				glState.Viewport(0, 0, rtSize.x, rtSize.y);
+				if (Settings::Instance().Project.SystemUniformBuffer)
+					systemVM.UpdateUniformBuffer();
 
 				// bind shaders
 
 				if (isDebug) {
-					data->Variables.UpdateUniformInfo(m_debugShaders[i]);
-					glUseProgram(m_debugShaders[i]);
+					data->Variables.UpdateUniformInfo(cache.DebugProgram);
+					glState.UseProgram(cache.DebugProgram);
 				} else
-					glUseProgram(m_shaders[i]);
+					glState.UseProgram(cache.Program);
 
 				// bind shader resource views
 				for (int j = 0; j < srvs.size(); j++) {
-					glActiveTexture(GL_TEXTURE0 + j);
-					if (m_objects->IsCubeMap(srvs[j]))
-						glBindTexture(GL_TEXTURE_CUBE_MAP, srvs[j]);
-					else if (m_objects->IsImage3D(srvs[j]))
-						glBindTexture(GL_TEXTURE_3D, srvs[j]);
+					ObjectType srvType = m_objects->GetObjectTypeByTextureID(srvs[j]);
+					if (srvType == ObjectType::CubeMap)
+						glState.BindTexture(j, GL_TEXTURE_CUBE_MAP, srvs[j]);
+					else if (srvType == ObjectType::Image3D)
+						glState.BindTexture(j, GL_TEXTURE_3D, srvs[j]);
 					else if (m_objects->IsPluginObject(srvs[j])) {
 						PluginObject* pobj = m_objects->GetPluginObject(srvs[j]);
+						glActiveTexture(GL_TEXTURE0 + j);
 						pobj->Owner->BindObject(pobj->Type, pobj->Data, pobj->ID);
+						glState.Invalidate();
 					}
 					else
-						glBindTexture(GL_TEXTURE_2D, srvs[j]);
+						glState.BindTexture(j, GL_TEXTURE_2D, srvs[j]);
 
 					if (ShaderTranscompiler::GetShaderTypeFromExtension(data->PSPath) == ShaderLanguage::GLSL) // TODO: or should this be for vulkan glsl too?
-						data->Variables.UpdateTexture(m_shaders[i], j);
+						data->Variables.UpdateTexture(cache.Program, j);
 				}
 
 				for (int j = 0; j < ubos.size(); j++)
@@ -288,7 +381,7 @@ namespace ed
 							float r = (debugID & 0x000000FF) / 255.0f;
 							float g = ((debugID & 0x0000FF00) >> 8) / 255.0f;
 							float b = ((debugID & 0x00FF0000) >> 16) / 255.0f;
-							glUniform3f(glGetUniformLocation(m_debugShaders[i], "_sed_dbg_pixel_color"), r, g, b);
+							glUniform3f(glGetUniformLocation(cache.DebugProgram, "_sed_dbg_pixel_color"), r, g, b);
 							debugID++;
 						}
 					}
@@ -298,8 +391,8 @@ namespace ed
 
 						if (geoData->Type == pipe::GeometryItem::Rectangle) {
 							// TODO: don't multiply with m_renderer->GetLastRenderSize() but rather with actual RT size
-							glm::vec3 scaleRect(geoData->Scale.x * width, geoData->Scale.y * height, 1.0f);
-							glm::vec3 posRect((geoData->Position.x + 0.5f) * width, (geoData->Position.y + 0.5f) * height, -1000.0f);
+							glm::vec3 scaleRect(geoData->Scale.x * fullSize.x, geoData->Scale.y * fullSize.y, 1.0f);
+							glm::vec3 posRect((geoData->Position.x + 0.5f) * fullSize.x, (geoData->Position.y + 0.5f) * fullSize.y, -1000.0f);
 							systemVM.SetGeometryTransform(item, scaleRect, geoData->Rotation, posRect);
 						} else
 							systemVM.SetGeometryTransform(item, geoData->Scale, geoData->Rotation, geoData->Position);
@@ -307,13 +400,43 @@ namespace ed
 						systemVM.SetPicked(std::count(m_pick.begin(), m_pick.end(), item));
 
 						// bind variables
+						m_profiler.BeginStage(Profiler::Stage::Uniforms);
 						data->Variables.Bind(item);
+						m_profiler.EndStage(Profiler::Stage::Uniforms);
 
-						glBindVertexArray(geoData->VAO);
-						if (geoData->Instanced)
-							glDrawArraysInstanced(geoData->Topology, 0, eng::GeometryFactory::VertexCount[geoData->Type], geoData->InstanceCount);
-						else
-							glDrawArrays(geoData->Topology, 0, eng::GeometryFactory::VertexCount[geoData->Type]);
+						if (data->Batching && !geoData->Instanced) {
+							m_addToBatch(item, systemVM.IsPicked());
+
+							// the following items that only differ in transform go in the same draw call
+							// (not while picking pixels since every item needs its own debug color)
+							if (!isDebug) {
+								while (j + 1 < data->Items.size() && m_canBatch(item, data->Items[j + 1], itemVarValues)) {
+									PipelineItem* next = data->Items[++j];
+									pipe::GeometryItem* nextData = reinterpret_cast<pipe::GeometryItem*>(next->Data);
+
+									if (m_pickAwaiting) m_pickItem(next, m_wasMultiPick);
+
+									if (nextData->Type == pipe::GeometryItem::Rectangle) {
+										glm::vec3 scaleRect(nextData->Scale.x * fullSize.x, nextData->Scale.y * fullSize.y, 1.0f);
+										glm::vec3 posRect((nextData->Position.x + 0.5f) * fullSize.x, (nextData->Position.y + 0.5f) * fullSize.y, -1000.0f);
+										systemVM.SetGeometryTransform(next, scaleRect, nextData->Rotation, posRect);
+									} else
+										systemVM.SetGeometryTransform(next, nextData->Scale, nextData->Rotation, nextData->Position);
+
+									m_addToBatch(next, std::count(m_pick.begin(), m_pick.end(), next));
+								}
+							}
+
+							m_drawBatch(geoData);
+						} else {
+							glBindVertexArray(geoData->VAO);
+							if (data->Batching)
+								m_setItemAttributes(item, systemVM.IsPicked(), true);
+							if (geoData->Instanced)
+								glDrawArraysInstanced(geoData->Topology, 0, eng::GeometryFactory::VertexCount[geoData->Type], geoData->InstanceCount);
+							else
+								glDrawArrays(geoData->Topology, 0, eng::GeometryFactory::VertexCount[geoData->Type]);
+						}
 					}
 					else if (item->Type == PipelineItem::ItemType::Model) {
 						pipe::Model* objData = reinterpret_cast<pipe::Model*>(item->Data);
@@ -322,7 +445,12 @@ namespace ed
 						systemVM.SetGeometryTransform(item, objData->Scale, objData->Rotation, objData->Position);
 
 						// bind variables
+						m_profiler.BeginStage(Profiler::Stage::Uniforms);
 						data->Variables.Bind(item);
+						m_profiler.EndStage(Profiler::Stage::Uniforms);
+
+						if (data->Batching)
+							m_setItemAttributes(item, systemVM.IsPicked(), false);
 
 						objData->Data->Draw(objData->Instanced, objData->InstanceCount);
 					}
@@ -330,53 +458,40 @@ namespace ed
 						pipe::RenderState* state = reinterpret_cast<pipe::RenderState*>(item->Data);
 						
 						// depth clamp
-						if (state->DepthClamp)
-							glEnable(GL_DEPTH_CLAMP);
-						else
-							glDisable(GL_DEPTH_CLAMP);
+						glState.Enable(GL_DEPTH_CLAMP, state->DepthClamp);
 
 						// fill mode
-						glPolygonMode(GL_FRONT_AND_BACK, state->PolygonMode);
+						glState.PolygonMode(state->PolygonMode);
 
 						// culling and front face
-						if (state->CullFace)
-							glEnable(GL_CULL_FACE);
-						else
-							glDisable(GL_CULL_FACE);
-						glCullFace(state->CullFaceType);
-						glFrontFace(state->FrontFace);
+						glState.Enable(GL_CULL_FACE, state->CullFace);
+						glState.CullFace(state->CullFaceType);
+						glState.FrontFace(state->FrontFace);
 
 						// disable blending
+						glState.Enable(GL_BLEND, state->Blend);
 						if (state->Blend) {
-							glEnable(GL_BLEND);
-							glBlendEquationSeparate(state->BlendFunctionColor, state->BlendFunctionAlpha);
-							glBlendFuncSeparate(state->BlendSourceFactorRGB, state->BlendDestinationFactorRGB, state->BlendSourceFactorAlpha, state->BlendDestinationFactorAlpha);
-							glBlendColor(state->BlendFactor.r, state->BlendFactor.g, state->BlendFactor.a, state->BlendFactor.a);
-							glSampleCoverage(state->AlphaToCoverage, GL_FALSE);
+							glState.BlendEquationSeparate(state->BlendFunctionColor, state->BlendFunctionAlpha);
+							glState.BlendFuncSeparate(state->BlendSourceFactorRGB, state->BlendDestinationFactorRGB, state->BlendSourceFactorAlpha, state->BlendDestinationFactorAlpha);
+							glState.BlendColor(state->BlendFactor.r, state->BlendFactor.g, state->BlendFactor.a, state->BlendFactor.a);
+							glState.SampleCoverage(state->AlphaToCoverage, GL_FALSE);
 						}
-						else
-							glDisable(GL_BLEND);
 
 						// depth state
-						if (state->DepthTest)
-							glEnable(GL_DEPTH_TEST);
-						else
-							glDisable(GL_DEPTH_TEST);
-						glDepthMask(state->DepthMask);
-						glDepthFunc(state->DepthFunction);
-						glPolygonOffset(0.0f, state->DepthBias);
+						glState.Enable(GL_DEPTH_TEST, state->DepthTest);
+						glState.DepthMask(state->DepthMask);
+						glState.DepthFunc(state->DepthFunction);
+						glState.PolygonOffset(0.0f, state->DepthBias);
 
 						// stencil
+						glState.Enable(GL_STENCIL_TEST, state->StencilTest);
 						if (state->StencilTest) {
-							glEnable(GL_STENCIL_TEST);
-							glStencilFuncSeparate(GL_FRONT, state->StencilFrontFaceFunction, 1, state->StencilReference);
-							glStencilFuncSeparate(GL_BACK, state->StencilBackFaceFunction, 1, state->StencilReference);
-							glStencilMask(state->StencilMask);
-							glStencilOpSeparate(GL_FRONT, state->StencilFrontFaceOpStencilFail, state->StencilFrontFaceOpDepthFail, state->StencilFrontFaceOpPass);
-							glStencilOpSeparate(GL_BACK, state->StencilBackFaceOpStencilFail, state->StencilBackFaceOpDepthFail, state->StencilBackFaceOpPass);
+							glState.StencilFuncSeparate(GL_FRONT, state->StencilFrontFaceFunction, 1, state->StencilReference);
+							glState.StencilFuncSeparate(GL_BACK, state->StencilBackFaceFunction, 1, state->StencilReference);
+							glState.StencilMask(state->StencilMask);
+							glState.StencilOpSeparate(GL_FRONT, state->StencilFrontFaceOpStencilFail, state->StencilFrontFaceOpDepthFail, state->StencilFrontFaceOpPass);
+							glState.StencilOpSeparate(GL_BACK, state->StencilBackFaceOpStencilFail, state->StencilBackFaceOpDepthFail, state->StencilBackFaceOpPass);
 						}
-						else
-							glDisable(GL_STENCIL_TEST);
 					}
 					else if (item->Type == PipelineItem::ItemType::PluginItem) {
 						pipe::PluginItemData* pldata = reinterpret_cast<pipe::PluginItemData*>(item->Data);
@@ -389,7 +504,10 @@ namespace ed
 						else
 							systemVM.SetPicked(false);
 
+						m_profiler.BeginStage(Profiler::Stage::Plugin);
 						pldata->Owner->ExecutePipelineItem(data, plugin::PipelineItemType::ShaderPass, pldata->Type, pldata->PluginData);
+						glState.Invalidate();
+						m_profiler.EndStage(Profiler::Stage::Plugin);
 					}
 
 					// set the old value back
@@ -400,11 +518,11 @@ namespace ed
 				}
 
 				if (isDebug)
-					data->Variables.UpdateUniformInfo(m_shaders[i]); // return old variable data
+					data->Variables.UpdateUniformInfo(cache.Program); // return old variable data
 
 				if (isMSAA) {
-					glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fboMS[data]);
-					glBindFramebuffer(GL_DRAW_FRAMEBUFFER, data->FBO);
+					glState.BindFramebuffer(GL_READ_FRAMEBUFFER, cache.FBOMS);
+					glState.BindFramebuffer(GL_DRAW_FRAMEBUFFER, data->FBO);
 					glDrawBuffer(GL_BACK);
 					for (unsigned int i = 0; i < data->RTCount; i++)
 					{
@@ -413,53 +531,64 @@ namespace ed
 						glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
 					}
 				}
+
+				m_storePassResult(data, cache, isDebug);
+
+				m_profiler.EndItem();
 			}
 			else if (it->Type == PipelineItem::ItemType::ComputePass && !isDebug && m_computeSupported) {
 				pipe::ComputePass *data = (pipe::ComputePass *)it->Data;
 
-				const std::vector<GLuint>& srvs = m_objects->GetBindList(m_items[i]);
-				const std::vector<GLuint>& ubos = m_objects->GetUniformBindList(m_items[i]);
+				const std::vector<GLuint>& srvs = m_objects->GetBindList(it);
+				const std::vector<GLuint>& ubos = m_objects->GetUniformBindList(it);
 
-				if (m_shaders[i] == 0)
+				if (cache.Program == 0)
 					continue;
+
+				m_profiler.BeginItem(it);
 				
 				// bind shaders
-				glUseProgram(m_shaders[i]);
+				glState.UseProgram(cache.Program);
 
 				// bind shader resource views
 				for (int j = 0; j < srvs.size(); j++)
 				{
-					glActiveTexture(GL_TEXTURE0 + j);
-					if (m_objects->IsCubeMap(srvs[j]))
-						glBindTexture(GL_TEXTURE_CUBE_MAP, srvs[j]);
-					else if (m_objects->IsImage3D(srvs[j]))
-						glBindTexture(GL_TEXTURE_3D, srvs[j]);
+					ObjectType srvType = m_objects->GetObjectTypeByTextureID(srvs[j]);
+					if (srvType == ObjectType::CubeMap)
+						glState.BindTexture(j, GL_TEXTURE_CUBE_MAP, srvs[j]);
+					else if (srvType == ObjectType::Image3D)
+						glState.BindTexture(j, GL_TEXTURE_3D, srvs[j]);
 					else
-						glBindTexture(GL_TEXTURE_2D, srvs[j]);
+						glState.BindTexture(j, GL_TEXTURE_2D, srvs[j]);
 
 					if (ShaderTranscompiler::GetShaderTypeFromExtension(data->Path) == ShaderLanguage::GLSL) // TODO: or should this be for vulkan glsl too?
-						data->Variables.UpdateTexture(m_shaders[i], j);
+						data->Variables.UpdateTexture(cache.Program, j);
 				}
 
 				// bind buffers
 				for (int j = 0; j < ubos.size(); j++) {
 					if (m_objects->IsImage(ubos[j])) {
-						ImageObject* iobj = m_objects->GetImage(m_objects->GetImageNameByID(ubos[j])); // TODO: GetImageByID
+						ImageObject* iobj = m_objects->GetImage(ubos[j]);
 						glBindImageTexture(j, ubos[j], 0, GL_FALSE, 0, GL_WRITE_ONLY | GL_READ_ONLY, iobj->Format);
 					}
 					else if (m_objects->IsImage3D(ubos[j])) {
-						Image3DObject* iobj = m_objects->GetImage3D(m_objects->GetImage3DNameByID(ubos[j]));
+						Image3DObject* iobj = m_objects->GetImage3D(ubos[j]);
 						glBindImageTexture(j, ubos[j], 0, GL_TRUE, 0, GL_WRITE_ONLY | GL_READ_ONLY, iobj->Format);
 					}
 					else if (m_objects->IsPluginObject(ubos[j])) {
 						PluginObject* pobj = m_objects->GetPluginObject(ubos[j]);
 						pobj->Owner->BindObject(pobj->Type, pobj->Data, pobj->ID);
+						glState.Invalidate();
 					} else
 						glBindBufferBase(GL_SHADER_STORAGE_BUFFER, j, ubos[j]);
 				}
 				
 				// bind variables
+				m_profiler.BeginStage(Profiler::Stage::Uniforms);
+				if (Settings::Instance().Project.SystemUniformBuffer)
+					systemVM.UpdateUniformBuffer();
 				data->Variables.Bind();
+				m_profiler.EndStage(Profiler::Stage::Uniforms);
 
 				// call compute shader
 				glDispatchCompute(data->WorkX, data->WorkY, data->WorkZ);
@@ -467,51 +596,81 @@ namespace ed
 				// wait until it finishes
 				glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_UNIFORM_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
 				// or maybe until i implement these as options glMemoryBarrier(GL_ALL_BARRIER_BITS);
+
+				// the bound images & buffers might have been written to
+				for (int j = 0; j < ubos.size(); j++) {
+					if (m_objects->IsImage(ubos[j]) || m_objects->IsImage3D(ubos[j]))
+						TouchTexture(ubos[j]);
+					else
+						TouchBuffer(ubos[j]);
+				}
+
+				m_profiler.EndItem();
 			}
 			else if (it->Type == PipelineItem::ItemType::AudioPass && !isDebug) {
 				pipe::AudioPass *data = (pipe::AudioPass *)it->Data;
 
-				const std::vector<GLuint>& srvs = m_objects->GetBindList(m_items[i]);
-				const std::vector<GLuint>& ubos = m_objects->GetUniformBindList(m_items[i]);
+				const std::vector<GLuint>& srvs = m_objects->GetBindList(it);
+				const std::vector<GLuint>& ubos = m_objects->GetUniformBindList(it);
+
+				m_profiler.BeginItem(it);
 
 				// bind shader resource views
 				for (int j = 0; j < srvs.size(); j++)
 				{
-					glActiveTexture(GL_TEXTURE0 + j);
-					if (m_objects->IsCubeMap(srvs[j]))
-						glBindTexture(GL_TEXTURE_CUBE_MAP, srvs[j]);
-					else if (m_objects->IsImage3D(srvs[j]))
-						glBindTexture(GL_TEXTURE_3D, srvs[j]);
+					ObjectType srvType = m_objects->GetObjectTypeByTextureID(srvs[j]);
+					if (srvType == ObjectType::CubeMap)
+						glState.BindTexture(j, GL_TEXTURE_CUBE_MAP, srvs[j]);
+					else if (srvType == ObjectType::Image3D)
+						glState.BindTexture(j, GL_TEXTURE_3D, srvs[j]);
 					else if (m_objects->IsPluginObject(srvs[j])) {
 						PluginObject* pobj = m_objects->GetPluginObject(srvs[j]);
+						glActiveTexture(GL_TEXTURE0 + j);
 						pobj->Owner->BindObject(pobj->Type, pobj->Data, pobj->ID);
+						glState.Invalidate();
 					}
 					else
-						glBindTexture(GL_TEXTURE_2D, srvs[j]);
+						glState.BindTexture(j, GL_TEXTURE_2D, srvs[j]);
 
 					if (ShaderTranscompiler::GetShaderTypeFromExtension(data->Path) == ShaderLanguage::GLSL) // TODO: or should this be for vulkan glsl too?
-						data->Variables.UpdateTexture(m_shaders[i], j);
+						data->Variables.UpdateTexture(cache.Program, j);
 				}
 
 				// bind buffers
 				for (int j = 0; j < ubos.size(); j++) {
-					if (m_objects->IsBuffer(m_objects->GetBufferNameByID(ubos[j])))
+					if (m_objects->IsBuffer(ubos[j]))
 						glBindBufferBase(GL_SHADER_STORAGE_BUFFER, j, ubos[j]);
 				}
 				
-				// bind variables
+				// bind variables (uniforms are set on the currently bound program)
+				glState.UseProgram(data->Stream.getShader());
+				m_profiler.BeginStage(Profiler::Stage::Uniforms);
 				data->Variables.Bind();
+				m_profiler.EndStage(Profiler::Stage::Uniforms);
 
 				data->Stream.renderAudio();
+
+				m_profiler.EndItem();
 			}
 			else if (it->Type == PipelineItem::ItemType::PluginItem && !isDebug) {
 				pipe::PluginItemData* pldata = reinterpret_cast<pipe::PluginItemData*>(it->Data);
 
+				m_profiler.BeginItem(it);
+				m_profiler.BeginStage(Profiler::Stage::Plugin);
 				pldata->Owner->ExecutePipelineItem(pldata->Type, pldata->PluginData, pldata->Items.data(), pldata->Items.size());
+				glState.Invalidate();
+				m_pluginEpoch++; // we don't know what the plugin has changed
+				m_profiler.EndStage(Profiler::Stage::Plugin);
+				m_profiler.EndItem();
 			}
 		}
 
+		m_profiler.EndFrame();
+
+		systemVM.SetTile(tile);
+
 		m_plugins->EndRender();
+		glState.Invalidate();
 
 		// update frame index
 		if (!m_paused) {
@@ -520,7 +679,8 @@ namespace ed
 		}
 
 		// restore real render target view
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glState.BindFramebuffer(GL_FRAMEBUFFER, 0);
+		glState.End();
 
 		if (m_pickDist == std::numeric_limits<float>::infinity())
 			m_pick.clear();
@@ -709,6 +869,7 @@ namespace ed
 		// bind fbo and buffers
 		glBindFramebuffer(GL_FRAMEBUFFER, vertexPass->FBO);
 		glDrawBuffers(vertexPass->RTCount, fboBuffers);
+		m_touchPassOutputs(vertexPass);
 				
 		glStencilMask(0xFFFFFFFF);
 		glClearBufferfi(GL_DEPTH_STENCIL, 0, 1.0f, 0);
@@ -738,6 +899,8 @@ namespace ed
 
 		// update viewport value
 		glViewport(0, 0, rtSize.x, rtSize.y);
+		if (Settings::Instance().Project.SystemUniformBuffer)
+			SystemVariableManager::Instance().UpdateUniformBuffer();
 
 		// bind shaders
 		glUseProgram(customProgram);
@@ -745,9 +908,10 @@ namespace ed
 		// bind shader resource views
 		for (int j = 0; j < srvs.size(); j++) {
 			glActiveTexture(GL_TEXTURE0 + j);
-			if (m_objects->IsCubeMap(srvs[j]))
+			ObjectType srvType = m_objects->GetObjectTypeByTextureID(srvs[j]);
+			if (srvType == ObjectType::CubeMap)
 				glBindTexture(GL_TEXTURE_CUBE_MAP, srvs[j]);
-			else if (m_objects->IsImage3D(srvs[j]))
+			else if (srvType == ObjectType::Image3D)
 				glBindTexture(GL_TEXTURE_3D, srvs[j]);
 			else if (m_objects->IsPluginObject(srvs[j])) {
 				PluginObject* pobj = m_objects->GetPluginObject(srvs[j]);
@@ -795,11 +959,18 @@ namespace ed
 				// bind variables
 				vertexPass->Variables.Bind(item);
 
-				glBindVertexArray(geoData->VAO);
-				if (geoData->Instanced)
-					glDrawArraysInstanced(geoData->Topology, 0, eng::GeometryFactory::VertexCount[geoData->Type], geoData->InstanceCount);
-				else
-					glDrawArrays(geoData->Topology, 0, eng::GeometryFactory::VertexCount[geoData->Type]);
+				if (vertexPass->Batching && !geoData->Instanced) {
+					m_addToBatch(item, systemVM.IsPicked());
+					m_drawBatch(geoData);
+				} else {
+					glBindVertexArray(geoData->VAO);
+					if (vertexPass->Batching)
+						m_setItemAttributes(item, systemVM.IsPicked(), true);
+					if (geoData->Instanced)
+						glDrawArraysInstanced(geoData->Topology, 0, eng::GeometryFactory::VertexCount[geoData->Type], geoData->InstanceCount);
+					else
+						glDrawArrays(geoData->Topology, 0, eng::GeometryFactory::VertexCount[geoData->Type]);
+				}
 			}
 			else if (item->Type == PipelineItem::ItemType::Model) {
 				pipe::Model* objData = reinterpret_cast<pipe::Model*>(item->Data);
@@ -810,6 +981,9 @@ namespace ed
 				// bind variables
 				vertexPass->Variables.Bind(item);
 
+				if (vertexPass->Batching)
+					m_setItemAttributes(item, systemVM.IsPicked(), false);
+
 				objData->Data->Draw(objData->Instanced, objData->InstanceCount);
 			}
 			else if (item->Type == PipelineItem::ItemType::RenderState) {
@@ -841,19 +1015,13 @@ namespace ed
 		delete[] mainPixelData;
 
 		// return old info
-		for (int i = 0; i < m_items.size(); i++) {
-			PipelineItem* it = m_items[i];
-			if (it == vertexData) {
-				vertexPass->Variables.UpdateUniformInfo(m_shaders[i]);
-				break;
-			}
-		}
+		vertexPass->Variables.UpdateUniformInfo(m_getCache(vertexData).Program);
 
 		// return the actual RT that was shown before
 		Render();
 
 		glDeleteShader(vs);
-		glDeleteProgram(customProgram);
+		m_deleteProgram(customProgram);
 
 		return vertexID;
 	}
@@ -914,6 +1082,7 @@ namespace ed
 		// bind fbo and buffers
 		glBindFramebuffer(GL_FRAMEBUFFER, vertexPass->FBO);
 		glDrawBuffers(vertexPass->RTCount, fboBuffers);
+		m_touchPassOutputs(vertexPass);
 
 		glStencilMask(0xFFFFFFFF);
 		glClearBufferfi(GL_DEPTH_STENCIL, 0, 1.0f, 0);
@@ -943,6 +1112,8 @@ namespace ed
 
 		// update viewport value
 		glViewport(0, 0, rtSize.x, rtSize.y);
+		if (Settings::Instance().Project.SystemUniformBuffer)
+			SystemVariableManager::Instance().UpdateUniformBuffer();
 
 		// bind shaders
 		glUseProgram(customProgram);
@@ -950,9 +1121,10 @@ namespace ed
 		// bind shader resource views
 		for (int j = 0; j < srvs.size(); j++) {
 			glActiveTexture(GL_TEXTURE0 + j);
-			if (m_objects->IsCubeMap(srvs[j]))
+			ObjectType srvType = m_objects->GetObjectTypeByTextureID(srvs[j]);
+			if (srvType == ObjectType::CubeMap)
 				glBindTexture(GL_TEXTURE_CUBE_MAP, srvs[j]);
-			else if (m_objects->IsImage3D(srvs[j]))
+			else if (srvType == ObjectType::Image3D)
 				glBindTexture(GL_TEXTURE_3D, srvs[j]);
 			else if (m_objects->IsPluginObject(srvs[j])) {
 				PluginObject* pobj = m_objects->GetPluginObject(srvs[j]);
@@ -1000,11 +1172,18 @@ namespace ed
 				// bind variables
 				vertexPass->Variables.Bind(item);
 
-				glBindVertexArray(geoData->VAO);
-				if (geoData->Instanced)
-					glDrawArraysInstanced(geoData->Topology, 0, eng::GeometryFactory::VertexCount[geoData->Type], geoData->InstanceCount);
-				else
-					glDrawArrays(geoData->Topology, 0, eng::GeometryFactory::VertexCount[geoData->Type]);
+				if (vertexPass->Batching && !geoData->Instanced) {
+					m_addToBatch(item, systemVM.IsPicked());
+					m_drawBatch(geoData);
+				} else {
+					glBindVertexArray(geoData->VAO);
+					if (vertexPass->Batching)
+						m_setItemAttributes(item, systemVM.IsPicked(), true);
+					if (geoData->Instanced)
+						glDrawArraysInstanced(geoData->Topology, 0, eng::GeometryFactory::VertexCount[geoData->Type], geoData->InstanceCount);
+					else
+						glDrawArrays(geoData->Topology, 0, eng::GeometryFactory::VertexCount[geoData->Type]);
+				}
 			}
 			else if (item->Type == PipelineItem::ItemType::Model) {
 				pipe::Model* objData = reinterpret_cast<pipe::Model*>(item->Data);
@@ -1015,6 +1194,9 @@ namespace ed
 				// bind variables
 				vertexPass->Variables.Bind(item);
 
+				if (vertexPass->Batching)
+					m_setItemAttributes(item, systemVM.IsPicked(), false);
+
 				objData->Data->Draw(objData->Instanced, objData->InstanceCount);
 			}
 			else if (item->Type == PipelineItem::ItemType::RenderState) {
@@ -1046,19 +1228,13 @@ namespace ed
 		delete[] mainPixelData;
 
 		// return old info
-		for (int i = 0; i < m_items.size(); i++) {
-			PipelineItem* it = m_items[i];
-			if (it == vertexData) {
-				vertexPass->Variables.UpdateUniformInfo(m_shaders[i]);
-				break;
-			}
-		}
+		vertexPass->Variables.UpdateUniformInfo(m_getCache(vertexData).Program);
 
 		// return the actual RT that was shown before
 		Render();
 
 		glDeleteShader(vs);
-		glDeleteProgram(customProgram);
+		m_deleteProgram(customProgram);
 
 		return instanceID;
 	}
@@ -1079,161 +1255,23 @@ namespace ed
 
 		m_msgs->BuildOccured = true;
 		m_msgs->CurrentItem = name;
-		
-		GLchar cMsg[1024] = { 0 };
 
 		int d3dCounter = 0;
-		for (int i = 0; i < m_items.size(); i++) {
-			PipelineItem* item = m_items[i];
+		std::vector<PipelineItem*>& items = m_pipeline->GetList();
+		for (int i = 0; i < items.size(); i++) {
+			PipelineItem* item = items[i];
 			if (strcmp(item->Name, name) == 0) {
-				if (item->Type == PipelineItem::ItemType::ShaderPass) {
-					pipe::ShaderPass* shader = (pipe::ShaderPass*)item->Data;
+				PassCache& cache = m_getCache(item);
+				m_cancelCompile(item, cache);
 
+				if (item->Type == PipelineItem::ItemType::ShaderPass || (item->Type == PipelineItem::ItemType::ComputePass && m_computeSupported)) {
 					m_msgs->ClearGroup(name);
 
-					glDeleteShader(m_shaderSources[i].VS);
-					glDeleteShader(m_shaderSources[i].PS);
-					glDeleteShader(m_shaderSources[i].GS);
-
-					std::string psContent = "", vsContent = "",
-						vsEntry = shader->VSEntry,
-						psEntry = shader->PSEntry;
-					int lineBias = 0;
-
-					// pixel shader
-					m_msgs->CurrentItemType = 1;
-					if (ShaderTranscompiler::GetShaderTypeFromExtension(shader->PSPath) == ShaderLanguage::GLSL) {// GLSL
-						psContent = m_project->LoadProjectFile(shader->PSPath);
-						m_includeCheck(psContent, std::vector<std::string>(), lineBias);
-						m_applyMacros(psContent, shader);
-					} else { // HLSL / VK
-						psContent = ShaderTranscompiler::Transcompile(ShaderTranscompiler::GetShaderTypeFromExtension(shader->PSPath), m_project->GetProjectPath(std::string(shader->PSPath)), 1, shader->PSEntry, shader->Macros, shader->GSUsed, m_msgs, m_project);
-						psEntry = "main";
-					}
-
-					shader->Variables.UpdateTextureList(psContent);
-					GLuint ps = gl::CompileShader(GL_FRAGMENT_SHADER, psContent.c_str());
-					bool psCompiled = gl::CheckShaderCompilationStatus(ps, cMsg);
-
-					if (!psCompiled && ShaderTranscompiler::GetShaderTypeFromExtension(shader->PSPath) == ShaderLanguage::GLSL)
-						m_msgs->Add(gl::ParseMessages(name, 1, cMsg, lineBias));
-
-					// vertex shader
-					m_msgs->CurrentItemType = 0;
-					lineBias = 0;
-					if (ShaderTranscompiler::GetShaderTypeFromExtension(shader->VSPath) == ShaderLanguage::GLSL) {// GLSL
-						vsContent = m_project->LoadProjectFile(shader->VSPath);
-						m_includeCheck(vsContent, std::vector<std::string>(), lineBias);
-						m_applyMacros(vsContent, shader);
-					} else { // HLSL / VK
-						vsContent = ShaderTranscompiler::Transcompile(ShaderTranscompiler::GetShaderTypeFromExtension(shader->VSPath), m_project->GetProjectPath(std::string(shader->VSPath)), 0, shader->VSEntry, shader->Macros, shader->GSUsed, m_msgs, m_project);
-						vsEntry = "main";
-					}
-
-					GLuint vs = gl::CompileShader(GL_VERTEX_SHADER, vsContent.c_str());
-					bool vsCompiled = gl::CheckShaderCompilationStatus(vs, cMsg);
-
-					if (!vsCompiled && ShaderTranscompiler::GetShaderTypeFromExtension(shader->PSPath) == ShaderLanguage::GLSL)
-						m_msgs->Add(gl::ParseMessages(name, 0, cMsg, lineBias));
+					// same path as the initial compilation -> uses the program binary cache too
+					m_cacheItem(item, cache, false);
 
-					// geometry shader
-					bool gsCompiled = true;
-					GLuint gs = 0;
-					if (shader->GSUsed && strlen(shader->GSPath) > 0 && strlen(shader->GSEntry) > 0) {
-						std::string gsContent = "",
-							gsEntry = shader->GSEntry;
-
-						m_msgs->CurrentItemType = 2;
-						lineBias = 0;
-						if (ShaderTranscompiler::GetShaderTypeFromExtension(shader->GSPath) == ShaderLanguage::GLSL) {// GLSL
-							gsContent = m_project->LoadProjectFile(shader->GSPath);
-							m_includeCheck(gsContent, std::vector<std::string>(), lineBias);
-							m_applyMacros(gsContent, shader);
-						} else { // HLSL / VK
-							gsContent = ShaderTranscompiler::Transcompile(ShaderTranscompiler::GetShaderTypeFromExtension(shader->GSPath), m_project->GetProjectPath(std::string(shader->GSPath)), 2, shader->GSEntry, shader->Macros, shader->GSUsed, m_msgs, m_project);
-							gsEntry = "main";
-
-							// TODO: delete this when glslang fixes this https://github.com/KhronosGroup/glslang/issues/1660
-							m_msgs->Add(MessageStack::Type::Warning, name, "HLSL geometry shaders are currently not supported by glslang");
-						}
-
-						gs = gl::CompileShader(GL_GEOMETRY_SHADER, gsContent.c_str());
-						gsCompiled = gl::CheckShaderCompilationStatus(gs, cMsg);
-
-						if (!gsCompiled && ShaderTranscompiler::GetShaderTypeFromExtension(shader->GSPath) == ShaderLanguage::GLSL)
-							m_msgs->Add(gl::ParseMessages(name, 2, cMsg, lineBias));
-					}
-
-					if (m_shaders[i] != 0)
-						glDeleteProgram(m_shaders[i]);
-
-					if (!vsCompiled || !psCompiled || !gsCompiled) {
-						Logger::Get().Log("Shaders not compiled", true); 
-						m_msgs->Add(MessageStack::Type::Error, name, "Failed to compile the shader(s)");
-						m_shaders[i] = 0;
-					}
-					else {
-						m_msgs->Add(MessageStack::Type::Message, name, "Compiled the shaders.");
-
-						m_shaders[i] = glCreateProgram();
-						glAttachShader(m_shaders[i], vs);
-						glAttachShader(m_shaders[i], ps);
-						if (shader->GSUsed) glAttachShader(m_shaders[i], gs);
-						glLinkProgram(m_shaders[i]);
-					}
-
-					if (m_shaders[i] != 0)
-						shader->Variables.UpdateUniformInfo(m_shaders[i]);
-
-					m_shaderSources[i].VS = vs;
-					m_shaderSources[i].PS = ps;
-					m_shaderSources[i].GS = gs;
-				}
-				else if (item->Type == PipelineItem::ItemType::ComputePass && m_computeSupported) {
-					pipe::ComputePass *shader = (pipe::ComputePass *)item->Data;
-
-					m_msgs->ClearGroup(name);
-
-					std::string content = "", entry = shader->Entry;
-					int lineBias = 0;
-
-					// compute shader
-					m_msgs->CurrentItemType = 3;
-					if (ShaderTranscompiler::GetShaderTypeFromExtension(shader->Path) == ShaderLanguage::GLSL) {// GLSL
-						content = m_project->LoadProjectFile(shader->Path);
-						m_includeCheck(content, std::vector<std::string>(), lineBias);
-						m_applyMacros(content, shader);
-					} else { // HLSL / VK
-						content = ShaderTranscompiler::Transcompile(ShaderTranscompiler::GetShaderTypeFromExtension(shader->Path), m_project->GetProjectPath(std::string(shader->Path)), 3, entry, shader->Macros, false, m_msgs, m_project);
-						entry = "main";
-					}
-
-					// compute shader supported == version 4.3 == not needed: shader->Variables.UpdateTextureList(content);
-					GLuint cs = gl::CompileShader(GL_COMPUTE_SHADER, content.c_str());
-					bool compiled = gl::CheckShaderCompilationStatus(cs, cMsg);
-
-					if (!compiled && ShaderTranscompiler::GetShaderTypeFromExtension(shader->Path) == ShaderLanguage::GLSL)
-						m_msgs->Add(gl::ParseMessages(name, 3, cMsg, lineBias));
-
-					if (m_shaders[i] != 0)
-						glDeleteProgram(m_shaders[i]);
-
-					if (!compiled) {
-						Logger::Get().Log("Compute shader was not compiled", true);
-						m_msgs->Add(MessageStack::Type::Error, name, "Failed to compile the compute shader");
-						m_shaders[i] = 0;
-					} else {
-						m_msgs->Add(MessageStack::Type::Message, name, "Compiled the compute shader.");
-
-						m_shaders[i] = glCreateProgram();
-						glAttachShader(m_shaders[i], cs);
-						glLinkProgram(m_shaders[i]);
-					}
-
-					glDeleteShader(cs);
-
-					if (m_shaders[i] != 0)
-						shader->Variables.UpdateUniformInfo(m_shaders[i]);
+					if (cache.Program != 0)
+						m_msgs->Add(MessageStack::Type::Message, name, item->Type == PipelineItem::ItemType::ComputePass ? "Compiled the compute shader." : "Compiled the shaders.");
 				}
 				else if (item->Type == PipelineItem::ItemType::AudioPass) {
 					pipe::AudioPass *shader = (pipe::AudioPass *)item->Data;
@@ -1262,8 +1300,18 @@ namespace ed
 	}
 	void RenderEngine::RecompileFile(const char* fname)
 	{
-		for (int i = 0; i < m_items.size(); i++) {
-			PipelineItem* item = m_items[i];
+		std::string fpath = m_project->GetProjectPath(fname);
+
+		std::vector<PipelineItem*>& items = m_pipeline->GetList();
+		for (int i = 0; i < items.size(); i++) {
+			PipelineItem* item = items[i];
+
+			// the file is #include'd by this item
+			if (IncludeCache::Instance().DependsOn(item, fpath)) {
+				Recompile(item->Name);
+				continue;
+			}
+
 			if (item->Type == PipelineItem::ItemType::ShaderPass) {
 				pipe::ShaderPass* shader = (pipe::ShaderPass*)item->Data;
 				if (strcmp(shader->VSPath, fname) == 0 ||
@@ -1293,9 +1341,13 @@ namespace ed
 		GLchar cMsg[1024];
 
 		int d3dCounter = 0;
-		for (int i = 0; i < m_items.size(); i++) {
-			PipelineItem* item = m_items[i];
+		std::vector<PipelineItem*>& items = m_pipeline->GetList();
+		for (int i = 0; i < items.size(); i++) {
+			PipelineItem* item = items[i];
 			if (strcmp(item->Name, name) == 0) {
+				PassCache& cache = m_getCache(item);
+				m_cancelCompile(item, cache);
+
 				if (item->Type == PipelineItem::ItemType::ShaderPass) {
 					pipe::ShaderPass* shader = (pipe::ShaderPass*)item->Data;
 					m_msgs->ClearGroup(name);
@@ -1312,8 +1364,8 @@ namespace ed
 						if (!psCompiled && ShaderTranscompiler::GetShaderTypeFromExtension(shader->PSPath) == ShaderLanguage::GLSL)
 							m_msgs->Add(gl::ParseMessages(name, 1, cMsg));
 
-						glDeleteShader(m_shaderSources[i].PS);
-						m_shaderSources[i].PS = ps;
+						glDeleteShader(cache.Sources.PS);
+						cache.Sources.PS = ps;
 					}
 
 					// vertex shader
@@ -1325,14 +1377,14 @@ namespace ed
 						if (!vsCompiled && ShaderTranscompiler::GetShaderTypeFromExtension(shader->VSPath) == ShaderLanguage::GLSL)
 							m_msgs->Add(gl::ParseMessages(name, 0, cMsg));
 
-						glDeleteShader(m_shaderSources[i].VS);
-						m_shaderSources[i].VS = vs;
+						glDeleteShader(cache.Sources.VS);
+						cache.Sources.VS = vs;
 					}
 
 					// geometry shader
 					if (gssrc.size() > 0) {
 						GLuint gs = 0;
-						glDeleteShader(m_shaderSources[i].GS);
+						glDeleteShader(cache.Sources.GS);
 						if (shader->GSUsed && strlen(shader->GSPath) > 0 && strlen(shader->GSEntry) > 0) {
 							gs = gl::CompileShader(GL_GEOMETRY_SHADER, gssrc.c_str());
 							gsCompiled = gl::CheckShaderCompilationStatus(gs, cMsg);
@@ -1344,29 +1396,51 @@ namespace ed
 							if (ShaderTranscompiler::GetShaderTypeFromExtension(shader->VSPath) == ShaderLanguage::HLSL)
 								m_msgs->Add(MessageStack::Type::Warning, name, "HLSL geometry shaders are currently not supported by glslang");
 
-							m_shaderSources[i].GS = gs;
+							cache.Sources.GS = gs;
 						}
 					}
 
-					if (m_shaders[i] != 0)
-						glDeleteProgram(m_shaders[i]);
+					// programs loaded from the ProgramBinaryCache have no shader objects -> compile the stages that weren't edited from their files
+					auto compileStage = [&](int stage, GLenum type, const char* path, const char* entry, GLuint& out) -> bool {
+						std::vector<std::string> includes;
+						m_msgs->CurrentItemType = stage;
+						m_transcompile(cache, item, stage, path, entry, shader->Macros, shader->GSUsed, false);
+						std::string src = m_getStageSource(cache, stage, path, shader->Macros, includes);
+
+						out = gl::CompileShader(type, src.c_str());
+						bool ret = gl::CheckShaderCompilationStatus(out, cMsg);
+						if (!ret && ShaderTranscompiler::GetShaderTypeFromExtension(path) == ShaderLanguage::GLSL)
+							m_msgs->Add(gl::ParseMessages(name, stage, cMsg, cache.LineBias[stage]));
+						return ret;
+					};
+					if (cache.Sources.VS == 0)
+						vsCompiled = compileStage(0, GL_VERTEX_SHADER, shader->VSPath, shader->VSEntry, cache.Sources.VS);
+					if (cache.Sources.PS == 0)
+						psCompiled = compileStage(1, GL_FRAGMENT_SHADER, shader->PSPath, shader->PSEntry, cache.Sources.PS);
+					if (cache.Sources.GS == 0 && shader->GSUsed && strlen(shader->GSPath) > 0 && strlen(shader->GSEntry) > 0)
+						gsCompiled = compileStage(2, GL_GEOMETRY_SHADER, shader->GSPath, shader->GSEntry, cache.Sources.GS);
+
+					if (cache.Program != 0)
+						m_deleteProgram(cache.Program);
 
 					if (!vsCompiled || !psCompiled || !gsCompiled) {
 						m_msgs->Add(MessageStack::Type::Error, name, "Failed to compile the shader(s)");
-						m_shaders[i] = 0;
+						cache.Program = 0;
 					}
 					else {
 						m_msgs->Add(MessageStack::Type::Message, name, "Compiled the shaders.");
 
-						m_shaders[i] = glCreateProgram();
-						glAttachShader(m_shaders[i], m_shaderSources[i].VS);
-						glAttachShader(m_shaders[i], m_shaderSources[i].PS);
-						if (shader->GSUsed) glAttachShader(m_shaders[i], m_shaderSources[i].GS);
-						glLinkProgram(m_shaders[i]);
+						cache.Program = glCreateProgram();
+						glAttachShader(cache.Program, cache.Sources.VS);
+						glAttachShader(cache.Program, cache.Sources.PS);
+						if (shader->GSUsed) glAttachShader(cache.Program, cache.Sources.GS);
+						glLinkProgram(cache.Program);
 					}
 
-					if (m_shaders[i] != 0)
-						shader->Variables.UpdateUniformInfo(m_shaders[i]);
+					m_programChanged(cache);
+
+					if (cache.Program != 0)
+						shader->Variables.UpdateUniformInfo(cache.Program);
 				}
 				else if (item->Type == PipelineItem::ItemType::ComputePass && m_computeSupported) {
 					pipe::ComputePass *shader = (pipe::ComputePass *)item->Data;
@@ -1386,25 +1460,27 @@ namespace ed
 							m_msgs->Add(gl::ParseMessages(name, 3, cMsg));
 					}
 
-					if (m_shaders[i] != 0)
-						glDeleteProgram(m_shaders[i]);
+					if (cache.Program != 0)
+						m_deleteProgram(cache.Program);
 
 					if (!compiled)
 					{
 						m_msgs->Add(MessageStack::Type::Error, name, "Failed to compile the compute shader");
-						m_shaders[i] = 0;
+						cache.Program = 0;
 					}
 					else
 					{
 						m_msgs->Add(MessageStack::Type::Message, name, "Compiled the compute shader.");
 
-						m_shaders[i] = glCreateProgram();
-						glAttachShader(m_shaders[i], cs);
-						glLinkProgram(m_shaders[i]);
+						cache.Program = glCreateProgram();
+						glAttachShader(cache.Program, cs);
+						glLinkProgram(cache.Program);
 					}
 
-					if (m_shaders[i] != 0)
-						shader->Variables.UpdateUniformInfo(m_shaders[i]);
+					m_programChanged(cache);
+
+					if (cache.Program != 0)
+						shader->Variables.UpdateUniformInfo(cache.Program);
 
 					glDeleteShader(cs);
 				}
@@ -1445,6 +1521,69 @@ namespace ed
 		m_pickDir = glm::normalize(glm::vec3(worldPos));
 		m_pickOrigin = SystemVariableManager::Instance().GetCamera()->GetPosition();
 	}
+	bool RenderEngine::m_canBatch(PipelineItem* first, PipelineItem* item, const std::vector<ItemVariableValue>& itemValues)
+	{
+		if (item->Type != PipelineItem::ItemType::Geometry)
+			return false;
+
+		pipe::GeometryItem* firstData = reinterpret_cast<pipe::GeometryItem*>(first->Data);
+		pipe::GeometryItem* itemData = reinterpret_cast<pipe::GeometryItem*>(item->Data);
+		if (itemData->Instanced || itemData->Type != firstData->Type || itemData->Topology != firstData->Topology || itemData->Size != firstData->Size)
+			return false;
+
+		// items with their own variable values need their own Variables.Bind()
+		for (const auto& val : itemValues)
+			if (val.Item == first || val.Item == item)
+				return false;
+
+		return true;
+	}
+	void RenderEngine::m_addToBatch(PipelineItem* item, bool picked)
+	{
+		glm::mat4 transform = SystemVariableManager::Instance().GetGeometryTransform(item);
+		const float* raw = glm::value_ptr(transform);
+
+		m_batchData.insert(m_batchData.end(), raw, raw + 16);
+		m_batchData.push_back(picked ? 1.0f : 0.0f);
+		m_batchCount++;
+	}
+	void RenderEngine::m_drawBatch(pipe::GeometryItem* geo)
+	{
+		const GLsizei stride = BATCH_ELEMENT_SIZE * sizeof(GLfloat);
+
+		glBindBuffer(GL_ARRAY_BUFFER, m_batchVBO);
+		glBufferData(GL_ARRAY_BUFFER, m_batchData.size() * sizeof(GLfloat), m_batchData.data(), GL_STREAM_DRAW);
+
+		// per instance attributes on the geometry's VAO
+		glBindVertexArray(geo->VAO);
+		for (int i = 0; i < 4; i++) {
+			glVertexAttribPointer(BATCH_ATTRIBUTE_LOCATION + i, 4, GL_FLOAT, GL_FALSE, stride, (void*)(i * 4 * sizeof(GLfloat)));
+			glEnableVertexAttribArray(BATCH_ATTRIBUTE_LOCATION + i);
+			glVertexAttribDivisor(BATCH_ATTRIBUTE_LOCATION + i, 1);
+		}
+		glVertexAttribPointer(BATCH_ATTRIBUTE_LOCATION + 4, 1, GL_FLOAT, GL_FALSE, stride, (void*)(16 * sizeof(GLfloat)));
+		glEnableVertexAttribArray(BATCH_ATTRIBUTE_LOCATION + 4);
+		glVertexAttribDivisor(BATCH_ATTRIBUTE_LOCATION + 4, 1);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		glDrawArraysInstanced(geo->Topology, 0, eng::GeometryFactory::VertexCount[geo->Type], m_batchCount);
+
+		m_batchData.clear();
+		m_batchCount = 0;
+	}
+	void RenderEngine::m_setItemAttributes(PipelineItem* item, bool picked, bool disableArrays)
+	{
+		// a batch might have left its instance buffer attached to the bound VAO
+		if (disableArrays)
+			for (int i = 0; i < 5; i++)
+				glDisableVertexAttribArray(BATCH_ATTRIBUTE_LOCATION + i);
+
+		// generic attribute values - every vertex & instance of the item reads the same transform
+		glm::mat4 transform = SystemVariableManager::Instance().GetGeometryTransform(item);
+		for (int i = 0; i < 4; i++)
+			glVertexAttrib4fv(BATCH_ATTRIBUTE_LOCATION + i, glm::value_ptr(transform[i]));
+		glVertexAttrib1f(BATCH_ATTRIBUTE_LOCATION + 4, picked ? 1.0f : 0.0f);
+	}
 	void RenderEngine::m_pickItem(PipelineItem* item, bool multiPick)
 	{
 		glm::mat4 world(1);
@@ -1599,13 +1738,14 @@ namespace ed
 	std::pair<PipelineItem*, PipelineItem*> RenderEngine::GetPipelineItemByID(int id)
 	{
 		int debugID = DEBUG_ID_START;
-		for (int i = 0; i < m_items.size(); i++) {
-			PipelineItem* it = m_items[i];
+		std::vector<PipelineItem*>& items = m_pipeline->GetList();
+		for (int i = 0; i < items.size(); i++) {
+			PipelineItem* it = items[i];
 
 			if (it->Type == PipelineItem::ItemType::ShaderPass) {
 				pipe::ShaderPass* data = (pipe::ShaderPass*)it->Data;
 
-				if (!data->Active || data->Items.size() <= 0 || data->RTCount == 0 || m_shaders[i] == 0)
+				if (!data->Active || data->Items.size() <= 0 || data->RTCount == 0 || m_getCache(it).Program == 0)
 					continue;
 
 				// render pipeline items
@@ -1627,19 +1767,12 @@ namespace ed
 	}
 	void RenderEngine::FlushCache()
 	{
-		for (int i = 0; i < m_shaders.size(); i++) {
-			glDeleteShader(m_shaderSources[i].VS);
-			glDeleteShader(m_shaderSources[i].PS);
-			glDeleteShader(m_shaderSources[i].GS);
-			glDeleteProgram(m_shaders[i]);
-		}
-		
-		m_fbos.clear();
-		m_fboCount.clear();
-		m_items.clear();
-		m_shaders.clear();
-		m_shaderSources.clear();
-		m_fbosNeedUpdate = true;
+		m_clearCache();
+
+		// cache the items again on the next render
+		std::vector<PipelineItem*>& items = m_pipeline->GetList();
+		for (PipelineItem* item : items)
+			AddItemCache(item);
 
 		// clear textures
 		glBindTexture(GL_TEXTURE_2D, m_rtColor);
@@ -1650,314 +1783,407 @@ namespace ed
 	
 		m_lastSize = glm::ivec2(1,1); // recreate window rt!
 	}
-	void RenderEngine::m_cache()
+	void RenderEngine::AddItemCache(PipelineItem* item)
 	{
-		// check for any changes
-		std::vector<ed::PipelineItem*>& items = m_pipeline->GetList();
-
-		// check if no major changes were made, if so dont cache for another 0.25s
-		if (m_items.size() == items.size()) {
-			if (m_cacheTimer.GetElapsedTime() > 0.5f)
-				m_cacheTimer.Restart();
-			else return;
-		}
-
-		GLchar cMsg[1024];
-
-		// check if some item was added
-		for (int i = 0; i < items.size(); i++) {
-			bool found = false;
-			for (int j = 0; j < m_items.size(); j++)
-				if (items[i]->Data == m_items[j]->Data) {
-					found = true;
-					break;
-				}
-
-			if (!found) {
-				Logger::Get().Log("Caching a new shader pass " + std::string(items[i]->Name));
-
-				if (items[i]->Type == PipelineItem::ItemType::ShaderPass) {
-					pipe::ShaderPass* data = reinterpret_cast<ed::pipe::ShaderPass*>(items[i]->Data);
-
-					m_items.insert(m_items.begin() + i, items[i]);
-					m_shaders.insert(m_shaders.begin() + i, 0);
-					m_debugShaders.insert(m_debugShaders.begin() + i, 0);
-					m_shaderSources.insert(m_shaderSources.begin() + i, ShaderPack());
-
-					if (strlen(data->VSPath) == 0 || strlen(data->PSPath) == 0) {
-						Logger::Get().Log("No shader paths are set", true);
-						continue;
-					}
-
-					glDeleteShader(m_shaderSources[i].VS);
-					glDeleteShader(m_shaderSources[i].PS);
-					glDeleteShader(m_shaderSources[i].GS);
-
-					/*
-						ITEM CACHING
-					*/
-
-					m_fbos[data].resize(MAX_RENDER_TEXTURES);
+		if (m_passes.count(item))
+			return;
 
-					GLuint ps = 0, vs = 0, gs = 0;
+		m_passes[item] = PassCache();
+		m_uncached.push_back(item);
+	}
+	void RenderEngine::RemoveItemCache(PipelineItem* item)
+	{
+		auto cache = m_passes.find(item);
+		if (cache == m_passes.end())
+			return;
 
-					m_msgs->CurrentItem = items[i]->Name;
+		Logger::Get().Log("Removing an item from cache");
 
-					std::string psContent = "", vsContent = "",
-						vsEntry = data->VSEntry,
-						psEntry = data->PSEntry;
-					int lineBias = 0;
+		m_cancelCompile(item, cache->second);
+		m_freeCache(cache->second);
+		m_passes.erase(cache);
 
-					// vertex shader
-					m_msgs->CurrentItemType = 0;
-					if (ShaderTranscompiler::GetShaderTypeFromExtension(data->VSPath) == ShaderLanguage::GLSL) { // GLSL
-						vsContent = m_project->LoadProjectFile(data->VSPath);
-						m_includeCheck(vsContent, std::vector<std::string>(), lineBias);
-						m_applyMacros(vsContent, data);
-					} else { // HLSL / VK
-						vsContent = ShaderTranscompiler::Transcompile(ShaderTranscompiler::GetShaderTypeFromExtension(data->VSPath), m_project->GetProjectPath(std::string(data->VSPath)), 0, data->VSEntry, data->Macros, data->GSUsed, m_msgs, m_project);
-						vsEntry = "main";
-					}
-					
-					vs = gl::CompileShader(GL_VERTEX_SHADER, vsContent.c_str());
-					bool vsCompiled = gl::CheckShaderCompilationStatus(vs, cMsg);
+		IncludeCache::Instance().RemoveDependencies(item);
+	}
+	void RenderEngine::WaitForCompilation()
+	{
+		while (IsCompiling()) {
+			m_cache();
+			if (IsCompiling())
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+	void RenderEngine::m_clearCache()
+	{
+		for (auto& cache : m_passes) {
+			m_freeCache(cache.second);
+			IncludeCache::Instance().RemoveDependencies(cache.first);
+		}
 
-					if (!vsCompiled && ShaderTranscompiler::GetShaderTypeFromExtension(data->VSPath) == ShaderLanguage::GLSL)
-						m_msgs->Add(gl::ParseMessages(m_msgs->CurrentItem, 0, cMsg, lineBias));
+		m_passes.clear();
+		m_uncached.clear();
+		m_compiling.clear();
+		m_compileDone = m_compileTotal = 0;
+	}
+	void RenderEngine::m_freeCache(PassCache& cache)
+	{
+		glDeleteShader(cache.Sources.VS);
+		glDeleteShader(cache.Sources.PS);
+		glDeleteShader(cache.Sources.GS);
+		glDeleteShader(cache.Sources.CS);
+		m_deleteProgram(cache.Program);
+		m_deleteProgram(cache.DebugProgram);
+		m_deleteProgram(cache.LinkProgram);
+		m_deleteProgram(cache.LinkDebugProgram);
+		glDeleteFramebuffers(1, &cache.FBOMS);
+	}
+	void RenderEngine::m_deleteProgram(GLuint program)
+	{
+		if (program == 0)
+			return;
+		ShaderVariableContainer::ForgetProgram(program);
+		GLState::Instance().DeleteProgram(program);
+	}
+	RenderEngine::PassCache& RenderEngine::m_getCache(PipelineItem* item)
+	{
+		auto cache = m_passes.find(item);
+		if (cache != m_passes.end())
+			return cache->second;
 
-					// pixel shader
-					m_msgs->CurrentItemType = 1;
-					lineBias = 0;
-					if (ShaderTranscompiler::GetShaderTypeFromExtension(data->PSPath) == ShaderLanguage::GLSL) { // GLSL
-						psContent = m_project->LoadProjectFile(data->PSPath);
-						m_includeCheck(psContent, std::vector<std::string>(), lineBias);
-						m_applyMacros(psContent, data);
-					} else { // HLSL / VK
-						psContent = ShaderTranscompiler::Transcompile(ShaderTranscompiler::GetShaderTypeFromExtension(data->PSPath), m_project->GetProjectPath(std::string(data->PSPath)), 1, data->PSEntry, data->Macros, data->GSUsed, m_msgs, m_project);
-						psEntry = "main";
-					}
+		// the item wasn't announced by the PipelineManager -> cache it right away
+		PassCache& ret = m_passes[item];
+		m_cacheItem(item, ret, false);
+		return ret;
+	}
+	void RenderEngine::m_cache()
+	{
+		// items that were added since the last frame
+		std::vector<PipelineItem*> uncached = m_uncached;
+		m_uncached.clear();
+		for (PipelineItem* item : uncached)
+			m_cacheItem(item, m_passes[item], true);
+
+		// compile & link the items whose sources are ready, never wait for the workers or the driver here
+		for (int i = 0; i < m_compiling.size(); i++) {
+			PipelineItem* item = m_compiling[i];
+			PassCache& cache = m_passes[item];
+
+			if (cache.Status == PassCache::State::Transcompiling) {
+				bool transcompiled = true;
+				for (int j = 0; j < 4; j++)
+					if (cache.Tasks[j] != nullptr && !cache.Tasks[j]->Done)
+						transcompiled = false;
+
+				if (transcompiled)
+					m_compileItem(item, cache);
+			}
 
-					data->Variables.UpdateTextureList(psContent);
-					ps = gl::CompileShader(GL_FRAGMENT_SHADER, psContent.c_str());
-					bool psCompiled = gl::CheckShaderCompilationStatus(ps, cMsg);
+			if (cache.Status == PassCache::State::Linking) {
+				GLint linked = 1, debugLinked = 1;
+				if (m_parallelCompile) {
+					glGetProgramiv(cache.LinkProgram, GL_COMPLETION_STATUS_KHR, &linked);
+					if (cache.LinkDebugProgram != 0)
+						glGetProgramiv(cache.LinkDebugProgram, GL_COMPLETION_STATUS_KHR, &debugLinked);
+				}
 
-					if (!psCompiled && ShaderTranscompiler::GetShaderTypeFromExtension(data->PSPath) == ShaderLanguage::GLSL)
-						m_msgs->Add(gl::ParseMessages(m_msgs->CurrentItem, 1, cMsg, lineBias));
+				if (linked && debugLinked) {
+					m_finishItem(item, cache);
 
-					// geometry shader
-					lineBias = 0;
-					bool gsCompiled = true;
-					if (data->GSUsed && strlen(data->GSEntry) > 0 && strlen(data->GSPath) > 0) {
-						std::string gsContent = "", gsEntry = data->GSEntry;
-						m_msgs->CurrentItemType = 2;
-						if (ShaderTranscompiler::GetShaderTypeFromExtension(data->GSPath) == ShaderLanguage::GLSL) { // GLSL
-							gsContent = m_project->LoadProjectFile(data->GSPath);
-							m_includeCheck(gsContent, std::vector<std::string>(), lineBias);
-							m_applyMacros(gsContent, data);
-						} else { // HLSL
-							gsContent = ShaderTranscompiler::Transcompile(ShaderTranscompiler::GetShaderTypeFromExtension(data->GSPath), m_project->GetProjectPath(std::string(data->GSPath)), 2, data->GSEntry, data->Macros, data->GSUsed, m_msgs, m_project);
-							gsEntry = "main";
-							
-							m_msgs->Add(MessageStack::Type::Warning, m_msgs->CurrentItem, "Geometry shaders are currently not supported by glslang");
-						}
+					m_compiling.erase(m_compiling.begin() + i);
+					m_compileDone++;
+					i--;
+				}
+			}
+		}
 
-						gs = gl::CompileShader(GL_GEOMETRY_SHADER, gsContent.c_str());
-						gsCompiled = gl::CheckShaderCompilationStatus(gs, cMsg);
+		if (m_compiling.size() == 0)
+			m_compileDone = m_compileTotal = 0;
+	}
+	void RenderEngine::m_cacheItem(PipelineItem* item, PassCache& cache, bool async)
+	{
+		Logger::Get().Log("Compiling shader pass " + std::string(item->Name));
 
-						if (!gsCompiled && ShaderTranscompiler::GetShaderTypeFromExtension(data->GSPath) == ShaderLanguage::GLSL)
-							m_msgs->Add(gl::ParseMessages(m_msgs->CurrentItem, 2, cMsg, lineBias));
+		if (item->Type == PipelineItem::ItemType::ShaderPass) {
+			pipe::ShaderPass* data = reinterpret_cast<ed::pipe::ShaderPass*>(item->Data);
 
-					}
+			if (strlen(data->VSPath) == 0 || strlen(data->PSPath) == 0) {
+				Logger::Get().Log("No shader paths are set", true);
+				return;
+			}
 
-					if (m_shaders[i] != 0)
-						glDeleteProgram(m_shaders[i]);
+			m_transcompile(cache, item, 0, data->VSPath, data->VSEntry, data->Macros, data->GSUsed, async);
+			m_transcompile(cache, item, 1, data->PSPath, data->PSEntry, data->Macros, data->GSUsed, async);
+			if (data->GSUsed && strlen(data->GSEntry) > 0 && strlen(data->GSPath) > 0)
+				m_transcompile(cache, item, 2, data->GSPath, data->GSEntry, data->Macros, data->GSUsed, async);
+		}
+		else if (item->Type == PipelineItem::ItemType::ComputePass && m_computeSupported) {
+			pipe::ComputePass* data = reinterpret_cast<ed::pipe::ComputePass*>(item->Data);
 
-					if (m_debugShaders[i] != 0)
-						glDeleteProgram(m_debugShaders[i]);
+			if (strlen(data->Path) == 0) {
+				Logger::Get().Log("No shader paths are set", true);
+				return;
+			}
 
-					if (!vsCompiled || !psCompiled || !gsCompiled) {
-						m_msgs->Add(MessageStack::Type::Error, items[i]->Name, "Failed to compile the shader");
-						m_shaders[i] = 0;
-					} else {
-						m_msgs->ClearGroup(items[i]->Name);
-
-						m_shaders[i] = glCreateProgram();
-						glAttachShader(m_shaders[i], vs);
-						glAttachShader(m_shaders[i], ps);
-						if (data->GSUsed) glAttachShader(m_shaders[i], gs);
-						glLinkProgram(m_shaders[i]);
-
-						m_debugShaders[i] = glCreateProgram();
-						glAttachShader(m_debugShaders[i], m_debugPixelShader);
-						glAttachShader(m_debugShaders[i], vs);
-						glLinkProgram(m_debugShaders[i]);
-					}
+			m_transcompile(cache, item, 3, data->Path, data->Entry, data->Macros, false, async);
+		}
+		else if (item->Type == PipelineItem::ItemType::AudioPass) {
+			pipe::AudioPass *data = reinterpret_cast<ed::pipe::AudioPass *>(item->Data);
 
-					if (m_shaders[i] != 0)
-						data->Variables.UpdateUniformInfo(m_shaders[i]);
+			m_msgs->CurrentItem = item->Name;
+			std::string content = m_project->LoadProjectFile(data->Path);
 
-					m_shaderSources[i].VS = vs;
-					m_shaderSources[i].PS = ps;
-					m_shaderSources[i].GS = gs;
-				} 
-				else if (items[i]->Type == PipelineItem::ItemType::ComputePass && m_computeSupported) {
-					pipe::ComputePass *data = reinterpret_cast<ed::pipe::ComputePass *>(items[i]->Data);
+			m_msgs->CurrentItemType = 1;
+			if (ShaderTranscompiler::GetShaderTypeFromExtension(data->Path) == ShaderLanguage::GLSL)
+				m_applyMacros(content, data);
+			data->Stream.compileFromShaderSource(m_project, m_msgs, content, data->Macros, ShaderTranscompiler::GetShaderTypeFromExtension(data->Path) == ShaderLanguage::HLSL);
+				
+			data->Variables.UpdateUniformInfo(data->Stream.getShader());
+			return;
+		}
+		else
+			return;
 
-					m_items.insert(m_items.begin() + i, items[i]);
-					m_shaders.insert(m_shaders.begin() + i, 0);
-					m_shaderSources.insert(m_shaderSources.begin() + i, ShaderPack());
+		cache.Status = PassCache::State::Transcompiling;
 
-					if (strlen(data->Path) == 0) {
-						Logger::Get().Log("No shader paths are set", true);
-						continue;
-					}
+		if (async) {
+			m_compiling.push_back(item);
+			m_compileTotal++;
+		} else {
+			m_compileItem(item, cache);
+			m_finishItem(item, cache);
+		}
+	}
+	void RenderEngine::m_transcompile(PassCache& cache, PipelineItem* item, int stage, const char* path, const char* entry, const std::vector<ShaderMacro>& macros, bool gsUsed, bool async)
+	{
+		ShaderLanguage lang = ShaderTranscompiler::GetShaderTypeFromExtension(path);
+		if (lang == ShaderLanguage::GLSL) // loaded on the main thread in m_compileItem
+			return;
 
-					/*
-						ITEM CACHING
-					*/
+		std::shared_ptr<TranscompilerPool::Task> task = std::make_shared<TranscompilerPool::Task>();
+		task->Language = lang;
+		task->Filename = m_project->GetProjectPath(std::string(path));
+		task->ShaderType = stage;
+		task->Entry = entry;
+		task->Macros = macros;
+		task->GSUsed = gsUsed;
+		task->Messages.CurrentItem = item->Name;
+
+		cache.Tasks[stage] = task;
+
+		if (async)
+			m_transcompiler.Add(task);
+		else
+			m_transcompiler.Run(*task);
+	}
+	std::string RenderEngine::m_getStageSource(PassCache& cache, int stage, const char* path, const std::vector<ShaderMacro>& macros, std::vector<std::string>& includes)
+	{
+		cache.LineBias[stage] = 0;
+
+		// HLSL / VK
+		std::shared_ptr<TranscompilerPool::Task> task = cache.Tasks[stage];
+		if (task != nullptr) {
+			cache.Tasks[stage] = nullptr;
+			m_msgs->Add(task->Messages.GetMessages());
+			includes.insert(includes.end(), task->Includes.begin(), task->Includes.end());
+			return task->Source;
+		}
 
-					GLuint cs = 0;
+		// GLSL
+		std::string ret = m_project->LoadProjectFile(path);
+		m_includeCheck(ret, std::vector<std::string>(), cache.LineBias[stage], &includes);
+		m_applyMacros(ret, macros);
+		return ret;
+	}
+	void RenderEngine::m_compileItem(PipelineItem* item, PassCache& cache)
+	{
+		m_msgs->CurrentItem = item->Name;
+
+		std::vector<std::string> includes;
+
+		if (item->Type == PipelineItem::ItemType::ShaderPass) {
+			pipe::ShaderPass* data = reinterpret_cast<ed::pipe::ShaderPass*>(item->Data);
+
+			glDeleteShader(cache.Sources.VS);
+			glDeleteShader(cache.Sources.PS);
+			glDeleteShader(cache.Sources.GS);
+			cache.Sources.VS = cache.Sources.PS = cache.Sources.GS = 0;
+
+			// vertex shader
+			m_msgs->CurrentItemType = 0;
+			std::string vsContent = m_getStageSource(cache, 0, data->VSPath, data->Macros, includes);
+
+			// pixel shader
+			m_msgs->CurrentItemType = 1;
+			std::string psContent = m_getStageSource(cache, 1, data->PSPath, data->Macros, includes);
+			data->Variables.UpdateTextureList(psContent);
+
+			// geometry shader
+			std::string gsContent = "";
+			bool gsUsed = data->GSUsed && strlen(data->GSEntry) > 0 && strlen(data->GSPath) > 0;
+			if (gsUsed) {
+				m_msgs->CurrentItemType = 2;
+				gsContent = m_getStageSource(cache, 2, data->GSPath, data->Macros, includes);
+				if (ShaderTranscompiler::GetShaderTypeFromExtension(data->GSPath) != ShaderLanguage::GLSL)
+					m_msgs->Add(MessageStack::Type::Warning, m_msgs->CurrentItem, "Geometry shaders are currently not supported by glslang");
+			}
 
-					m_msgs->CurrentItem = items[i]->Name;
+			IncludeCache::Instance().SetDependencies(item, includes);
+
+			// skip the compilation if both programs are in the binary cache
+			ProgramBinaryCache& binaryCache = ProgramBinaryCache::Instance();
+			cache.BinaryKey = binaryCache.GetKey({ vsContent, psContent, gsContent });
+			cache.DebugBinaryKey = binaryCache.GetKey({ vsContent, "debug" });
+			cache.LinkProgram = binaryCache.Load(cache.BinaryKey);
+			cache.LinkDebugProgram = cache.LinkProgram == 0 ? 0 : binaryCache.Load(cache.DebugBinaryKey);
+			cache.FromBinary = cache.LinkProgram != 0 && cache.LinkDebugProgram != 0;
+			if (cache.FromBinary) {
+				cache.Status = PassCache::State::Linking;
+				return;
+			}
+			m_deleteProgram(cache.LinkProgram);
+
+			cache.Sources.VS = gl::CompileShader(GL_VERTEX_SHADER, vsContent.c_str());
+			cache.Sources.PS = gl::CompileShader(GL_FRAGMENT_SHADER, psContent.c_str());
+			if (gsUsed)
+				cache.Sources.GS = gl::CompileShader(GL_GEOMETRY_SHADER, gsContent.c_str());
+
+			// link right away - with GL_KHR_parallel_shader_compile this doesn't block
+			cache.LinkProgram = glCreateProgram();
+			if (!cache.BinaryKey.empty())
+				glProgramParameteri(cache.LinkProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+			glAttachShader(cache.LinkProgram, cache.Sources.VS);
+			glAttachShader(cache.LinkProgram, cache.Sources.PS);
+			if (data->GSUsed && cache.Sources.GS != 0) glAttachShader(cache.LinkProgram, cache.Sources.GS);
+			glLinkProgram(cache.LinkProgram);
+
+			cache.LinkDebugProgram = glCreateProgram();
+			if (!cache.DebugBinaryKey.empty())
+				glProgramParameteri(cache.LinkDebugProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+			glAttachShader(cache.LinkDebugProgram, m_debugPixelShader);
+			glAttachShader(cache.LinkDebugProgram, cache.Sources.VS);
+			glLinkProgram(cache.LinkDebugProgram);
+		}
+		else if (item->Type == PipelineItem::ItemType::ComputePass) {
+			pipe::ComputePass* data = reinterpret_cast<ed::pipe::ComputePass*>(item->Data);
 
-					std::string content = "", entry = data->Entry;
-					int lineBias = 0;
+			glDeleteShader(cache.Sources.CS);
+			cache.Sources.CS = 0;
 
-					// vertex shader
-					m_msgs->CurrentItemType = 3;
-					if (ShaderTranscompiler::GetShaderTypeFromExtension(data->Path) == ShaderLanguage::GLSL) { // GLSL
-						content = m_project->LoadProjectFile(data->Path);
-						m_includeCheck(content, std::vector<std::string>(), lineBias);
-						m_applyMacros(content, data);
-					} else { // HLSL / VK
-						content = ShaderTranscompiler::Transcompile(ShaderTranscompiler::GetShaderTypeFromExtension(data->Path), m_project->GetProjectPath(std::string(data->Path)), 3, entry, data->Macros, false, m_msgs, m_project);
-						entry = "main";
-					}
+			// compute shader
+			m_msgs->CurrentItemType = 3;
+			std::string content = m_getStageSource(cache, 3, data->Path, data->Macros, includes);
 
-					cs = gl::CompileShader(GL_COMPUTE_SHADER, content.c_str());
-					bool compiled = gl::CheckShaderCompilationStatus(cs, cMsg);
+			IncludeCache::Instance().SetDependencies(item, includes);
 
-					if (!compiled && ShaderTranscompiler::GetShaderTypeFromExtension(data->Path) == ShaderLanguage::GLSL)
-						m_msgs->Add(gl::ParseMessages(m_msgs->CurrentItem, 3, cMsg, lineBias));
+			cache.BinaryKey = ProgramBinaryCache::Instance().GetKey({ content });
+			cache.DebugBinaryKey = "";
+			cache.LinkProgram = ProgramBinaryCache::Instance().Load(cache.BinaryKey);
+			cache.FromBinary = cache.LinkProgram != 0;
+			if (cache.FromBinary) {
+				cache.Status = PassCache::State::Linking;
+				return;
+			}
 
-					if (m_shaders[i] != 0)
-						glDeleteProgram(m_shaders[i]);
+			cache.Sources.CS = gl::CompileShader(GL_COMPUTE_SHADER, content.c_str());
 
-					if (!compiled)
-					{
-						m_msgs->Add(MessageStack::Type::Error, items[i]->Name, "Failed to compile the compute shader");
-						m_shaders[i] = 0;
-					}
-					else
-					{
-						m_msgs->ClearGroup(items[i]->Name);
+			cache.LinkProgram = glCreateProgram();
+			if (!cache.BinaryKey.empty())
+				glProgramParameteri(cache.LinkProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+			glAttachShader(cache.LinkProgram, cache.Sources.CS);
+			glLinkProgram(cache.LinkProgram);
+		}
 
-						m_shaders[i] = glCreateProgram();
-						glAttachShader(m_shaders[i], cs);
-						glLinkProgram(m_shaders[i]);
-					}
+		cache.Status = PassCache::State::Linking;
+	}
+	void RenderEngine::m_finishItem(PipelineItem* item, PassCache& cache)
+	{
+		GLchar cMsg[1024];
+		bool compiled = true;
 
-					if (m_shaders[i] != 0)
-						data->Variables.UpdateUniformInfo(m_shaders[i]);
+		auto checkStage = [&](GLuint shader, int stage, const char* path) {
+			if (shader == 0 || gl::CheckShaderCompilationStatus(shader, cMsg))
+				return;
 
-					m_shaderSources[i].VS = 0;
-					m_shaderSources[i].PS = 0;
-					m_shaderSources[i].GS = 0;
-				} 
-				else if (items[i]->Type == PipelineItem::ItemType::AudioPass) {
-					pipe::AudioPass *data = reinterpret_cast<ed::pipe::AudioPass *>(items[i]->Data);
+			compiled = false;
+			if (ShaderTranscompiler::GetShaderTypeFromExtension(path) == ShaderLanguage::GLSL)
+				m_msgs->Add(gl::ParseMessages(item->Name, stage, cMsg, cache.LineBias[stage]));
+		};
+
+		ShaderVariableContainer* vars = nullptr;
+		if (item->Type == PipelineItem::ItemType::ShaderPass) {
+			pipe::ShaderPass* data = reinterpret_cast<ed::pipe::ShaderPass*>(item->Data);
+			checkStage(cache.Sources.VS, 0, data->VSPath);
+			checkStage(cache.Sources.PS, 1, data->PSPath);
+			checkStage(cache.Sources.GS, 2, data->GSPath);
+			vars = &data->Variables;
+		}
+		else if (item->Type == PipelineItem::ItemType::ComputePass) {
+			pipe::ComputePass* data = reinterpret_cast<ed::pipe::ComputePass*>(item->Data);
+			checkStage(cache.Sources.CS, 3, data->Path);
+			vars = &data->Variables;
+		}
 
-					m_items.insert(m_items.begin() + i, items[i]);
-					m_shaders.insert(m_shaders.begin() + i, 0);
-					m_shaderSources.insert(m_shaderSources.begin() + i, ShaderPack());
+		m_deleteProgram(cache.Program);
+		m_deleteProgram(cache.DebugProgram);
 
-					/*
-						ITEM CACHING
-					*/
+		if (!compiled) {
+			m_msgs->Add(MessageStack::Type::Error, item->Name, item->Type == PipelineItem::ItemType::ComputePass ? "Failed to compile the compute shader" : "Failed to compile the shader");
 
-					m_msgs->CurrentItem = items[i]->Name;
-					std::string content = m_project->LoadProjectFile(data->Path);
+			m_deleteProgram(cache.LinkProgram);
+			m_deleteProgram(cache.LinkDebugProgram);
+			cache.Program = 0;
+			cache.DebugProgram = 0;
+		} else {
+			m_msgs->ClearGroup(item->Name);
 
-					// vertex shader
-					m_msgs->CurrentItemType = 1;
-					if (ShaderTranscompiler::GetShaderTypeFromExtension(data->Path) == ShaderLanguage::GLSL)
-						m_applyMacros(content, data);
-					data->Stream.compileFromShaderSource(m_project, m_msgs, content, data->Macros, ShaderTranscompiler::GetShaderTypeFromExtension(data->Path) == ShaderLanguage::HLSL);
-						
-					data->Variables.UpdateUniformInfo(data->Stream.getShader());
-				}
-				else if (items[i]->Type == PipelineItem::ItemType::PluginItem) {
-					pipe::PluginItemData *data = reinterpret_cast<pipe::PluginItemData*>(items[i]->Data);
+			cache.Program = cache.LinkProgram;
+			cache.DebugProgram = cache.LinkDebugProgram;
 
-					m_items.insert(m_items.begin() + i, items[i]);
-					m_shaders.insert(m_shaders.begin() + i, 0);
-					m_shaderSources.insert(m_shaderSources.begin() + i, ShaderPack());
-				}
+			if (!cache.FromBinary) {
+				ProgramBinaryCache::Instance().Save(cache.BinaryKey, cache.Program);
+				ProgramBinaryCache::Instance().Save(cache.DebugBinaryKey, cache.DebugProgram);
 			}
 		}
 
-		// check if some item was removed
-		for (int i = 0; i < m_items.size(); i++) {
-			bool found = false;
-			for (int j = 0; j < items.size(); j++)
-				if (items[j]->Data == m_items[i]->Data) {
-					found = true;
-					break;
-				}
+		m_programChanged(cache);
 
-			if (!found) {
-				glDeleteProgram(m_shaders[i]);
-				glDeleteProgram(m_debugShaders[i]);
+		if (cache.Program != 0 && vars != nullptr)
+			vars->UpdateUniformInfo(cache.Program);
 
-				Logger::Get().Log("Removing an item from cache");
+		cache.LinkProgram = cache.LinkDebugProgram = 0;
+		cache.FromBinary = false;
+		cache.Status = PassCache::State::Ready;
+	}
+	void RenderEngine::m_cancelCompile(PipelineItem* item, PassCache& cache)
+	{
+		m_uncached.erase(std::remove(m_uncached.begin(), m_uncached.end(), item), m_uncached.end());
 
-				if (m_items[i]->Type == PipelineItem::ItemType::ShaderPass)
-					m_fbos.erase((pipe::ShaderPass*)m_items[i]->Data);
-				
-				m_items.erase(m_items.begin() + i);
-				m_shaders.erase(m_shaders.begin() + i);
-				m_debugShaders.erase(m_debugShaders.begin() + i);
-				m_shaderSources.erase(m_shaderSources.begin() + i);
-			}
-		}
+		if (cache.Status == PassCache::State::Ready)
+			return;
 
-		// check if the order of the items changed
-		for (int i = 0; i < m_items.size(); i++) {
-			// two items at the same position dont match
-			if (items[i]->Data != m_items[i]->Data) {
-				// find the real position from original list
-				for (int j = 0; j < items.size(); j++) {
-					// we found the original position so move the item
-					if (items[j]->Data == m_items[i]->Data) {
-						Logger::Get().Log("Updating cached item " + std::string(items[j]->Name));
-
-						int dest = j > i ? (j - 1) : j;
-						m_items.erase(m_items.begin() + i, m_items.begin() + i + 1);
-						m_items.insert(m_items.begin() + dest, items[j]);
-
-						GLuint sCopy = m_shaders[i];
-						GLuint sdbgCopy = m_debugShaders[i];
-						ShaderPack ssrcCopy = m_shaderSources[i];
-						
-						m_shaders.erase(m_shaders.begin() + i);
-						m_shaders.insert(m_shaders.begin() + dest, sCopy);
+		// the workers might still be using the task -> just forget about it
+		for (int i = 0; i < 4; i++)
+			cache.Tasks[i] = nullptr;
 
-						m_debugShaders.erase(m_debugShaders.begin() + i);
-						m_debugShaders.insert(m_debugShaders.begin() + dest, sdbgCopy);
+		m_deleteProgram(cache.LinkProgram);
+		m_deleteProgram(cache.LinkDebugProgram);
+		cache.LinkProgram = cache.LinkDebugProgram = 0;
+		cache.FromBinary = false;
+		cache.Status = PassCache::State::Ready;
 
-						m_shaderSources.erase(m_shaderSources.begin() + i);
-						m_shaderSources.insert(m_shaderSources.begin() + dest, ssrcCopy);
-					}
-				}
-			}
+		auto pos = std::find(m_compiling.begin(), m_compiling.end(), item);
+		if (pos != m_compiling.end()) {
+			m_compiling.erase(pos);
+			m_compileTotal--;
 		}
 	}
 	bool RenderEngine::m_isGSUsedSet(GLuint rt)
 	{
 		bool ret = false;
-		for (int i = 0; i < m_items.size(); i++) {
-			if (m_items[i]->Type == PipelineItem::ItemType::ShaderPass) {
-				pipe::ShaderPass* pass = (pipe::ShaderPass*)m_items[i]->Data;
+		std::vector<PipelineItem*>& items = m_pipeline->GetList();
+		for (int i = 0; i < items.size(); i++) {
+			if (items[i]->Type == PipelineItem::ItemType::ShaderPass) {
+				pipe::ShaderPass* pass = (pipe::ShaderPass*)items[i]->Data;
 				for (int j = 0; j < pass->RTCount; j++)
 					if (pass->RenderTextures[j] == rt)
 						ret = pass->GSUsed;
@@ -1966,30 +2192,30 @@ namespace ed
 
 		return ret;
 	}
-	void RenderEngine::m_applyMacros(std::string  &src, pipe::ShaderPass *pass)
+	void RenderEngine::m_applyMacros(std::string& src, const std::vector<ShaderMacro>& macros, bool systemBuffer)
 	{
-		size_t verLoc = src.find_first_of("#version");
-		size_t lineLoc = src.find_first_of('\n', verLoc + 1) + 1;
-		std::string strMacro = "";
-
-		for (auto &macro : pass->Macros)
-		{
-			if (!macro.Active)
-				continue;
+		// insert the code and keep the line numbers in the error messages correct
+		auto insertCode = [&src](size_t loc, const std::string& code) {
+			int line = std::count(src.begin(), src.begin() + loc, '\n') + 1;
+			src.insert(loc, code + "#line " + std::to_string(line) + "\n");
+		};
+
+		size_t verLoc = src.find("#version");
+		size_t lineLoc = verLoc == std::string::npos ? 0 : src.find_first_of('\n', verLoc) + 1;
+
+		// declarations must come after the #extension directives
+		if (systemBuffer && Settings::Instance().Project.SystemUniformBuffer) {
+			size_t declLoc = lineLoc;
+			for (size_t extLoc = src.find("#extension", lineLoc); extLoc != std::string::npos; extLoc = src.find("#extension", extLoc + 1)) {
+				size_t extEnd = src.find_first_of('\n', extLoc);
+				declLoc = extEnd == std::string::npos ? src.size() : extEnd + 1;
+			}
 
-			strMacro += "#define " + std::string(macro.Name) + " " + std::string(macro.Value) + "\n";
+			insertCode(declLoc, SystemVariableManager::GetUniformBufferDeclaration(ShaderLanguage::GLSL) + "\n");
 		}
 
-		if (strMacro.size() > 0)
-			src.insert(lineLoc, strMacro);
-	}
-	void RenderEngine::m_applyMacros(std::string  &src, pipe::ComputePass *pass)
-	{
-		size_t verLoc = src.find_first_of("#version");
-		size_t lineLoc = src.find_first_of('\n', verLoc + 1) + 1;
 		std::string strMacro = "";
-
-		for (auto &macro : pass->Macros)
+		for (auto &macro : macros)
 		{
 			if (!macro.Active)
 				continue;
@@ -1998,26 +2224,9 @@ namespace ed
 		}
 
 		if (strMacro.size() > 0)
-			src.insert(lineLoc, strMacro);
+			insertCode(lineLoc, strMacro);
 	}
-	void RenderEngine::m_applyMacros(std::string  &src, pipe::AudioPass *pass)
-	{
-		size_t verLoc = src.find_first_of("#version");
-		size_t lineLoc = src.find_first_of('\n', verLoc + 1) + 1;
-		std::string strMacro = "";
-
-		for (auto &macro : pass->Macros)
-		{
-			if (!macro.Active)
-				continue;
-
-			strMacro += "#define " + std::string(macro.Name) + " " + std::string(macro.Value) + "\n";
-		}
-
-		if (strMacro.size() > 0)
-			src.insert(lineLoc, strMacro);
-	}
-	void RenderEngine::m_includeCheck(std::string &src, std::vector<std::string> includeStack, int& lineBias)
+	void RenderEngine::m_includeCheck(std::string &src, std::vector<std::string> includeStack, int& lineBias, std::vector<std::string>* includes)
 	{
 		size_t incLoc = src.find("#include");
 		Settings& settings = Settings::Instance();
@@ -2053,13 +2262,15 @@ namespace ed
 				if (std::count(includeStack.begin(), includeStack.end(), ipath) > 0)
 					m_msgs->Add(ed::MessageStack::Type::Error, m_msgs->CurrentItem, "Recursive #include detected");
 
-				if (m_project->FileExists(ipath) && std::count(includeStack.begin(), includeStack.end(), ipath) == 0) {
+				std::string incFileSrc;
+				if (std::count(includeStack.begin(), includeStack.end(), ipath) == 0 && IncludeCache::Instance().Get(m_project->GetProjectPath(ipath), incFileSrc)) {
 					includeStack.push_back(ipath);
+					if (includes != nullptr)
+						includes->push_back(m_project->GetProjectPath(ipath));
 
-					std::string incFileSrc = m_project->LoadProjectFile(ipath);
 					lineBias = std::count(incFileSrc.begin(), incFileSrc.end(), '\n');
 
-					m_includeCheck(incFileSrc, includeStack, lineBias);
+					m_includeCheck(incFileSrc, includeStack, lineBias, includes);
 
 					src.insert(incLoc, incFileSrc);
 
@@ -2070,22 +2281,22 @@ namespace ed
 			incLoc = src.find("#include", incLoc + 1);
 		}
 	}
-	void RenderEngine::m_updatePassFBO(ed::pipe::ShaderPass* pass)
+	void RenderEngine::m_updatePassFBO(ed::pipe::ShaderPass* pass, PassCache& cache)
 	{
 		bool changed = false;
 
 		for (int i = 0; i < pass->RTCount; i++)
-			if (pass->RenderTextures[i] != m_fbos[pass][i]) {
+			if (pass->RenderTextures[i] != cache.FBOs[i]) {
 				changed = true;
 				break;
 			}
 		for (int i = 0; i < pass->RTCount; i++)
-			m_fbos[pass][i] = pass->RenderTextures[i];
+			cache.FBOs[i] = pass->RenderTextures[i];
 
-		changed = changed || m_fboCount[pass] != pass->RTCount;
-		m_fboCount[pass] = pass->RTCount;
+		changed = changed || cache.FBOCount != pass->RTCount;
+		cache.FBOCount = pass->RTCount;
 
-		if (!changed && !m_fbosNeedUpdate)
+		if (!changed)
 			return;
 
 		GLuint lastID = pass->RenderTextures[pass->RTCount - 1];
@@ -2096,12 +2307,12 @@ namespace ed
 
 		if (pass->FBO != 0) {
 			glDeleteFramebuffers(1, &pass->FBO);
-			glDeleteFramebuffers(1, &m_fboMS[pass]);
+			glDeleteFramebuffers(1, &cache.FBOMS);
 		}
 
 		// normal FBO
 		glGenFramebuffers(1, &pass->FBO);
-		glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)pass->FBO);
+		GLState::Instance().BindFramebuffer(GL_FRAMEBUFFER, (GLuint)pass->FBO);
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthID, 0);
 		for (int i = 0; i < pass->RTCount; i++) {
 			GLuint texID = pass->RenderTextures[i];
@@ -2112,12 +2323,12 @@ namespace ed
 			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, texID, 0);
 		}
 		GLenum retval = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		GLState::Instance().BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 
 		// MSAA fbo
-		glGenFramebuffers(1, &m_fboMS[pass]);
-		glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)m_fboMS[pass]);
+		glGenFramebuffers(1, &cache.FBOMS);
+		GLState::Instance().BindFramebuffer(GL_FRAMEBUFFER, cache.FBOMS);
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D_MULTISAMPLE, depthMSID, 0);
 		for (int i = 0; i < pass->RTCount; i++) {
 			GLuint texID = pass->RenderTextures[i];
@@ -2131,8 +2342,139 @@ namespace ed
 			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D_MULTISAMPLE, texID, 0);
 		}
 		retval = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		GLState::Instance().BindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	bool RenderEngine::m_canSkipPass(PipelineItem* pass, PassCache& cache, const std::vector<GLuint>& srvs, const std::vector<GLuint>& ubos, int width, int height, bool isDebug)
+	{
+		pipe::ShaderPass* data = (pipe::ShaderPass*)pass->Data;
+
+		if (data->Cache == pipe::ShaderPass::CacheMode::Dynamic || isDebug || m_pickAwaiting)
+			return false;
+
+		// the window texture is cleared every frame
+		if (data->DepthTexture == m_rtDepth)
+			return false;
+
+		Hash state;
+		state.AddValue(cache.ProgramGeneration).AddValue(m_project->GetModifyCount());
+		state.AddValue(width).AddValue(height).AddValue(Settings::Instance().Preview.MSAA);
+		state.AddValue(SystemVariableManager::Instance().GetTile());
+		for (int i = 0; i < data->RTCount; i++) {
+			GLuint rt = data->RenderTextures[i];
+			if (rt == m_rtColor)
+				return false;
+
+			ed::RenderTextureObject* rtObject = m_objects->GetRenderTexture(rt);
+			state.AddValue(rt).AddValue(rtObject->CalculateSize(width, height)).AddValue(rtObject->Format);
+			state.AddValue(rtObject->Clear).AddValue(rtObject->ClearColor);
+		}
+
+		uint64_t inputs = 0;
+		if (data->Cache == pipe::ShaderPass::CacheMode::Auto && !m_hashPassInputs(data, srvs, ubos, inputs)) {
+			cache.ResultValid = false;
+			return false;
+		}
+
+		// something else has rendered to our render textures since we last did
+		bool outputsChanged = cache.OutputVersions.size() != data->RTCount;
+		for (int i = 0; i < data->RTCount && !outputsChanged; i++)
+			outputsChanged = m_textureVersions[data->RenderTextures[i]] != cache.OutputVersions[i];
+
+		bool skip = cache.ResultValid && !outputsChanged && cache.StateHash == state.Get();
+		if (data->Cache == pipe::ShaderPass::CacheMode::Auto)
+			skip = skip && cache.InputHash == inputs;
+
+		cache.StateHash = state.Get();
+		cache.InputHash = inputs;
+
+		return skip;
+	}
+	bool RenderEngine::m_hashPassInputs(pipe::ShaderPass* pass, const std::vector<GLuint>& srvs, const std::vector<GLuint>& ubos, uint64_t& hash)
+	{
+		// can't tell which members of the system uniform buffer the shader uses
+		if (Settings::Instance().Project.SystemUniformBuffer)
+			return false;
+
+		Hash ret;
+		ret.AddValue(m_pluginEpoch);
+
+		// uniforms (Time, FrameIndex, etc... will change the hash every frame)
+		std::vector<ShaderVariable*>& vars = pass->Variables.GetVariables();
+		for (ShaderVariable* var : vars) {
+			// per item values, covered by the items below
+			if (var->System == SystemShaderVariable::GeometryTransform || var->System == SystemShaderVariable::IsPicked)
+				continue;
+			// covered by the render texture sizes
+			if (var->System == SystemShaderVariable::ViewportSize)
+				continue;
+
+			FunctionVariableManager::AddToList(var);
+			ShaderVariableContainer::UpdateValue(var);
+
+			ret.Add(var->Data, ShaderVariable::GetSize(var->GetType()));
+		}
 
-		m_fbosNeedUpdate = false;
+		// items
+		auto& itemVarValues = GetItemVariableValues();
+		for (PipelineItem* item : pass->Items) {
+			if (item->Type == PipelineItem::ItemType::Geometry) {
+				pipe::GeometryItem* geo = (pipe::GeometryItem*)item->Data;
+				ret.AddValue(geo->Type).AddValue(geo->Position).AddValue(geo->Rotation).AddValue(geo->Scale);
+				ret.AddValue(geo->Size).AddValue(geo->Topology).AddValue(geo->Instanced).AddValue(geo->InstanceCount);
+				if (geo->InstanceBuffer != nullptr)
+					ret.AddValue(m_bufferVersions[((BufferObject*)geo->InstanceBuffer)->ID]);
+			}
+			else if (item->Type == PipelineItem::ItemType::Model) {
+				pipe::Model* obj = (pipe::Model*)item->Data;
+				ret.AddValue(obj->Data).AddValue(obj->Position).AddValue(obj->Rotation).AddValue(obj->Scale);
+				ret.AddValue(obj->Instanced).AddValue(obj->InstanceCount);
+				if (obj->InstanceBuffer != nullptr)
+					ret.AddValue(m_bufferVersions[((BufferObject*)obj->InstanceBuffer)->ID]);
+			}
+			else if (item->Type == PipelineItem::ItemType::RenderState)
+				ret.Add(item->Data, sizeof(pipe::RenderState));
+			else if (item->Type == PipelineItem::ItemType::PluginItem)
+				return false;
+
+			ret.AddValue(item).AddValue(IsPicked(item));
+			for (int k = 0; k < itemVarValues.size(); k++)
+				if (itemVarValues[k].Item == item)
+					ret.Add(itemVarValues[k].NewValue->Data, ShaderVariable::GetSize(itemVarValues[k].NewValue->GetType()));
+		}
+
+		// bound textures and buffers
+		for (GLuint srv : srvs) {
+			if (m_objects->IsPluginObject(srv) || m_objects->GetObjectTypeByTextureID(srv) == ObjectType::Audio)
+				return false;
+
+			ret.AddValue(srv).AddValue(m_textureVersions[srv]);
+		}
+		for (GLuint ubo : ubos)
+			ret.AddValue(ubo).AddValue(m_bufferVersions[ubo]);
+
+		hash = ret.Get();
+		return true;
+	}
+	void RenderEngine::m_storePassResult(pipe::ShaderPass* pass, PassCache& cache, bool isDebug)
+	{
+		m_touchPassOutputs(pass);
+
+		cache.OutputVersions.resize(pass->RTCount);
+		for (int i = 0; i < pass->RTCount; i++)
+			cache.OutputVersions[i] = m_textureVersions[pass->RenderTextures[i]];
+
+		// pixel picking renders debug colors to the render textures
+		cache.ResultValid = !isDebug;
+	}
+	void RenderEngine::m_programChanged(PassCache& cache)
+	{
+		cache.ProgramGeneration = ++m_programGeneration;
+		cache.ResultValid = false;
+	}
+	void RenderEngine::m_touchPassOutputs(pipe::ShaderPass* pass)
+	{
+		for (int i = 0; i < pass->RTCount; i++)
+			m_textureVersions[pass->RenderTextures[i]]++;
 	}
 }
\ No newline at end of file
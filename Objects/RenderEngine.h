@@ -4,6 +4,8 @@
 #include "ProjectParser.h"
 #include "MessageStack.h"
 #include "PluginAPI/PluginManager.h"
+#include "Profiler.h"
+#include "TranscompilerPool.h"
 #include "../Engine/Timer.h"
 
 #include <unordered_map>
@@ -20,6 +22,10 @@
 	#include <GL/gl.h>
 #endif
 
+// batched geometry items get their GeometryTransform in (mat4) locations 11-14 and IsPicked (float) in location 15
+#define BATCH_ATTRIBUTE_LOCATION 11
+#define BATCH_ELEMENT_SIZE 17
+
 namespace ed
 {
 	class ObjectManager;
@@ -43,6 +49,17 @@ namespace ed
 		inline bool IsPicked(PipelineItem* item) { return std::count(m_pick.begin(), m_pick.end(), item); }
 
 		void FlushCache();
+
+		// called by the PipelineManager when a pipeline item is added/removed
+		void AddItemCache(PipelineItem* item);
+		void RemoveItemCache(PipelineItem* item);
+
+		// newly added items are compiled in the background
+		inline bool IsCompiling() { return m_compiling.size() > 0 || m_uncached.size() > 0; }
+		inline int GetCompiledCount() { return m_compileDone; }
+		inline int GetCompileCount() { return m_compileTotal + (int)m_uncached.size(); }
+		void WaitForCompilation();
+		inline void StopCompiling() { m_transcompiler.Stop(); } // joins the transcompiler threads, they use the ProjectParser
 		void AddPickedItem(PipelineItem* pipe, bool multiPick = false);
 
 		std::pair<PipelineItem*, PipelineItem*> GetPipelineItemByID(int id); // get pipeline item by it's debug id
@@ -57,6 +74,13 @@ namespace ed
 		inline bool IsPaused() { return m_paused; }
 		void Pause(bool pause);
 
+		inline Profiler& GetProfiler() { return m_profiler; }
+
+		// number of shader passes that reused their render textures in the last frame (pipe::ShaderPass::Cache)
+		inline int GetLastSkippedPassCount() { return m_lastSkippedPasses; }
+		inline void TouchTexture(GLuint tex) { m_textureVersions[tex]++; } // contents changed outside of the pipeline
+		inline void TouchBuffer(GLuint buf) { m_bufferVersions[buf]++; }
+
 	public:
 		struct ItemVariableValue
 		{
@@ -104,18 +128,21 @@ namespace ed
 		// paused time?
 		bool m_paused;
 
+		// per pipeline item CPU/GPU timings
+		Profiler m_profiler;
+
 		/* 'window' FBO */
 		glm::ivec2 m_lastSize;
 		GLuint m_rtColor, m_rtDepth, m_rtColorMS, m_rtDepthMS;
-		bool m_fbosNeedUpdate;
 
-		// check for the #include's & change the source code accordingly (includeStack == prevent recursion)
-		void m_includeCheck(std::string& src, std::vector<std::string> includeStack, int& lineBias);
+		// check for the #include's & change the source code accordingly (includeStack == prevent recursion, includes -> paths of the included files)
+		void m_includeCheck(std::string& src, std::vector<std::string> includeStack, int& lineBias, std::vector<std::string>* includes = nullptr);
 
-		// apply macros to GLSL source code
-		void m_applyMacros(std::string& source, pipe::ShaderPass* pass);
-		void m_applyMacros(std::string& source, pipe::ComputePass* pass);
-		void m_applyMacros(std::string& source, pipe::AudioPass* pass); // TODO: merge this function with the ones above
+		// apply macros (and the system uniform buffer declaration if enabled) to GLSL source code
+		void m_applyMacros(std::string& source, const std::vector<ShaderMacro>& macros, bool systemBuffer = true);
+		inline void m_applyMacros(std::string& source, pipe::ShaderPass* pass) { m_applyMacros(source, pass->Macros); }
+		inline void m_applyMacros(std::string& source, pipe::ComputePass* pass) { m_applyMacros(source, pass->Macros); }
+		inline void m_applyMacros(std::string& source, pipe::AudioPass* pass) { m_applyMacros(source, pass->Macros, false); }
 		
 		// does a shader pass with GSUsed set also use this texture
 		bool m_isGSUsedSet(GLuint rt);
@@ -130,23 +157,92 @@ namespace ed
 		bool m_wasMultiPick;
 		void m_pickItem(PipelineItem* item, bool multiPick);
 
+		/* batching (pipe::ShaderPass::Batching) */
+		GLuint m_batchVBO;
+		std::vector<GLfloat> m_batchData; // BATCH_ELEMENT_SIZE floats per item
+		int m_batchCount;
+		bool m_canBatch(PipelineItem* first, PipelineItem* item, const std::vector<ItemVariableValue>& itemValues);
+		void m_addToBatch(PipelineItem* item, bool picked); // uses the GeometryTransform set in SystemVariableManager
+		void m_drawBatch(pipe::GeometryItem* geo);
+		void m_setItemAttributes(PipelineItem* item, bool picked, bool disableArrays); // same attributes for the items that aren't batched (instanced geometry, models)
+
 		// cache
-		std::vector<PipelineItem*> m_items;
-		std::vector<GLuint> m_shaders;
-		std::vector<GLuint> m_debugShaders;
-		std::map<pipe::ShaderPass*, std::vector<GLuint>> m_fbos;
-		std::map<pipe::ShaderPass*, GLuint> m_fboMS; // multisampled fbo's
-		std::map<pipe::ShaderPass*, GLuint> m_fboCount;
-		struct ShaderPack {ShaderPack() {VS=GS=PS=0;} GLuint VS, PS, GS;};
-		std::vector<ShaderPack> m_shaderSources;
+		struct ShaderPack {ShaderPack() {VS=GS=PS=CS=0;} GLuint VS, PS, GS, CS;};
+		struct PassCache
+		{
+			enum class State
+			{
+				Ready,
+				Transcompiling,	// waiting for the TranscompilerPool
+				Linking			// waiting for the driver
+			};
+
+			PassCache() {
+				Program = DebugProgram = 0; FBOMS = 0; FBOCount = 0; memset(FBOs, 0, sizeof(FBOs));
+				Status = State::Ready; LinkProgram = LinkDebugProgram = 0; memset(LineBias, 0, sizeof(LineBias));
+				FromBinary = false;
+				ResultValid = false; StateHash = InputHash = 0; ProgramGeneration = 0;
+			}
+			GLuint Program;
+			GLuint DebugProgram; // pass' VS + pixel picking PS
+			ShaderPack Sources;
+			GLuint FBOs[MAX_RENDER_TEXTURES]; // render textures that the pass' FBOs were created with
+			GLuint FBOCount;
+			GLuint FBOMS; // multisampled fbo
+
+			// background compilation
+			State Status;
+			std::shared_ptr<TranscompilerPool::Task> Tasks[4]; // VS, PS, GS, CS - only for HLSL and Vulkan GLSL
+			int LineBias[4];
+			GLuint LinkProgram, LinkDebugProgram; // moved to Program & DebugProgram once they are linked
+
+			// ProgramBinaryCache
+			std::string BinaryKey, DebugBinaryKey;
+			bool FromBinary; // Link(Debug)Program were loaded from the disk -> nothing to compile
+
+			// result caching
+			bool ResultValid; // render textures still hold the output of the last render
+			uint64_t StateHash; // program generation, render texture sizes & formats, project modifications
+			unsigned int ProgramGeneration; // GL reuses the names of deleted programs -> this is hashed instead
+			uint64_t InputHash; // uniforms, items, bound textures & buffers (CacheMode::Auto)
+			std::vector<unsigned int> OutputVersions; // m_textureVersions of the render textures after the last render
+		};
+		std::unordered_map<PipelineItem*, PassCache> m_passes;
+		std::vector<PipelineItem*> m_uncached; // added since the last frame
+		std::vector<PipelineItem*> m_compiling;
+		int m_compileDone, m_compileTotal;
+
+		TranscompilerPool m_transcompiler;
+		bool m_parallelCompile; // GL_KHR_parallel_shader_compile
 
 		GLuint m_debugPixelShader, m_debugVertexPickShader, m_debugInstancePickShader;
 
-		void m_updatePassFBO(ed::pipe::ShaderPass* pass);
+		void m_updatePassFBO(ed::pipe::ShaderPass* pass, PassCache& cache);
+
+		/* result caching (pipe::ShaderPass::Cache) */
+		std::unordered_map<GLuint, unsigned int> m_textureVersions; // increased every time something renders to/writes the texture
+		std::unordered_map<GLuint, unsigned int> m_bufferVersions;
+		unsigned int m_pluginEpoch; // increased every time a plugin pipeline item is executed
+		unsigned int m_programGeneration;
+		void m_programChanged(PassCache& cache); // call after Program was replaced
+		int m_skippedPasses, m_lastSkippedPasses;
+		bool m_canSkipPass(PipelineItem* pass, PassCache& cache, const std::vector<GLuint>& srvs, const std::vector<GLuint>& ubos, int width, int height, bool isDebug); // also stores the new hashes in the cache
+		bool m_hashPassInputs(pipe::ShaderPass* pass, const std::vector<GLuint>& srvs, const std::vector<GLuint>& ubos, uint64_t& hash); // false if the pass depends on something that can't be tracked
+		void m_storePassResult(pipe::ShaderPass* pass, PassCache& cache, bool isDebug);
+		void m_touchPassOutputs(pipe::ShaderPass* pass); // render textures were written to outside of Render()
 
 		std::vector<ItemVariableValue> m_itemValues; // list of all values to apply once we start rendering 
 
-		eng::Timer m_cacheTimer;
-		void m_cache();
+		PassCache& m_getCache(PipelineItem* item);
+		void m_cache(); // start compiling the newly added items & check on the ones being compiled
+		void m_cacheItem(PipelineItem* item, PassCache& cache, bool async);
+		void m_compileItem(PipelineItem* item, PassCache& cache); // GL compile & link
+		void m_finishItem(PipelineItem* item, PassCache& cache); // check the status
+		void m_cancelCompile(PipelineItem* item, PassCache& cache);
+		void m_transcompile(PassCache& cache, PipelineItem* item, int stage, const char* path, const char* entry, const std::vector<ShaderMacro>& macros, bool gsUsed, bool async);
+		std::string m_getStageSource(PassCache& cache, int stage, const char* path, const std::vector<ShaderMacro>& macros, std::vector<std::string>& includes);
+		void m_freeCache(PassCache& cache);
+		void m_deleteProgram(GLuint program); // also forgets the shadowed GL/uniform state of the program
+		void m_clearCache();
 	};
 }
\ No newline at end of file
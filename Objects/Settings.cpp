@@ -28,6 +28,10 @@ namespace ed
 		General.AutoScale = true;
 		General.Log = true;
 		General.PipeLogsToTerminal = false;
+		General.ProgramCache = true;
+		General.ProgramCacheSize = 128;
+		General.MeshCache = true;
+		General.MeshCacheSize = 1024;
 		DPIScale = 1.0f;
 		strcpy(General.Font, "null");
 		General.FontSize = 15;
@@ -65,7 +69,11 @@ namespace ed
 		Preview.FPSLimit = -1;
 		Preview.ApplyFPSLimitToApp = false;
 		Preview.LostFocusLimitFPS = false;
+		Preview.DynamicResolution = false;
+		Preview.TargetFPS = 30;
 		Preview.MSAA = 1;
+
+		Project.SystemUniformBuffer = false;
 	}
 	void Settings::Load()
 	{
@@ -95,6 +103,10 @@ namespace ed
 		General.AutoRecompile = ini.GetBoolean("general", "autorecompile", false);
 		General.StartUpTemplate = ini.Get("general", "template", "GLSL");
 		General.AutoScale = ini.GetBoolean("general", "autoscale", true);
+		General.ProgramCache = ini.GetBoolean("general", "programcache", true);
+		General.ProgramCacheSize = std::max<int>(ini.GetInteger("general", "programcachesize", 128), 1);
+		General.MeshCache = ini.GetBoolean("general", "meshcache", true);
+		General.MeshCacheSize = std::max<int>(ini.GetInteger("general", "meshcachesize", 1024), 1);
 		DPIScale = ini.GetReal("general", "uiscale", 1.0f);
 		strcpy(General.Font, ini.Get("general", "font", "data/NotoSans.ttf").c_str());
 		General.FontSize = ini.GetInteger("general", "fontsize", 18);
@@ -132,6 +144,8 @@ namespace ed
 		Preview.FPSLimit = ini.GetInteger("preview", "fpslimit", -1);
 		Preview.ApplyFPSLimitToApp = ini.GetBoolean("preview", "fpslimitwholeapp", false);
 		Preview.LostFocusLimitFPS = ini.GetBoolean("preview", "fpslimitlostfocus", false);
+		Preview.DynamicResolution = ini.GetBoolean("preview", "dynamicres", false);
+		Preview.TargetFPS = ini.GetInteger("preview", "targetfps", 30);
 		Preview.MSAA = ini.GetInteger("preview", "msaa", 1);
 
 		m_parseExt(ini.Get("plugins", "notloaded", ""), Plugins.NotLoaded);
@@ -170,6 +184,10 @@ namespace ed
 		ini << "font=" << General.Font << std::endl;
 		ini << "fontsize=" << General.FontSize << std::endl;
 		ini << "autoscale=" << General.AutoScale << std::endl;
+		ini << "programcache=" << General.ProgramCache << std::endl;
+		ini << "programcachesize=" << General.ProgramCacheSize << std::endl;
+		ini << "meshcache=" << General.MeshCache << std::endl;
+		ini << "meshcachesize=" << General.MeshCacheSize << std::endl;
 		ini << "uiscale=" << DPIScale << std::endl;
 		
 		ini << "hlslext=";
@@ -203,6 +221,8 @@ namespace ed
 		ini << "fpslimit=" << Preview.FPSLimit << std::endl;
 		ini << "fpslimitwholeapp=" << Preview.ApplyFPSLimitToApp << std::endl;
 		ini << "fpslimitlostfocus=" << Preview.LostFocusLimitFPS << std::endl;
+		ini << "dynamicres=" << Preview.DynamicResolution << std::endl;
+		ini << "targetfps=" << Preview.TargetFPS << std::endl;
 		ini << "msaa=" << Preview.MSAA << std::endl;
 
 		ini << "[editor]" << std::endl;
@@ -38,6 +38,10 @@ namespace ed
 			char Font[MAX_PATH];
 			int FontSize;
 			bool AutoScale;
+			bool ProgramCache;
+			int ProgramCacheSize; // MB
+			bool MeshCache;
+			int MeshCacheSize; // MB
 			std::vector<std::string> HLSLExtensions;
 			std::vector<std::string> VulkanGLSLExtensions;
 		} General;
@@ -77,12 +81,15 @@ namespace ed
 			int FPSLimit;
 			bool ApplyFPSLimitToApp; // apply FPSLimit to whole app, not only preview
 			bool LostFocusLimitFPS; // limit to 30FPS when app loses focus
+			bool DynamicResolution; // lower the preview render size while the pipeline takes longer than 1/TargetFPS on the GPU
+			int TargetFPS;
 			int MSAA; // 1 (off), 2, 4, 8
 		} Preview;
 
 		struct strProject {
 			bool FPCamera;
 			bool UseAlphaChannel;
+			bool SystemUniformBuffer; // store system variables in one uniform buffer
 			glm::vec4 ClearColor;
 			std::vector<std::string> IncludePaths;
 		} Project;
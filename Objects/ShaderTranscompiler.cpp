@@ -7,6 +7,10 @@
 #include "Logger.h"
 #include "Settings.h"
 #include "HLSLFileIncluder.h"
+#include "TranscompileCache.h"
+#include "FileCache.h"
+#include "Hash.h"
+#include "SystemVariableManager.h"
 #include "ShaderTranscompiler.h"
 #include <glslang/glslang/Public/ShaderLang.h>
 #include <glslang/SPIRV/GlslangToSpv.h>
@@ -126,31 +130,75 @@ const TBuiltInResource DefaultTBuiltInResource = {
 
 namespace ed
 {
-	std::string ShaderTranscompiler::Transcompile(ShaderLanguage inLang, const std::string &filename, int sType, const std::string &entry, std::vector<ShaderMacro> &macros, bool gsUsed, MessageStack *msgs, ProjectParser* project)
+	std::string ShaderTranscompiler::Transcompile(ShaderLanguage inLang, const std::string &filename, int sType, const std::string &entry, std::vector<ShaderMacro> &macros, bool gsUsed, MessageStack *msgs, ProjectParser* project, std::vector<std::string>* includes)
 	{
 		ed::Logger::Get().Log("Starting to transcompile a HLSL shader " + filename);
 
 		//Load HLSL into a string
-		std::ifstream file(filename);
-
-		if (!file.is_open())
+		std::string inputHLSL;
+		if (!FileCache::Instance().Get(filename, inputHLSL))
 		{
 			if (msgs != nullptr)
 				msgs->Add(MessageStack::Type::Error, msgs->CurrentItem, "Failed to open file " + filename, -1, sType);
-			file.close();
 			return "errorFile";
 		}
 
-		std::string inputHLSL((std::istreambuf_iterator<char>(file)),
-							std::istreambuf_iterator<char>());
-
-		file.close();
-
-		return ShaderTranscompiler::TranscompileSource(inLang, filename, inputHLSL, sType, entry, macros, gsUsed, msgs, project);
+		return ShaderTranscompiler::TranscompileSource(inLang, filename, inputHLSL, sType, entry, macros, gsUsed, msgs, project, includes);
 	}
-	std::string ShaderTranscompiler::TranscompileSource(ShaderLanguage inLang, const std::string &filename, const std::string &inputHLSL, int sType, const std::string &entry, std::vector<ShaderMacro> &macros, bool gsUsed, MessageStack *msgs, ProjectParser* project)
+	std::string ShaderTranscompiler::TranscompileSource(ShaderLanguage inLang, const std::string &filename, const std::string &inputHLSL, int sType, const std::string &entry, std::vector<ShaderMacro> &macros, bool gsUsed, MessageStack *msgs, ProjectParser* project, std::vector<std::string>* includes)
 	{
-		const char* inputStr = inputHLSL.c_str();
+		bool systemBuffer = Settings::Instance().Project.SystemUniformBuffer;
+
+		// include directories
+		std::vector<std::string> includeDirs;
+		includeDirs.push_back(filename.substr(0, filename.find_last_of("/\\")));
+		if (project != nullptr)
+			for (auto& str : Settings::Instance().Project.IncludePaths)
+				includeDirs.push_back(project->GetProjectPath(str));
+
+		// skip glslang & SPIRV-Cross if nothing has changed - the included files are checked by the cache
+		Hash keyHash;
+		keyHash.AddValue((int)inLang).AddValue(sType).AddValue(gsUsed).AddValue(systemBuffer).Add(entry).Add(inputHLSL);
+		for (auto& macro : macros) {
+			if (!macro.Active)
+				continue;
+			keyHash.Add(std::string(macro.Name)).Add(std::string(macro.Value));
+		}
+		for (auto& dir : includeDirs)
+			keyHash.Add(dir);
+		std::string cacheKey = keyHash.ToString();
+
+		std::string cachedSource;
+		if (TranscompileCache::Instance().Get(cacheKey, cachedSource, includes)) {
+			ed::Logger::Get().Log("Using the cached transcompiled shader " + filename);
+			return cachedSource;
+		}
+
+		// system uniform buffer: declare the sed* variables so that the user can use them
+		std::string inputSource = inputHLSL;
+		if (systemBuffer) {
+			std::string decl = SystemVariableManager::GetUniformBufferDeclaration(inLang) + "\n";
+			if (inLang == ShaderLanguage::HLSL)
+				inputSource.insert(0, decl + "#line 1\n");
+			else {
+				// after #version and #extension directives
+				auto lineEnd = [&inputSource](size_t loc) {
+					size_t nl = inputSource.find_first_of('\n', loc);
+					return nl == std::string::npos ? inputSource.size() : nl + 1;
+				};
+				size_t declLoc = 0;
+				size_t verLoc = inputSource.find("#version");
+				if (verLoc != std::string::npos)
+					declLoc = lineEnd(verLoc);
+				for (size_t extLoc = inputSource.find("#extension", declLoc); extLoc != std::string::npos; extLoc = inputSource.find("#extension", extLoc + 1))
+					declLoc = lineEnd(extLoc);
+
+				int line = std::count(inputSource.begin(), inputSource.begin() + declLoc, '\n') + 1;
+				inputSource.insert(declLoc, decl + "#line " + std::to_string(line) + "\n");
+			}
+		}
+
+		const char* inputStr = inputSource.c_str();
 
 		// create shader
 		EShLanguage shaderType = EShLangVertex;
@@ -194,14 +242,19 @@ namespace ed
 
 		// includer
 		ed::HLSLFileIncluder includer;
-		includer.pushExternalLocalDirectory(filename.substr(0, filename.find_last_of("/\\")));
-		if (project != nullptr)
-			for (auto& str : Settings::Instance().Project.IncludePaths)
-				includer.pushExternalLocalDirectory(project->GetProjectPath(str));
+		for (auto& dir : includeDirs)
+			includer.pushExternalLocalDirectory(dir);
 
 		std::string processedShader;
 
-		if (!shader.preprocess(&res, defVersion, ENoProfile, false, false, messages, &processedShader, includer))
+		bool preprocessed = shader.preprocess(&res, defVersion, ENoProfile, false, false, messages, &processedShader, includer);
+
+		// report the includes even if the compilation fails so that fixing the header triggers a recompile
+		if (includes != nullptr)
+			for (const auto& inc : includer.getIncludedFiles())
+				includes->push_back(inc);
+
+		if (!preprocessed)
 		{
 			if (msgs != nullptr) {
 				msgs->Add(gl::ParseHLSLMessages(msgs->CurrentItem, sType, shader.getInfoLog()));
@@ -439,7 +492,32 @@ namespace ed
 			}
 		}
 
+		// the members were turned into separate uniforms above -> replace them with the actual uniform block
+		if (systemBuffer) {
+			std::stringstream ss(source);
+			std::string line;
+			source = "";
+			bool declared = false;
+			while (std::getline(ss, line)) {
+				if (line.size() > 0 && line[line.size() - 1] == ';' && line.find("uniform ") == 0) {
+					std::string name = line.substr(line.find_last_of(' ') + 1);
+					name = name.substr(0, name.size() - 1);
+					if (SystemVariableManager::IsUniformBufferMember(name))
+						continue;
+				}
+
+				if (!declared && (line.size() == 0 || line[0] != '#')) {
+					source += SystemVariableManager::GetUniformBufferDeclaration(ShaderLanguage::GLSL) + "\n";
+					declared = true;
+				}
+
+				source += line + "\n";
+			}
+		}
+
 		ed::Logger::Get().Log("Finished transcompiling the shader");
+
+		TranscompileCache::Instance().Store(cacheKey, source, includer.getIncludedFiles());
 		
 		return source;
 	}
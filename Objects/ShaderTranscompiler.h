@@ -11,8 +11,8 @@ namespace ed
 	{
 	public:
 		/* TODO: enum for shaderType = { 0 -> vertex, 1 -> pixel, 2 -> geometry } */
-		static std::string Transcompile(ShaderLanguage inLang, const std::string &filename, int shaderType, const std::string &entry, std::vector<ShaderMacro> &macros, bool gsUsed, MessageStack *msgs, ProjectParser* project);
-		static std::string TranscompileSource(ShaderLanguage inLang, const std::string &filename, const std::string &source, int shaderType, const std::string &entry, std::vector<ShaderMacro> &macros, bool gsUsed, MessageStack *msgs, ProjectParser* project);
+		static std::string Transcompile(ShaderLanguage inLang, const std::string &filename, int shaderType, const std::string &entry, std::vector<ShaderMacro> &macros, bool gsUsed, MessageStack *msgs, ProjectParser* project, std::vector<std::string>* includes = nullptr);
+		static std::string TranscompileSource(ShaderLanguage inLang, const std::string &filename, const std::string &source, int shaderType, const std::string &entry, std::vector<ShaderMacro> &macros, bool gsUsed, MessageStack *msgs, ProjectParser* project, std::vector<std::string>* includes = nullptr); // includes -> paths of the #include'd files
 		static ShaderLanguage GetShaderTypeFromExtension(const std::string& file);
 	};
 }
\ No newline at end of file
@@ -110,6 +110,7 @@ namespace ed
 			memcpy(Name, name, strlen(name));
 			Function = FunctionShaderVariable::None;
 			Flags = 0;
+			UpdateVersion = 0;
 		}
 
 		static inline int GetSize(ValueType type)
@@ -143,6 +144,7 @@ namespace ed
 		char* Data;			// allocated with malloc()
 		char* Arguments;	// space to store arguments for function - allocated if not null!!!
 		char Flags;
+		unsigned int UpdateVersion; // SystemVariableManager::GetStateVersion() when Data was last computed, 0 -> never
 		PluginSystemVariableData PluginSystemVarData;
 		PluginFunctionData PluginFuncData;
 
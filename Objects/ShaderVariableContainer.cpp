@@ -6,9 +6,18 @@
 
 namespace ed
 {
-	ShaderVariableContainer::ShaderVariableContainer() { }
+	int ShaderVariableContainer::m_uploadCount = 0;
+	int ShaderVariableContainer::m_skippedCount = 0;
+	int ShaderVariableContainer::m_lastUploadCount = 0;
+	int ShaderVariableContainer::m_lastSkippedCount = 0;
+
+	ShaderVariableContainer::ShaderVariableContainer() : m_program(0)
+	{
+		m_getContainers().insert(this);
+	}
 	ShaderVariableContainer::~ShaderVariableContainer()
 	{
+		m_getContainers().erase(this);
 		for (int i = 0; i < m_vars.size(); i++) {
 			free(m_vars[i]->Data);
 			if (m_vars[i]->Arguments != nullptr)
@@ -44,6 +53,13 @@ namespace ed
 		GLsizei length; // name length
 		GLuint samplerLoc = 0;
 
+		// the engine never relinks a program in place, it links a new one and deletes the old one (ForgetProgram)
+		// -> an existing entry belongs to the same link, keep its locations and the values it already has
+		m_program = pass;
+		if (m_programs.count(pass) > 0)
+			return;
+		ProgramCache& cache = m_programs[pass];
+
 		glGetProgramiv(pass, GL_ACTIVE_UNIFORMS, &count);
 		for (GLuint i = 0; i < count; i++)
 		{
@@ -55,7 +71,23 @@ namespace ed
 			if (type == GL_SAMPLER_2D)
 				glUniform1i(glGetUniformLocation(pass, name), samplerLoc++);
 			else
-				m_uLocs[name] = glGetUniformLocation(pass, name);
+				cache.Locations[name] = glGetUniformLocation(pass, name);
+		}
+
+		// GLSL 330 has no layout(binding) for uniform blocks
+		GLuint sysBlock = glGetUniformBlockIndex(pass, SYSTEM_UNIFORM_BUFFER_NAME);
+		if (sysBlock != GL_INVALID_INDEX)
+			glUniformBlockBinding(pass, sysBlock, SYSTEM_UNIFORM_BUFFER_BINDING);
+
+		// resolve the locations now so that Bind() doesn't have to look them up by name
+		cache.Slots.resize(m_vars.size());
+		for (int i = 0; i < m_vars.size(); i++) {
+			UniformSlot& slot = cache.Slots[i];
+			slot.Variable = m_vars[i];
+			slot.Name = m_vars[i]->Name;
+
+			auto loc = cache.Locations.find(slot.Name);
+			slot.Location = loc == cache.Locations.end() ? -1 : loc->second;
 		}
 	}
 	void ShaderVariableContainer::UpdateTextureList(const std::string& fragShader)
@@ -86,37 +118,103 @@ namespace ed
 
 		glUniform1i(glGetUniformLocation(pass, m_samplers[unit].c_str()), unit);
 	}
+	void ShaderVariableContainer::ResetUploadStats()
+	{
+		m_lastUploadCount = m_uploadCount;
+		m_lastSkippedCount = m_skippedCount;
+		m_uploadCount = m_skippedCount = 0;
+	}
+	void ShaderVariableContainer::ForgetProgram(GLuint program)
+	{
+		for (ShaderVariableContainer* cont : m_getContainers()) {
+			cont->m_programs.erase(program);
+			if (cont->m_program == program)
+				cont->m_program = 0;
+		}
+	}
+	void ShaderVariableContainer::UpdateValue(ShaderVariable* var, void* item)
+	{
+		bool computed = var->System != SystemShaderVariable::None || var->Function != FunctionShaderVariable::None;
+
+		// per item values, plugin values and pointers to other variables can change between two draws
+		bool perDraw = var->System == SystemShaderVariable::GeometryTransform || var->System == SystemShaderVariable::IsPicked ||
+			var->System == SystemShaderVariable::PluginVariable || var->Function == FunctionShaderVariable::Pointer ||
+			var->Function == FunctionShaderVariable::PluginFunction;
+
+		// everything else only changes with the frame state
+		unsigned int version = SystemVariableManager::Instance().GetStateVersion();
+		if (computed && !perDraw && var->UpdateVersion == version)
+			return;
+
+		SystemVariableManager::Instance().Update(var, item);
+		FunctionVariableManager::Update(var);
+		if (computed)
+			m_applyFlags(var);
+		var->UpdateVersion = version;
+	}
+	void ShaderVariableContainer::m_applyFlags(ShaderVariable* var)
+	{
+		ShaderVariable::ValueType type = var->GetType();
+		if (var->Flags & (char)ShaderVariable::Flag::Inverse) {
+			if (type == ShaderVariable::ValueType::Float4x4) {
+				glm::mat4x4 matVal = glm::make_mat4x4(var->AsFloatPtr());
+				memcpy(var->Data, glm::value_ptr(glm::inverse(matVal)), sizeof(glm::mat4x4));
+			} else if (type == ShaderVariable::ValueType::Float3x3) {
+				glm::mat3x3 matVal = glm::make_mat3x3(var->AsFloatPtr());
+				memcpy(var->Data, glm::value_ptr(glm::inverse(matVal)), sizeof(glm::mat3x3));
+			} else if (type == ShaderVariable::ValueType::Float2x2) {
+				glm::mat2x2 matVal = glm::make_mat2x2(var->AsFloatPtr());
+				memcpy(var->Data, glm::value_ptr(glm::inverse(matVal)), sizeof(glm::mat2x2));
+			}
+		}
+	}
 	void ShaderVariableContainer::Bind(void* item)
 	{
+		auto cacheIt = m_programs.find(m_program);
+		if (cacheIt == m_programs.end()) {
+			for (int i = 0; i < m_vars.size(); i++)
+				FunctionVariableManager::AddToList(m_vars[i]);
+			return;
+		}
+
+		ProgramCache& cache = cacheIt->second;
+		if (cache.Slots.size() != m_vars.size())
+			cache.Slots.resize(m_vars.size());
+
 		for (int i = 0; i < m_vars.size(); i++) {
 			FunctionVariableManager::AddToList(m_vars[i]);
+
+			// variable was added, removed, moved or renamed since the last bind
+			UniformSlot& slot = cache.Slots[i];
+			if (slot.Variable != m_vars[i] || strcmp(slot.Name.c_str(), m_vars[i]->Name) != 0) {
+				slot.Variable = m_vars[i];
+				slot.Name = m_vars[i]->Name;
+				slot.Shadow.clear();
+
+				auto loc = cache.Locations.find(slot.Name);
+				slot.Location = loc == cache.Locations.end() ? -1 : loc->second;
+			}
 			
-			if (m_uLocs.count(m_vars[i]->Name) == 0)
+			if (slot.Location == -1)
 				continue;
 			
-			GLint loc = m_uLocs[m_vars[i]->Name];
+			GLint loc = slot.Location;
 
 			// update values if needed
-			SystemVariableManager::Instance().Update(m_vars[i], item);
-			FunctionVariableManager::Update(m_vars[i]);
+			UpdateValue(m_vars[i], item);
+			if (m_vars[i]->System == SystemShaderVariable::None && m_vars[i]->Function == FunctionShaderVariable::None)
+				m_applyFlags(m_vars[i]); // user values aren't recomputed
 
-			// update uniform every time we bind this container
-			// TODO: maybe we shouldn't update variables that havent changed
 			ShaderVariable::ValueType type = m_vars[i]->GetType();
 
-			// check the flags
-			if (m_vars[i]->Flags & (char)ShaderVariable::Flag::Inverse) {
-				if (type == ShaderVariable::ValueType::Float4x4) {
-					glm::mat4x4 matVal = glm::make_mat4x4(m_vars[i]->AsFloatPtr());
-					memcpy(m_vars[i]->Data, glm::value_ptr(glm::inverse(matVal)), sizeof(glm::mat4x4));
-				} else if (type == ShaderVariable::ValueType::Float3x3) {
-					glm::mat3x3 matVal = glm::make_mat3x3(m_vars[i]->AsFloatPtr());
-					memcpy(m_vars[i]->Data, glm::value_ptr(glm::inverse(matVal)), sizeof(glm::mat3x3));
-				} else if (type == ShaderVariable::ValueType::Float2x2) {
-					glm::mat2x2 matVal = glm::make_mat2x2(m_vars[i]->AsFloatPtr());
-					memcpy(m_vars[i]->Data, glm::value_ptr(glm::inverse(matVal)), sizeof(glm::mat2x2));
-				}
+			// skip the upload if the program already has this value
+			int dataSize = ShaderVariable::GetSize(type);
+			if (slot.Shadow.size() == dataSize && memcmp(slot.Shadow.data(), m_vars[i]->Data, dataSize) == 0) {
+				m_skippedCount++;
+				continue;
 			}
+			slot.Shadow.assign(m_vars[i]->Data, m_vars[i]->Data + dataSize);
+			m_uploadCount++;
 
 			switch (type) {
 			case ShaderVariable::ValueType::Boolean1:
@@ -1,7 +1,9 @@
 #pragma once
 #include "ShaderVariable.h"
 #include <vector>
-#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -33,9 +35,47 @@ namespace ed
 		inline std::vector<ShaderVariable*>& GetVariables() { return m_vars; }
 		inline const std::vector<std::string>& GetSamplerList() { return m_samplers; }
 
+		// number of glUniform* calls made/skipped by all containers since the last ResetUploadStats()
+		static inline int GetUploadCount() { return m_uploadCount; }
+		static inline int GetSkippedUploadCount() { return m_skippedCount; }
+		static void ResetUploadStats();
+		static inline int GetLastUploadCount() { return m_lastUploadCount; }
+		static inline int GetLastSkippedUploadCount() { return m_lastSkippedCount; }
+
+		// drop the cached locations & values of a deleted program from all containers
+		static void ForgetProgram(GLuint program);
+
+		// computes the value of a system/function variable, skipped if it doesn't depend on the item and the frame state hasn't changed
+		static void UpdateValue(ShaderVariable* var, void* item = nullptr);
+
 	private:
+		static void m_applyFlags(ShaderVariable* var); // Inverse
+
 		std::vector<ShaderVariable*> m_vars;
-		std::map<std::string, GLint> m_uLocs;
 		std::vector<std::string> m_samplers;
+
+		// location and the last uploaded value of a variable in a specific program
+		struct UniformSlot
+		{
+			UniformSlot() : Variable(nullptr), Location(-1) {}
+			ShaderVariable* Variable;
+			std::string Name;
+			GLint Location;
+			std::vector<char> Shadow;
+		};
+		struct ProgramCache
+		{
+			std::unordered_map<std::string, GLint> Locations;
+			std::vector<UniformSlot> Slots; // same order as m_vars
+		};
+		std::unordered_map<GLuint, ProgramCache> m_programs;
+		GLuint m_program; // program passed to the last UpdateUniformInfo call
+
+		static int m_uploadCount, m_skippedCount, m_lastUploadCount, m_lastSkippedCount;
+		static inline std::unordered_set<ShaderVariableContainer*>& m_getContainers() // all live containers
+		{
+			static std::unordered_set<ShaderVariableContainer*> ret;
+			return ret;
+		}
 	};
 }
\ No newline at end of file
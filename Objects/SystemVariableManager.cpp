@@ -10,11 +10,103 @@ namespace ed
 		m_curGeoTransform.clear();
 		m_prevGeoTransform.clear();
 		m_advTimer = 0;
+		m_stateVersion++;
 	}
 	void SystemVariableManager::CopyState()
 	{
 		memcpy(&m_prevState, &m_curState, sizeof(m_curState));
 		m_prevGeoTransform = m_curGeoTransform;
+		m_stateVersion++;
+	}
+	// { GLSL type, HLSL type, name } - in the same order as UniformBufferData
+	const char* UNIFORM_BUFFER_MEMBERS[][3] = {
+		{ "mat4", "float4x4", "sedView" },
+		{ "mat4", "float4x4", "sedProjection" },
+		{ "mat4", "float4x4", "sedViewProjection" },
+		{ "mat4", "float4x4", "sedOrthographic" },
+		{ "mat4", "float4x4", "sedViewOrthographic" },
+		{ "vec4", "float4", "sedMouse" },
+		{ "vec4", "float4", "sedMouseButton" },
+		{ "vec4", "float4", "sedCameraPosition" },
+		{ "ivec4", "int4", "sedKeysWASD" },
+		{ "vec3", "float3", "sedCameraPosition3" },
+		{ "float", "float", "sedTime" },
+		{ "vec3", "float3", "sedCameraDirection3" },
+		{ "float", "float", "sedTimeDelta" },
+		{ "vec2", "float2", "sedViewportSize" },
+		{ "vec2", "float2", "sedMousePosition" },
+		{ "int", "int", "sedFrameIndex" }
+	};
+
+	void SystemVariableManager::UpdateUniformBuffer()
+	{
+		UniformBufferData data;
+		memset(&data, 0, sizeof(data));
+
+		Camera* cam = GetCamera();
+		data.View = GetViewMatrix();
+		data.Projection = GetProjectionMatrix();
+		data.ViewProjection = data.Projection * data.View;
+		data.Orthographic = GetOrthographicMatrix();
+		data.ViewOrthographic = data.Orthographic * data.View;
+		data.Mouse = m_curState.Mouse;
+		data.MouseButton = m_curState.MouseButton;
+		data.CameraPosition = glm::vec4(cam->GetPosition(), 1);
+		data.KeysWASD = m_curState.WASD;
+		data.CameraPosition3 = cam->GetPosition();
+		data.Time = GetTime();
+		data.CameraDirection3 = cam->GetViewDirection();
+		data.TimeDelta = m_curState.DeltaTime;
+		data.ViewportSize = m_curState.Viewport;
+		data.MousePosition = m_curState.MousePosition;
+		data.FrameIndex = m_curState.FrameIndex;
+
+		if (m_ubo == 0) {
+			glGenBuffers(1, &m_ubo);
+			glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+			glBufferData(GL_UNIFORM_BUFFER, sizeof(UniformBufferData), nullptr, GL_DYNAMIC_DRAW);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+			m_uboValid = false;
+		}
+
+		if (!m_uboValid || memcmp(&data, &m_uboData, sizeof(data)) != 0) {
+			memcpy(&m_uboData, &data, sizeof(data));
+			m_uboValid = true;
+
+			glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+			glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(UniformBufferData), &m_uboData);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		}
+
+		glBindBufferBase(GL_UNIFORM_BUFFER, SYSTEM_UNIFORM_BUFFER_BINDING, m_ubo);
+	}
+	std::string SystemVariableManager::GetUniformBufferDeclaration(ShaderLanguage lang)
+	{
+		std::string ret = "";
+		
+		// HLSL -> global variables, the transcompiler turns them into uniforms which are then replaced with the GLSL block
+		if (lang == ShaderLanguage::HLSL) {
+			for (const auto& member : UNIFORM_BUFFER_MEMBERS)
+				ret += std::string(member[1]) + " " + member[2] + "; ";
+			return ret;
+		}
+
+		ret = "layout(std140";
+		if (lang == ShaderLanguage::VulkanGLSL)
+			ret += ", binding = " + std::to_string(SYSTEM_UNIFORM_BUFFER_BINDING);
+		ret += ") uniform " SYSTEM_UNIFORM_BUFFER_NAME " { ";
+		for (const auto& member : UNIFORM_BUFFER_MEMBERS)
+			ret += std::string(member[0]) + " " + member[2] + "; ";
+		ret += "};";
+
+		return ret;
+	}
+	bool SystemVariableManager::IsUniformBufferMember(const std::string& name)
+	{
+		for (const auto& member : UNIFORM_BUFFER_MEMBERS)
+			if (name == member[2])
+				return true;
+		return false;
 	}
 	void SystemVariableManager::Update(ed::ShaderVariable* var, void* item)
 	{
@@ -123,23 +215,23 @@ namespace ed
 						memcpy(var->Data, glm::value_ptr(rawMatrix), sizeof(glm::mat4));
 						break;
 					case ed::SystemShaderVariable::Projection:
-						rawMatrix = glm::perspective(glm::radians(45.0f), m_prevState.Viewport.x / m_prevState.Viewport.y, 0.1f, 1000.0f);
+						rawMatrix = GetTileMatrix() * glm::perspective(glm::radians(45.0f), m_prevState.Viewport.x / m_prevState.Viewport.y, 0.1f, 1000.0f);
 						memcpy(var->Data, glm::value_ptr(rawMatrix), sizeof(glm::mat4));
 						break;
 					case ed::SystemShaderVariable::ViewProjection: {
 						glm::mat4 view = Settings::Instance().Project.FPCamera ? m_prevState.FPCam.GetMatrix() : m_prevState.ArcCam.GetMatrix();;
-						glm::mat4 persp = glm::perspective(glm::radians(45.0f), m_prevState.Viewport.x / m_prevState.Viewport.y, 0.1f, 1000.0f);
+						glm::mat4 persp = GetTileMatrix() * glm::perspective(glm::radians(45.0f), m_prevState.Viewport.x / m_prevState.Viewport.y, 0.1f, 1000.0f);
 						
 						rawMatrix = persp * view;
 						memcpy(var->Data, glm::value_ptr(rawMatrix), sizeof(glm::mat4));
 					} break;
 					case ed::SystemShaderVariable::Orthographic:
-						rawMatrix = glm::ortho(0.0f, m_prevState.Viewport.x, m_prevState.Viewport.y, 0.0f, 0.1f, 1000.0f);;
+						rawMatrix = GetTileMatrix() * glm::ortho(0.0f, m_prevState.Viewport.x, m_prevState.Viewport.y, 0.0f, 0.1f, 1000.0f);
 						memcpy(var->Data, glm::value_ptr(rawMatrix), sizeof(glm::mat4));
 						break;
 					case ed::SystemShaderVariable::ViewOrthographic: {
 						glm::mat4 view = Settings::Instance().Project.FPCamera ? m_prevState.FPCam.GetMatrix() : m_prevState.ArcCam.GetMatrix();;
-						glm::mat4 ortho = glm::ortho(0.0f, m_prevState.Viewport.x, m_prevState.Viewport.y, 0.0f, 0.1f, 1000.0f);;
+						glm::mat4 ortho = GetTileMatrix() * glm::ortho(0.0f, m_prevState.Viewport.x, m_prevState.Viewport.y, 0.0f, 0.1f, 1000.0f);
 						rawMatrix = ortho * view;
 						memcpy(var->Data, glm::value_ptr(rawMatrix), sizeof(glm::mat4));
 					} break;
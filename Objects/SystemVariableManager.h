@@ -4,6 +4,7 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/euler_angles.hpp>
 #include "ShaderVariable.h"
+#include "ShaderLanguage.h"
 #include "ArcBallCamera.h"
 #include "PipelineItem.h"
 #include "FirstPersonCamera.h"
@@ -33,6 +34,10 @@ namespace ed
 			m_curState.DeltaTime = 0.0f;
 			m_curGeoTransform.clear();
 			m_prevGeoTransform.clear();
+			m_ubo = 0;
+			m_uboValid = false;
+			m_tile = glm::vec4(0, 0, 1, 1);
+			m_stateVersion = 1;
 		}
 
 		static inline ed::ShaderVariable::ValueType GetType(ed::SystemShaderVariable sysVar)
@@ -63,13 +68,22 @@ namespace ed
 
 		void Update(ed::ShaderVariable* var, void* item = nullptr);
 
+		// Settings::Project.SystemUniformBuffer -> all non per-item system values are stored in one std140 uniform buffer
+		void UpdateUniformBuffer(); // uploads only if some value has changed
+		static std::string GetUniformBufferDeclaration(ShaderLanguage lang);
+		static bool IsUniformBufferMember(const std::string& name);
+
 		void Reset();
 		void CopyState();
 
+		// changes whenever a value that isn't per item might have changed - ShaderVariableContainer only recomputes those values when it does
+		inline unsigned int GetStateVersion() { return m_stateVersion; }
+		inline void Invalidate() { m_stateVersion++; } // call at the start of every frame (time, camera, function arguments, ...)
+
 		inline Camera* GetCamera() { return Settings::Instance().Project.FPCamera ? (Camera*)&m_curState.FPCam : (Camera*)&m_curState.ArcCam; }
 		inline glm::mat4 GetViewMatrix() { return Settings::Instance().Project.FPCamera ? m_curState.FPCam.GetMatrix() : m_curState.ArcCam.GetMatrix(); }
-		inline glm::mat4 GetProjectionMatrix() { return glm::perspective(glm::radians(45.0f), m_curState.Viewport.x / m_curState.Viewport.y, 0.1f, 1000.0f); }
-		inline glm::mat4 GetOrthographicMatrix() { return glm::ortho(0.0f, m_curState.Viewport.x, m_curState.Viewport.y, 0.0f, 0.1f, 1000.0f); }
+		inline glm::mat4 GetProjectionMatrix() { return GetTileMatrix() * glm::perspective(glm::radians(45.0f), m_curState.Viewport.x / m_curState.Viewport.y, 0.1f, 1000.0f); }
+		inline glm::mat4 GetOrthographicMatrix() { return GetTileMatrix() * glm::ortho(0.0f, m_curState.Viewport.x, m_curState.Viewport.y, 0.0f, 0.1f, 1000.0f); }
 		inline glm::mat4 GetViewProjectionMatrix() { return GetProjectionMatrix() * GetViewMatrix(); }
 		inline glm::mat4 GetViewOrthographicMatrix() { return GetOrthographicMatrix() * GetViewMatrix(); }
 		inline glm::mat4 GetGeometryTransform(PipelineItem* item) { return m_curGeoTransform[item]; }
@@ -84,22 +98,45 @@ namespace ed
 		inline float GetTimeDelta() { return m_curState.DeltaTime; }
 		inline bool IsPicked() { return m_curState.IsPicked; }
 
+		// tiled rendering - the projection & orthographic matrices only cover the tile part of the viewport
+		inline void SetTile(const glm::vec4& tile) // x, y, width, height in 0..1, bottom-left origin
+		{
+			if (m_tile != tile) {
+				m_tile = tile;
+				m_stateVersion++;
+			}
+		}
+		inline const glm::vec4& GetTile() { return m_tile; }
+		inline bool IsTiled() { return m_tile != glm::vec4(0, 0, 1, 1); }
+		inline glm::mat4 GetTileMatrix()
+		{
+			// maps the tile's part of the clip space to the whole clip space
+			glm::vec2 center = glm::vec2(m_tile.x + m_tile.z * 0.5f, m_tile.y + m_tile.w * 0.5f) * 2.0f - 1.0f;
+			return glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / m_tile.z, 1.0f / m_tile.w, 1.0f)) * glm::translate(glm::mat4(1.0f), glm::vec3(-center, 0.0f));
+		}
+
 		inline void SetGeometryTransform(PipelineItem* item, const glm::vec3& scale, const glm::vec3& rota, const glm::vec3& pos)
 		{
 			m_curGeoTransform[item] = glm::translate(glm::mat4(1), pos) *
 				glm::yawPitchRoll(rota.y, rota.x, rota.z) * 
 				glm::scale(glm::mat4(1.0f), scale);
 		}
-		inline void SetViewportSize(float x, float y) { m_curState.Viewport = glm::vec2(x, y); }
-		inline void SetMousePosition(float x, float y) { m_curState.MousePosition = glm::vec2(x, y); }
-		inline void SetMouse(float x, float y, float left, float right) { m_curState.Mouse = glm::vec4(x, y, left, right); }
-		inline void SetMouseButton(float x, float y, float left, float right) { m_curState.MouseButton = glm::vec4(x, y, left, right); }
-		inline void SetTimeDelta(float x) { m_curState.DeltaTime = x; }
-		inline void SetPicked(bool picked) { m_curState.IsPicked = picked; }
-		inline void SetKeysWASD(int w, int a, int s, int d) { m_curState.WASD = glm::ivec4(w, a, s, d); }
-		inline void SetFrameIndex(unsigned int ind) { m_curState.FrameIndex = ind; }
+		inline void SetViewportSize(float x, float y) // changes between the passes
+		{
+			if (m_curState.Viewport != glm::vec2(x, y)) {
+				m_curState.Viewport = glm::vec2(x, y);
+				m_stateVersion++;
+			}
+		}
+		inline void SetMousePosition(float x, float y) { m_curState.MousePosition = glm::vec2(x, y); m_stateVersion++; }
+		inline void SetMouse(float x, float y, float left, float right) { m_curState.Mouse = glm::vec4(x, y, left, right); m_stateVersion++; }
+		inline void SetMouseButton(float x, float y, float left, float right) { m_curState.MouseButton = glm::vec4(x, y, left, right); m_stateVersion++; }
+		inline void SetTimeDelta(float x) { m_curState.DeltaTime = x; m_stateVersion++; }
+		inline void SetPicked(bool picked) { m_curState.IsPicked = picked; } // per item, always recomputed
+		inline void SetKeysWASD(int w, int a, int s, int d) { m_curState.WASD = glm::ivec4(w, a, s, d); m_stateVersion++; }
+		inline void SetFrameIndex(unsigned int ind) { m_curState.FrameIndex = ind; m_stateVersion++; }
 
-		inline void AdvanceTimer(float t) { m_advTimer += t; }
+		inline void AdvanceTimer(float t) { m_advTimer += t; m_stateVersion++; }
 
 	private:
 		eng::Timer m_timer;
@@ -119,5 +156,25 @@ namespace ed
 
 
 		std::unordered_map<PipelineItem*, glm::mat4> m_curGeoTransform, m_prevGeoTransform;
+
+		glm::vec4 m_tile;
+		unsigned int m_stateVersion;
+
+		// std140 layout, must match GetUniformBufferDeclaration()
+		struct UniformBufferData
+		{
+			glm::mat4 View, Projection, ViewProjection, Orthographic, ViewOrthographic;
+			glm::vec4 Mouse, MouseButton, CameraPosition;
+			glm::ivec4 KeysWASD;
+			glm::vec3 CameraPosition3;
+			float Time;
+			glm::vec3 CameraDirection3;
+			float TimeDelta;
+			glm::vec2 ViewportSize, MousePosition;
+			int FrameIndex;
+			int Padding[3];
+		} m_uboData;
+		GLuint m_ubo;
+		bool m_uboValid;
 	};
 }
\ No newline at end of file
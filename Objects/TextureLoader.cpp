@@ -0,0 +1,562 @@
+#include "TextureLoader.h"
+#include "Logger.h"
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stb/stb_image.h>
+
+#define CONTAINER_HEADER_SIZE 148 // DDS + DX10 header, the largest of the three
+#define CONTAINER_MAX_LEVELS 16
+#define DDS_MAGIC 0x20534444 // "DDS "
+#define DDS_FOURCC(a, b, c, d) ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+namespace ed
+{
+	static const unsigned char KTX1_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+	static const unsigned char KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	static inline uint32_t readU32(const unsigned char* data) { return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24); }
+	static inline uint64_t readU64(const unsigned char* data) { return (uint64_t)readU32(data) | ((uint64_t)readU32(data + 4) << 32); }
+
+	// bytes per 4x4 block, 0 if the format isn't one of the supported BCn formats
+	static int getBlockSize(unsigned int format)
+	{
+		switch (format) {
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RED_RGTC1:
+		case GL_COMPRESSED_SIGNED_RED_RGTC1:
+			return 8;
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_RG_RGTC2:
+		case GL_COMPRESSED_SIGNED_RG_RGTC2:
+		case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+		case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+		case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+			return 16;
+		}
+		return 0;
+	}
+	// flips the first rowCount rows of a 4x4 block of 3 bit BC3 alpha/BC4/BC5 indices (48 bits, 12 per row)
+	static void flipAlphaIndices(unsigned char* data, int rowCount)
+	{
+		uint64_t bits = 0;
+		for (int i = 0; i < 6; i++)
+			bits |= (uint64_t)data[i] << (i * 8);
+
+		uint64_t flipped = bits;
+		for (int y = 0; y < rowCount; y++) {
+			uint64_t row = (bits >> (y * 12)) & 0xFFF;
+			int dstRow = rowCount - 1 - y;
+			flipped &= ~((uint64_t)0xFFF << (dstRow * 12));
+			flipped |= row << (dstRow * 12);
+		}
+
+		for (int i = 0; i < 6; i++)
+			data[i] = (unsigned char)(flipped >> (i * 8));
+	}
+	// flips the first rowCount rows of a block, rowSize = bytes per row (BC1 color indices: 1, BC2 alpha: 2)
+	static void flipBlockRows(unsigned char* data, int rowSize, int rowCount)
+	{
+		unsigned char temp[2];
+		for (int y = 0; y < rowCount / 2; y++) {
+			unsigned char* top = data + y * rowSize;
+			unsigned char* bottom = data + (rowCount - 1 - y) * rowSize;
+			memcpy(temp, top, rowSize);
+			memcpy(top, bottom, rowSize);
+			memcpy(bottom, temp, rowSize);
+		}
+	}
+	static void flipBlock(unsigned char* block, unsigned int format, int rowCount)
+	{
+		switch (format) {
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+			flipBlockRows(block + 4, 1, rowCount);
+			break;
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+			flipBlockRows(block, 2, rowCount);
+			flipBlockRows(block + 12, 1, rowCount);
+			break;
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+			flipAlphaIndices(block + 2, rowCount);
+			flipBlockRows(block + 12, 1, rowCount);
+			break;
+		case GL_COMPRESSED_RED_RGTC1:
+		case GL_COMPRESSED_SIGNED_RED_RGTC1:
+			flipAlphaIndices(block + 2, rowCount);
+			break;
+		case GL_COMPRESSED_RG_RGTC2:
+		case GL_COMPRESSED_SIGNED_RG_RGTC2:
+			flipAlphaIndices(block + 2, rowCount);
+			flipAlphaIndices(block + 10, rowCount);
+			break;
+		}
+	}
+	static unsigned int getFormatFromDXGI(uint32_t dxgi, bool& compressed)
+	{
+		compressed = true;
+		switch (dxgi) {
+		case 28: compressed = false; return GL_RGBA8; // R8G8B8A8_UNORM
+		case 29: compressed = false; return GL_SRGB8_ALPHA8; // R8G8B8A8_UNORM_SRGB
+		case 71: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; // BC1_UNORM
+		case 72: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; // BC1_UNORM_SRGB
+		case 74: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; // BC2_UNORM
+		case 75: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT; // BC2_UNORM_SRGB
+		case 77: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; // BC3_UNORM
+		case 78: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; // BC3_UNORM_SRGB
+		case 80: return GL_COMPRESSED_RED_RGTC1; // BC4_UNORM
+		case 81: return GL_COMPRESSED_SIGNED_RED_RGTC1; // BC4_SNORM
+		case 83: return GL_COMPRESSED_RG_RGTC2; // BC5_UNORM
+		case 84: return GL_COMPRESSED_SIGNED_RG_RGTC2; // BC5_SNORM
+		case 95: return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT; // BC6H_UF16
+		case 96: return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT; // BC6H_SF16
+		case 98: return GL_COMPRESSED_RGBA_BPTC_UNORM; // BC7_UNORM
+		case 99: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; // BC7_UNORM_SRGB
+		}
+		return 0;
+	}
+	static unsigned int getFormatFromVk(uint32_t vkFormat, bool& compressed)
+	{
+		compressed = true;
+		switch (vkFormat) {
+		case 37: compressed = false; return GL_RGBA8; // R8G8B8A8_UNORM
+		case 43: compressed = false; return GL_SRGB8_ALPHA8; // R8G8B8A8_SRGB
+		case 131: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT; // BC1_RGB_UNORM_BLOCK
+		case 132: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT; // BC1_RGB_SRGB_BLOCK
+		case 133: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; // BC1_RGBA_UNORM_BLOCK
+		case 134: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; // BC1_RGBA_SRGB_BLOCK
+		case 135: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; // BC2_UNORM_BLOCK
+		case 136: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT; // BC2_SRGB_BLOCK
+		case 137: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; // BC3_UNORM_BLOCK
+		case 138: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; // BC3_SRGB_BLOCK
+		case 139: return GL_COMPRESSED_RED_RGTC1; // BC4_UNORM_BLOCK
+		case 140: return GL_COMPRESSED_SIGNED_RED_RGTC1; // BC4_SNORM_BLOCK
+		case 141: return GL_COMPRESSED_RG_RGTC2; // BC5_UNORM_BLOCK
+		case 142: return GL_COMPRESSED_SIGNED_RG_RGTC2; // BC5_SNORM_BLOCK
+		case 143: return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT; // BC6H_UFLOAT_BLOCK
+		case 144: return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT; // BC6H_SFLOAT_BLOCK
+		case 145: return GL_COMPRESSED_RGBA_BPTC_UNORM; // BC7_UNORM_BLOCK
+		case 146: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; // BC7_SRGB_BLOCK
+		}
+		return 0;
+	}
+
+	// parses a KTX, KTX2 or DDS header - the levels are only filled (and checked) if the whole file is passed
+	static bool parseContainer(const unsigned char* data, size_t size, TextureLoader::Info& info, std::vector<TextureLoader::Level>* levels, std::string& error)
+	{
+		std::vector<size_t> offsets;
+		size_t dataOffset = 0;
+		bool sequential = false;
+
+		if (size >= 128 && readU32(data) == DDS_MAGIC) {
+			info.Container = true;
+
+			uint32_t flags = readU32(data + 8);
+			uint32_t mipCount = readU32(data + 28);
+			uint32_t pfFlags = readU32(data + 80);
+			uint32_t fourCC = readU32(data + 84);
+			uint32_t caps2 = readU32(data + 112);
+
+			info.Height = (int)readU32(data + 12);
+			info.Width = (int)readU32(data + 16);
+			info.Levels = (flags & 0x20000 /* DDSD_MIPMAPCOUNT */) && mipCount > 0 ? (int)mipCount : 1;
+			dataOffset = 128;
+			sequential = true;
+
+			if (caps2 & (0x200 /* cube map */ | 0x200000 /* volume */)) {
+				error = "cube maps and volume textures are not supported";
+				return false;
+			}
+
+			if (pfFlags & 0x4 /* DDPF_FOURCC */) {
+				info.Compressed = true;
+				switch (fourCC) {
+				case DDS_FOURCC('D', 'X', 'T', '1'): info.Format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;
+				case DDS_FOURCC('D', 'X', 'T', '3'): info.Format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; break;
+				case DDS_FOURCC('D', 'X', 'T', '5'): info.Format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+				case DDS_FOURCC('A', 'T', 'I', '1'):
+				case DDS_FOURCC('B', 'C', '4', 'U'): info.Format = GL_COMPRESSED_RED_RGTC1; break;
+				case DDS_FOURCC('B', 'C', '4', 'S'): info.Format = GL_COMPRESSED_SIGNED_RED_RGTC1; break;
+				case DDS_FOURCC('A', 'T', 'I', '2'):
+				case DDS_FOURCC('B', 'C', '5', 'U'): info.Format = GL_COMPRESSED_RG_RGTC2; break;
+				case DDS_FOURCC('B', 'C', '5', 'S'): info.Format = GL_COMPRESSED_SIGNED_RG_RGTC2; break;
+				case DDS_FOURCC('D', 'X', '1', '0'):
+					if (size < 148) {
+						error = "the DX10 header is missing";
+						return false;
+					}
+					if (readU32(data + 132) != 3 /* TEXTURE2D */ || readU32(data + 140) > 1) {
+						error = "only 2D textures are supported";
+						return false;
+					}
+					info.Format = getFormatFromDXGI(readU32(data + 128), info.Compressed);
+					dataOffset = 148;
+					break;
+				}
+			} else if ((pfFlags & 0x40 /* DDPF_RGB */) && readU32(data + 88) == 32 &&
+				readU32(data + 92) == 0x000000FF && readU32(data + 96) == 0x0000FF00 && readU32(data + 100) == 0x00FF0000) {
+				info.Format = GL_RGBA8;
+				info.Compressed = false;
+			}
+		}
+		else if (size >= 64 && memcmp(data, KTX1_IDENTIFIER, 12) == 0) {
+			info.Container = true;
+
+			if (readU32(data + 12) != 0x04030201) {
+				error = "big endian KTX files are not supported";
+				return false;
+			}
+
+			uint32_t glType = readU32(data + 16);
+			uint32_t glFormat = readU32(data + 24);
+			uint32_t glInternalFormat = readU32(data + 28);
+
+			info.Width = (int)readU32(data + 36);
+			info.Height = (int)readU32(data + 40);
+			info.Levels = std::max<int>(1, (int)readU32(data + 56));
+			dataOffset = 64 + (size_t)readU32(data + 60); // skip the key/value data
+
+			if (readU32(data + 44) > 1 || readU32(data + 48) > 0 || readU32(data + 52) != 1) {
+				error = "only 2D textures are supported";
+				return false;
+			}
+
+			if (glType == 0 && getBlockSize(glInternalFormat) != 0) {
+				info.Format = glInternalFormat;
+				info.Compressed = true;
+			} else if (glType == GL_UNSIGNED_BYTE && glFormat == GL_RGBA && (glInternalFormat == GL_RGBA8 || glInternalFormat == GL_SRGB8_ALPHA8)) {
+				info.Format = glInternalFormat;
+				info.Compressed = false;
+			}
+
+			// every level is prefixed with its size
+			if (levels != nullptr) {
+				size_t offset = dataOffset;
+				for (int i = 0; i < info.Levels && offset + 4 <= size; i++) {
+					uint32_t imageSize = readU32(data + offset);
+					offsets.push_back(offset + 4);
+					offset += 4 + ((imageSize + 3) & ~3u);
+				}
+			}
+		}
+		else if (size >= 80 && memcmp(data, KTX2_IDENTIFIER, 12) == 0) {
+			info.Container = true;
+
+			info.Width = (int)readU32(data + 20);
+			info.Height = (int)readU32(data + 24);
+			info.Levels = std::max<int>(1, (int)readU32(data + 40));
+
+			if (readU32(data + 28) > 0 || readU32(data + 32) > 0 || readU32(data + 36) != 1) {
+				error = "only 2D textures are supported";
+				return false;
+			}
+			if (readU32(data + 44) != 0) {
+				error = "supercompressed KTX2 files (BasisLZ, Zstandard) are not supported";
+				return false;
+			}
+
+			info.Format = getFormatFromVk(readU32(data + 12), info.Compressed);
+
+			// level index follows the header
+			if (levels != nullptr && 80 + (size_t)info.Levels * 24 <= size)
+				for (int i = 0; i < info.Levels; i++)
+					offsets.push_back((size_t)readU64(data + 80 + i * 24));
+		}
+		else {
+			error = "not a KTX, KTX2 or DDS file";
+			return false;
+		}
+
+		if (info.Format == 0) {
+			error = "unsupported pixel format";
+			return false;
+		}
+		if (info.Width <= 0 || info.Height <= 0 || info.Levels > CONTAINER_MAX_LEVELS) {
+			error = "invalid size";
+			return false;
+		}
+
+		if (levels != nullptr) {
+			// DDS levels are stored one after another
+			if (sequential) {
+				size_t offset = dataOffset;
+				for (int i = 0; i < info.Levels; i++) {
+					offsets.push_back(offset);
+					offset += TextureLoader::GetLevelSize(info.Format, info.Compressed, std::max(1, info.Width >> i), std::max(1, info.Height >> i));
+				}
+			}
+
+			levels->clear();
+			for (int i = 0; i < info.Levels; i++) {
+				TextureLoader::Level level;
+				level.Width = std::max(1, info.Width >> i);
+				level.Height = std::max(1, info.Height >> i);
+				level.Offset = i < offsets.size() ? offsets[i] : size;
+				level.Size = TextureLoader::GetLevelSize(info.Format, info.Compressed, level.Width, level.Height);
+
+				if (level.Offset > size || size - level.Offset < level.Size) {
+					error = "the file is truncated";
+					return false;
+				}
+
+				levels->push_back(level);
+			}
+		}
+
+		return true;
+	}
+
+	TextureLoader::Task::~Task()
+	{
+		if (Pixels != nullptr)
+			stbi_image_free(Pixels);
+	}
+
+	TextureLoader::TextureLoader()
+	{
+		m_running = true;
+		m_pending = 0;
+	}
+	TextureLoader::~TextureLoader()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			m_running = false;
+			m_queue.clear();
+		}
+		m_queueCV.notify_all();
+
+		for (auto& thread : m_threads)
+			if (thread.joinable())
+				thread.join();
+	}
+	void TextureLoader::Add(std::shared_ptr<Task> task)
+	{
+		task->QueueTime = std::chrono::steady_clock::now();
+		m_pending++;
+
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+
+			// start the workers on first use, leave one core for the UI thread
+			if (m_threads.size() == 0) {
+				int threadCount = std::max<int>(1, (int)std::thread::hardware_concurrency() - 1);
+				Logger::Get().Log("Starting " + std::to_string(threadCount) + " texture loader threads");
+				for (int i = 0; i < threadCount; i++)
+					m_threads.push_back(std::thread(&TextureLoader::m_worker, this));
+			}
+
+			m_queue.push_back(task);
+		}
+		m_queueCV.notify_one();
+	}
+	bool TextureLoader::Poll(std::shared_ptr<Task>& task)
+	{
+		std::lock_guard<std::mutex> lock(m_doneMutex);
+		if (m_done.size() == 0)
+			return false;
+
+		task = m_done.front();
+		m_done.pop_front();
+		m_pending--;
+		return true;
+	}
+	void TextureLoader::Run(Task& task)
+	{
+		auto startTime = std::chrono::steady_clock::now();
+
+		if (task.Header.Container)
+			m_readContainer(task);
+		else {
+			// stb pads RGB and grayscale images to RGBA itself
+			int channels = 0;
+			task.Pixels = stbi_load(task.Path.c_str(), &task.Width, &task.Height, &channels, 4);
+			task.Failed = task.Pixels == nullptr;
+		}
+
+		task.DecodeTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	}
+	bool TextureLoader::ReadInfo(const std::string& path, Info& info)
+	{
+		FILE* file = fopen(path.c_str(), "rb");
+		if (file == nullptr)
+			return false;
+
+		unsigned char header[CONTAINER_HEADER_SIZE];
+		size_t headerSize = fread(header, 1, CONTAINER_HEADER_SIZE, file);
+		fclose(file);
+
+		std::string error;
+		if (parseContainer(header, headerSize, info, nullptr, error))
+			return true;
+		if (info.Container) {
+			Logger::Get().Log("Failed to load " + path + ": " + error, true);
+			return false;
+		}
+
+		int channels = 0;
+		info = Info();
+		info.Format = GL_RGBA8;
+		return stbi_info(path.c_str(), &info.Width, &info.Height, &channels);
+	}
+	size_t TextureLoader::GetLevelSize(unsigned int format, bool compressed, int width, int height)
+	{
+		if (!compressed)
+			return (size_t)width * height * 4;
+		return (size_t)((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(format);
+	}
+	bool TextureLoader::CanFlip(unsigned int format, bool compressed)
+	{
+		if (!compressed)
+			return true;
+
+		// BC6H and BC7 blocks can't be flipped without decoding them
+		switch (format) {
+		case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+		case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+		case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+			return false;
+		}
+		return getBlockSize(format) != 0;
+	}
+	void TextureLoader::Flip(unsigned char* data, unsigned int format, bool compressed, int width, int height)
+	{
+		if (!compressed) {
+			size_t rowSize = (size_t)width * 4;
+			std::vector<unsigned char> row(rowSize);
+			for (int y = 0; y < height / 2; y++) {
+				unsigned char* top = data + y * rowSize;
+				unsigned char* bottom = data + (height - 1 - y) * rowSize;
+				memcpy(row.data(), top, rowSize);
+				memcpy(top, bottom, rowSize);
+				memcpy(bottom, row.data(), rowSize);
+			}
+			return;
+		}
+
+		int blockSize = getBlockSize(format);
+		int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+		size_t rowSize = (size_t)blocksX * blockSize;
+
+		// reverse the order of the block rows...
+		std::vector<unsigned char> row(rowSize);
+		for (int y = 0; y < blocksY / 2; y++) {
+			unsigned char* top = data + y * rowSize;
+			unsigned char* bottom = data + (blocksY - 1 - y) * rowSize;
+			memcpy(row.data(), top, rowSize);
+			memcpy(top, bottom, rowSize);
+			memcpy(bottom, row.data(), rowSize);
+		}
+
+		// ... and the pixel rows in each block, levels smaller than a block only flip the rows they use
+		int rowCount = std::min(height, 4);
+		for (size_t i = 0; i < (size_t)blocksX * blocksY; i++)
+			flipBlock(data + i * blockSize, format, rowCount);
+	}
+	const char* TextureLoader::GetFormatName(unsigned int format)
+	{
+		switch (format) {
+		case GL_RGBA8: return "RGBA8";
+		case GL_SRGB8_ALPHA8: return "SRGB8_ALPHA8";
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: return "BC1";
+		case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT: return "BC1 sRGB";
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT: return "BC2";
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT: return "BC2 sRGB";
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return "BC3";
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT: return "BC3 sRGB";
+		case GL_COMPRESSED_RED_RGTC1: return "BC4";
+		case GL_COMPRESSED_SIGNED_RED_RGTC1: return "BC4 SNORM";
+		case GL_COMPRESSED_RG_RGTC2: return "BC5";
+		case GL_COMPRESSED_SIGNED_RG_RGTC2: return "BC5 SNORM";
+		case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT: return "BC6H UF16";
+		case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT: return "BC6H SF16";
+		case GL_COMPRESSED_RGBA_BPTC_UNORM: return "BC7";
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM: return "BC7 sRGB";
+		}
+		return "Unknown";
+	}
+	void TextureLoader::m_readContainer(Task& task)
+	{
+		task.Failed = true;
+
+		FILE* file = fopen(task.Path.c_str(), "rb");
+		if (file == nullptr)
+			return;
+
+		fseek(file, 0, SEEK_END);
+		long fileSize = ftell(file);
+		fseek(file, 0, SEEK_SET);
+
+		if (fileSize > 0) {
+			task.Data.resize(fileSize);
+			task.Failed = fread(task.Data.data(), 1, fileSize, file) != (size_t)fileSize;
+		}
+		fclose(file);
+
+		if (task.Failed)
+			return;
+
+		std::string error;
+		Info info;
+		if (!parseContainer(task.Data.data(), task.Data.size(), info, &task.Levels, error)) {
+			Logger::Get().Log("Failed to load " + task.Path + ": " + error, true);
+			task.Failed = true;
+			return;
+		}
+
+		task.Header = info;
+		task.Width = info.Width;
+		task.Height = info.Height;
+
+		// levels are flipped like the images that stb_image loads
+		if (!task.Flip)
+			return;
+		if (!CanFlip(info.Format, info.Compressed)) {
+			Logger::Get().Log("Texture " + task.Name + " uses " + GetFormatName(info.Format) + " which can't be flipped - it will be upside down compared to other formats", true);
+			return;
+		}
+		if (info.Compressed && info.Height > 4 && info.Height % 4 != 0)
+			Logger::Get().Log("The height of " + task.Name + " isn't a multiple of 4 - the flipped texture is off by " + std::to_string(4 - info.Height % 4) + " rows", true);
+
+		for (const Level& level : task.Levels)
+			Flip(task.Data.data() + level.Offset, info.Format, info.Compressed, level.Width, level.Height);
+	}
+	void TextureLoader::m_worker()
+	{
+		while (true) {
+			std::shared_ptr<Task> task;
+			{
+				std::unique_lock<std::mutex> lock(m_queueMutex);
+				m_queueCV.wait(lock, [&]() { return !m_running || m_queue.size() > 0; });
+
+				if (!m_running)
+					return;
+
+				task = m_queue.front();
+				m_queue.pop_front();
+			}
+
+			Run(*task);
+
+			std::lock_guard<std::mutex> lock(m_doneMutex);
+			m_done.push_back(task);
+		}
+	}
+}
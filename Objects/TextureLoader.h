@@ -0,0 +1,88 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+
+namespace ed
+{
+	// decodes image files on worker threads - the ObjectManager uploads the results on the GL thread
+	// KTX, KTX2 and DDS files are not decoded, their levels (BCn or RGBA8) are only flipped vertically like the stb_image ones
+	class TextureLoader
+	{
+	public:
+		struct Info
+		{
+			Info() { Width = Height = 0; Levels = 1; Format = 0; Compressed = false; Container = false; }
+
+			int Width, Height;
+			int Levels; // mip levels stored in the file
+			unsigned int Format; // GL internal format
+			bool Compressed;
+			bool Container; // KTX, KTX2 or DDS
+		};
+		struct Level
+		{
+			int Width, Height;
+			size_t Offset, Size; // in Task::Data
+		};
+		struct Task
+		{
+			Task() { Owner = 0; Epoch = 0; Flip = true; Pixels = nullptr; Width = Height = 0; Failed = false; DecodeTime = 0.0f; }
+			~Task();
+
+			// input
+			unsigned int Owner; // ObjectHandle of the texture
+			unsigned int Epoch;
+			std::string Name;
+			std::string Path; // absolute path
+			Info Header; // ReadInfo()
+			bool Flip; // container files only, false -> levels are kept in the file's row order
+
+			// output
+			unsigned char* Pixels; // RGBA8, images decoded by stb_image
+			std::vector<unsigned char> Data; // contents of a container file
+			std::vector<Level> Levels; // container files only, largest level first
+			int Width, Height;
+			bool Failed;
+
+			std::chrono::steady_clock::time_point QueueTime;
+			float DecodeTime; // ms
+		};
+
+		TextureLoader();
+		~TextureLoader();
+
+		void Add(std::shared_ptr<Task> task);
+		bool Poll(std::shared_ptr<Task>& task); // returns a decoded task, if there is one
+		void Run(Task& task); // on the calling thread
+
+		// only reads the header of the file
+		static bool ReadInfo(const std::string& path, Info& info);
+		static size_t GetLevelSize(unsigned int format, bool compressed, int width, int height);
+		static const char* GetFormatName(unsigned int format);
+		static bool CanFlip(unsigned int format, bool compressed); // false for BC6H & BC7
+		static void Flip(unsigned char* data, unsigned int format, bool compressed, int width, int height); // one level, in place
+
+		inline int GetPendingCount() { return m_pending; } // queued + decoding + decoded but not polled yet
+
+	private:
+		void m_worker();
+		void m_readContainer(Task& task);
+
+		bool m_running;
+		std::vector<std::thread> m_threads;
+		std::deque<std::shared_ptr<Task>> m_queue;
+		std::mutex m_queueMutex;
+		std::condition_variable m_queueCV;
+
+		std::deque<std::shared_ptr<Task>> m_done;
+		std::mutex m_doneMutex;
+		std::atomic<int> m_pending;
+	};
+}
@@ -0,0 +1,207 @@
+#include "TranscompileCache.h"
+#include "Settings.h"
+#include "Logger.h"
+#include "Hash.h"
+#include "IncludeCache.h"
+
+#include <ghc/filesystem.hpp>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdlib.h>
+
+#define TRANSCOMPILE_CACHE_DIR "data/cache/transcompile"
+#define TRANSCOMPILE_CACHE_VERSION 1
+#define TRANSCOMPILE_CACHE_MEMORY_ENTRIES 256
+#define TRANSCOMPILE_CACHE_DISK_ENTRIES 1024
+
+namespace ed
+{
+	bool hashFile(const std::string& path, uint64_t& out)
+	{
+		std::string content;
+		if (!IncludeCache::Instance().Get(path, content))
+			return false;
+
+		out = Hash().Add(content).Get();
+		return true;
+	}
+
+	TranscompileCache::TranscompileCache()
+	{
+		m_useCounter = 0;
+		m_hits = m_misses = 0;
+	}
+	bool TranscompileCache::Get(const std::string& key, std::string& source, std::vector<std::string>* includes)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto it = m_entries.find(key);
+		if (it == m_entries.end()) {
+			Entry entry;
+			if (!Settings::Instance().General.ProgramCache || !m_load(key, entry)) {
+				m_misses++;
+				return false;
+			}
+			it = m_entries.insert(std::make_pair(key, entry)).first;
+			m_evict();
+		}
+
+		if (!m_isFresh(it->second)) {
+			m_entries.erase(it);
+			m_misses++;
+			return false;
+		}
+
+		it->second.LastUse = ++m_useCounter;
+		source = it->second.Source;
+		if (includes != nullptr)
+			for (const auto& inc : it->second.Includes)
+				includes->push_back(inc.first);
+		m_hits++;
+
+		return true;
+	}
+	void TranscompileCache::Store(const std::string& key, const std::string& source, const std::vector<std::string>& includes)
+	{
+		Entry entry;
+		entry.Source = source;
+		for (const auto& inc : includes) {
+			uint64_t hash = 0;
+			if (!hashFile(inc, hash))
+				return; // removed in the meantime?
+			entry.Includes.push_back(std::make_pair(inc, hash));
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		entry.LastUse = ++m_useCounter;
+		m_entries[key] = entry;
+		m_evict();
+
+		if (Settings::Instance().General.ProgramCache)
+			m_save(key, entry);
+	}
+	void TranscompileCache::Clear()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		Logger::Get().Log("Clearing the transcompile cache");
+
+		m_entries.clear();
+		m_hits = m_misses = 0;
+
+		std::error_code ec;
+		ghc::filesystem::remove_all(TRANSCOMPILE_CACHE_DIR, ec);
+	}
+	bool TranscompileCache::m_isFresh(const Entry& entry)
+	{
+		for (const auto& inc : entry.Includes) {
+			uint64_t hash = 0;
+			if (!hashFile(inc.first, hash) || hash != inc.second)
+				return false;
+		}
+		return true;
+	}
+	bool TranscompileCache::m_load(const std::string& key, Entry& entry)
+	{
+		std::string path = m_getPath(key);
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open())
+			return false;
+
+		/*
+			SEDT <version>
+			<include count>
+			<hash> <path>
+			...
+			<source length>
+			<source>
+		*/
+		std::string magic, line;
+		int version = 0, includeCount = 0;
+		size_t sourceLength = 0;
+		file >> magic >> version >> includeCount;
+		if (!file || magic != "SEDT" || version != TRANSCOMPILE_CACHE_VERSION || includeCount < 0)
+			return false;
+
+		std::getline(file, line);
+		for (int i = 0; i < includeCount; i++) {
+			std::getline(file, line);
+			size_t space = line.find(' ');
+			if (!file || space == std::string::npos)
+				return false;
+
+			uint64_t hash = strtoull(line.substr(0, space).c_str(), nullptr, 16);
+			entry.Includes.push_back(std::make_pair(line.substr(space + 1), hash));
+		}
+
+		file >> sourceLength;
+		file.get(); // \n
+		entry.Source.resize(sourceLength);
+		file.read(&entry.Source[0], sourceLength);
+		if (!file)
+			return false;
+		file.close();
+
+		// last write time is used for the LRU eviction
+		std::error_code ec;
+		ghc::filesystem::last_write_time(path, ghc::filesystem::file_time_type::clock::now(), ec);
+
+		entry.LastUse = ++m_useCounter;
+		return true;
+	}
+	void TranscompileCache::m_save(const std::string& key, const Entry& entry)
+	{
+		std::error_code ec;
+		ghc::filesystem::create_directories(TRANSCOMPILE_CACHE_DIR, ec);
+
+		std::ofstream file(m_getPath(key), std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			Logger::Get().Log("Failed to write the transcompile cache entry " + m_getPath(key), true);
+			return;
+		}
+
+		file << "SEDT " << TRANSCOMPILE_CACHE_VERSION << "\n";
+		file << entry.Includes.size() << "\n";
+		for (const auto& inc : entry.Includes) {
+			char hashStr[17] = { 0 };
+			snprintf(hashStr, 17, "%016llx", (unsigned long long)inc.second);
+			file << hashStr << " " << inc.first << "\n";
+		}
+		file << entry.Source.size() << "\n";
+		file.write(entry.Source.data(), entry.Source.size());
+		file.close();
+
+		m_evictDisk();
+	}
+	void TranscompileCache::m_evict()
+	{
+		while (m_entries.size() > TRANSCOMPILE_CACHE_MEMORY_ENTRIES) {
+			auto oldest = m_entries.begin();
+			for (auto it = m_entries.begin(); it != m_entries.end(); it++)
+				if (it->second.LastUse < oldest->second.LastUse)
+					oldest = it;
+			m_entries.erase(oldest);
+		}
+	}
+	void TranscompileCache::m_evictDisk()
+	{
+		std::error_code ec;
+		std::vector<std::pair<ghc::filesystem::file_time_type, ghc::filesystem::path>> files;
+		for (const auto& entry : ghc::filesystem::directory_iterator(TRANSCOMPILE_CACHE_DIR, ec))
+			if (entry.is_regular_file(ec))
+				files.push_back(std::make_pair(entry.last_write_time(ec), entry.path()));
+
+		if (files.size() <= TRANSCOMPILE_CACHE_DISK_ENTRIES)
+			return;
+
+		std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+		for (size_t i = 0; i < files.size() - TRANSCOMPILE_CACHE_DISK_ENTRIES; i++)
+			ghc::filesystem::remove(files[i].second, ec);
+	}
+	std::string TranscompileCache::m_getPath(const std::string& key)
+	{
+		return std::string(TRANSCOMPILE_CACHE_DIR) + "/" + key + ".glsl";
+	}
+}
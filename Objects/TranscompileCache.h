@@ -0,0 +1,51 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <stdint.h>
+
+namespace ed
+{
+	// GLSL output of the HLSL/Vulkan GLSL -> SPIR-V -> GLSL path, in memory and in data/cache/transcompile
+	// entries are only used if none of the files they included have changed
+	class TranscompileCache
+	{
+	public:
+		static inline TranscompileCache& Instance()
+		{
+			static TranscompileCache ret;
+			return ret;
+		}
+
+		TranscompileCache();
+
+		bool Get(const std::string& key, std::string& source, std::vector<std::string>* includes = nullptr); // false if there's no up to date entry
+		void Store(const std::string& key, const std::string& source, const std::vector<std::string>& includes);
+		void Clear();
+
+		inline int GetHitCount() { return m_hits; }
+		inline int GetMissCount() { return m_misses; }
+
+	private:
+		struct Entry
+		{
+			std::string Source;
+			std::vector<std::pair<std::string, uint64_t>> Includes; // path + content hash
+			uint64_t LastUse;
+		};
+
+		bool m_isFresh(const Entry& entry);
+		bool m_load(const std::string& key, Entry& entry);
+		void m_save(const std::string& key, const Entry& entry);
+		void m_evict();
+		void m_evictDisk();
+		std::string m_getPath(const std::string& key);
+
+		std::mutex m_mutex; // used from the TranscompilerPool threads
+		std::unordered_map<std::string, Entry> m_entries;
+		uint64_t m_useCounter;
+		std::atomic<int> m_hits, m_misses;
+	};
+}
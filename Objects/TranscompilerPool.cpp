@@ -0,0 +1,80 @@
+#include "TranscompilerPool.h"
+#include "ShaderTranscompiler.h"
+#include "Logger.h"
+
+#include <algorithm>
+
+namespace ed
+{
+	TranscompilerPool::TranscompilerPool(ProjectParser* project)
+	{
+		m_project = project;
+		m_running = true;
+	}
+	TranscompilerPool::~TranscompilerPool()
+	{
+		Stop();
+	}
+	void TranscompilerPool::Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			m_running = false;
+			m_queue.clear();
+		}
+		m_queueCV.notify_all();
+
+		for (auto& thread : m_threads)
+			if (thread.joinable())
+				thread.join();
+		m_threads.clear();
+	}
+	void TranscompilerPool::Add(std::shared_ptr<Task> task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+
+			// shutting down, the workers are gone
+			if (!m_running) {
+				Run(*task);
+				return;
+			}
+
+			// start the workers on first use, leave one core for the UI thread
+			if (m_threads.size() == 0) {
+				int threadCount = std::max<int>(1, (int)std::thread::hardware_concurrency() - 1);
+				Logger::Get().Log("Starting " + std::to_string(threadCount) + " transcompiler threads");
+				for (int i = 0; i < threadCount; i++)
+					m_threads.push_back(std::thread(&TranscompilerPool::m_worker, this));
+			}
+
+			m_queue.push_back(task);
+		}
+		m_queueCV.notify_one();
+	}
+	void TranscompilerPool::Run(Task& task)
+	{
+		task.Messages.CurrentItemType = task.ShaderType;
+		task.Includes.clear();
+		task.Source = ShaderTranscompiler::Transcompile(task.Language, task.Filename, task.ShaderType, task.Entry, task.Macros, task.GSUsed, &task.Messages, m_project, &task.Includes);
+		task.Done = true;
+	}
+	void TranscompilerPool::m_worker()
+	{
+		while (true) {
+			std::shared_ptr<Task> task;
+			{
+				std::unique_lock<std::mutex> lock(m_queueMutex);
+				m_queueCV.wait(lock, [&]() { return !m_running || m_queue.size() > 0; });
+
+				if (!m_running)
+					return;
+
+				task = m_queue.front();
+				m_queue.pop_front();
+			}
+
+			Run(*task);
+		}
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "MessageStack.h"
+#include "ShaderMacro.h"
+#include "ShaderLanguage.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+namespace ed
+{
+	class ProjectParser;
+
+	// runs the CPU side of the shader compilation (glslang + SPIRV-Cross) on worker threads
+	class TranscompilerPool
+	{
+	public:
+		struct Task
+		{
+			Task() { ShaderType = 0; GSUsed = false; Done = false; }
+
+			// input
+			ShaderLanguage Language;
+			std::string Filename; // absolute path
+			int ShaderType; // 0=VS, 1=PS, 2=GS, 3=CS
+			std::string Entry;
+			std::vector<ShaderMacro> Macros;
+			bool GSUsed;
+
+			// output
+			std::string Source;
+			std::vector<std::string> Includes;
+			MessageStack Messages; // set Messages.CurrentItem to the owner's name
+			std::atomic<bool> Done;
+		};
+
+		TranscompilerPool(ProjectParser* project);
+		~TranscompilerPool();
+
+		void Add(std::shared_ptr<Task> task);
+		void Run(Task& task); // on the calling thread
+		void Stop(); // drops the queued tasks & joins the workers, call before the ProjectParser is destroyed
+
+	private:
+		void m_worker();
+
+		ProjectParser* m_project;
+
+		bool m_running;
+		std::vector<std::thread> m_threads;
+		std::deque<std::shared_ptr<Task>> m_queue;
+		std::mutex m_queueMutex;
+		std::condition_variable m_queueCV;
+	};
+}
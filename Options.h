@@ -4,6 +4,8 @@
 // #define SEMANTIC_LENGTH 32
 #define VARIABLE_NAME_LENGTH 256
 #define MAX_RENDER_TEXTURES 16
+#define SYSTEM_UNIFORM_BUFFER_NAME "SHADERed_System"
+#define SYSTEM_UNIFORM_BUFFER_BINDING 31
 
 #define MODEL_GROUP_NAME_LENGTH 64
 
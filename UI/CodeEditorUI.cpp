@@ -4,6 +4,7 @@
 #include "../Objects/Names.h"
 #include "../Objects/Logger.h"
 #include "../Objects/Settings.h"
+#include "../Objects/IncludeCache.h"
 #include "../Objects/ShaderTranscompiler.h"
 #include "../Objects/ThemeContainer.h"
 #include "../Objects/KeyboardShortcuts.h"
@@ -891,6 +892,7 @@ namespace ed
 		std::vector<std::string> allFiles;		// list of all files we care for
 		std::vector<std::string> allPasses;		// list of shader pass names that correspond to the file name
 		std::vector<std::string> paths;			// list of all paths that we should have "notifications turned on"
+		int includeVersion = -1;				// IncludeCache version that allFiles was built with
 
 		m_trackUpdatesNeeded = 0;
 
@@ -1019,6 +1021,10 @@ namespace ed
 				}
 			}
 
+			// #include'd files have changed
+			if (includeVersion != IncludeCache::Instance().GetVersion())
+				needsUpdate = true;
+
 			// update our file collection if needed
 			if (needsUpdate || nPasses.size() != passes.size() || curProject != m_data->Parser.GetOpenedFile() ||
 				paths.size() == 0) {
@@ -1041,6 +1047,7 @@ namespace ed
 				allPasses.clear();
 				paths.clear();
 				curProject = m_data->Parser.GetOpenedFile();
+				includeVersion = IncludeCache::Instance().GetVersion();
 
 				// get all paths to all shaders
 				passes = nPasses;
@@ -1103,6 +1110,16 @@ namespace ed
 					}
 				}
 
+				// headers - only the passes that include them will be recompiled
+				for (const auto& pass : passes) {
+					std::vector<std::string> includes = IncludeCache::Instance().GetDependencies(pass);
+					for (const auto& inc : includes) {
+						allFiles.push_back(inc);
+						paths.push_back(inc.substr(0, inc.find_last_of("/\\") + 1));
+						allPasses.push_back(pass->Name);
+					}
+				}
+
 				// delete directories that appear twice or that are subdirectories
 				{
 					std::vector<bool> toDelete(paths.size(), false);
@@ -163,6 +163,7 @@ namespace ed
 				}
 
 				if (m_data->Objects.IsRenderTexture(items[i]) ||
+					m_data->Objects.IsTexture(items[i]) ||
 					m_data->Objects.IsImage(items[i]) ||
 					isImg3D ||
 					(isPluginOwner && pobj->Owner->HasObjectProperties(pobj->Type)))
@@ -146,18 +146,14 @@ namespace ed
 
 							buf->Data = realloc(buf->Data, buf->Size);
 
-							glBindBuffer(GL_UNIFORM_BUFFER, buf->ID);
-							glBufferData(GL_UNIFORM_BUFFER, buf->Size, buf->Data, GL_STATIC_DRAW); // resize
-							glBindBuffer(GL_UNIFORM_BUFFER, 0);
+							m_data->Objects.UploadBuffer(buf);
 
 							m_data->Parser.ModifyProject();
 						}
 						if (ImGui::Button("CLEAR##objprev_clearbuf")) {
 							memset(buf->Data, 0, buf->Size);
 
-							glBindBuffer(GL_UNIFORM_BUFFER, buf->ID);
-							glBufferData(GL_UNIFORM_BUFFER, buf->Size, buf->Data, GL_STATIC_DRAW); // resize
-							glBindBuffer(GL_UNIFORM_BUFFER, 0);
+							m_data->Objects.UploadBuffer(buf);
 
 							m_data->Parser.ModifyProject();
 						}
@@ -187,9 +183,7 @@ namespace ed
 								for (int j = 0; j < item->CachedFormat.size(); j++) {
 									int dOffset = i * perRow + curColOffset;
 									if (m_drawBufferElement(i, j, (void*)(((char*)buf->Data) + dOffset), item->CachedFormat[j])) {
-										glBindBuffer(GL_UNIFORM_BUFFER, buf->ID);
-										glBufferData(GL_UNIFORM_BUFFER, buf->Size, buf->Data, GL_STATIC_DRAW); // allocate 0 bytes of memory
-										glBindBuffer(GL_UNIFORM_BUFFER, 0);
+										m_data->Objects.UploadBuffer(buf);
 
 										m_data->Parser.ModifyProject();
 									}
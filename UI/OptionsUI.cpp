@@ -7,6 +7,9 @@
 #include "../Objects/Settings.h"
 #include "../Objects/ThemeContainer.h"
 #include "../Objects/KeyboardShortcuts.h"
+#include "../Objects/ProgramBinaryCache.h"
+#include "../Objects/TranscompileCache.h"
+#include "../Objects/MeshCache.h"
 #include "UIHelper.h"
 
 #include <algorithm>
@@ -230,6 +233,64 @@ namespace ed
 		ImGui::SameLine();
 		ImGui::Checkbox("##optg_autorecompile", &settings->General.AutoRecompile);
 
+		/* PROGRAM CACHE: */
+		ImGui::Text("Cache compiled shaders on disk: ");
+		ImGui::SameLine();
+		ImGui::Checkbox("##optg_programcache", &settings->General.ProgramCache);
+
+		if (!settings->General.ProgramCache) {
+			ImGui::PushItemFlag(ImGuiItemFlags_Disabled, true);
+			ImGui::PushStyleVar(ImGuiStyleVar_Alpha, ImGui::GetStyle().Alpha * 0.5f);
+		}
+
+		/* PROGRAM CACHE SIZE: */
+		ImGui::Text("Shader cache size (MB): ");
+		ImGui::SameLine();
+		ImGui::PushItemWidth(100 * settings->DPIScale);
+		if (ImGui::InputInt("##optg_programcachesize", &settings->General.ProgramCacheSize, 16, 128))
+			settings->General.ProgramCacheSize = std::max<int>(settings->General.ProgramCacheSize, 1);
+		ImGui::PopItemWidth();
+		ImGui::SameLine();
+		if (ImGui::Button("CLEAR##optg_programcacheclear")) {
+			ProgramBinaryCache::Instance().Clear();
+			TranscompileCache::Instance().Clear();
+		}
+		ImGui::TextDisabled("   (programs: %d hits, %d misses; transcompiled: %d hits, %d misses)",
+			ProgramBinaryCache::Instance().GetHitCount(), ProgramBinaryCache::Instance().GetMissCount(),
+			TranscompileCache::Instance().GetHitCount(), TranscompileCache::Instance().GetMissCount());
+
+		if (!settings->General.ProgramCache) {
+			ImGui::PopStyleVar();
+			ImGui::PopItemFlag();
+		}
+
+		/* MESH CACHE: */
+		ImGui::Text("Cache imported 3D models on disk: ");
+		ImGui::SameLine();
+		ImGui::Checkbox("##optg_meshcache", &settings->General.MeshCache);
+
+		if (!settings->General.MeshCache) {
+			ImGui::PushItemFlag(ImGuiItemFlags_Disabled, true);
+			ImGui::PushStyleVar(ImGuiStyleVar_Alpha, ImGui::GetStyle().Alpha * 0.5f);
+		}
+
+		/* MESH CACHE SIZE: */
+		ImGui::Text("Model cache size (MB): ");
+		ImGui::SameLine();
+		ImGui::PushItemWidth(100 * settings->DPIScale);
+		if (ImGui::InputInt("##optg_meshcachesize", &settings->General.MeshCacheSize, 64, 512))
+			settings->General.MeshCacheSize = std::max<int>(settings->General.MeshCacheSize, 1);
+		ImGui::PopItemWidth();
+		ImGui::SameLine();
+		if (ImGui::Button("CLEAR##optg_meshcacheclear"))
+			MeshCache::Instance().Clear();
+		ImGui::TextDisabled("   (models: %d hits, %d misses)", MeshCache::Instance().GetHitCount(), MeshCache::Instance().GetMissCount());
+
+		if (!settings->General.MeshCache) {
+			ImGui::PopStyleVar();
+			ImGui::PopItemFlag();
+		}
+
 		/* REOPEN: */
 		ImGui::Text("Reopen shaders after openning a project: ");
 		ImGui::SameLine();
@@ -707,6 +768,29 @@ namespace ed
 			ImGui::PopItemFlag();
 		}
 
+		/* DYNAMIC RESOLUTION: */
+		ImGui::Text("Lower the preview resolution when FPS drops: ");
+		ImGui::SameLine();
+		ImGui::Checkbox("##optp_dynamicres", &settings->Preview.DynamicResolution);
+
+		if (!settings->Preview.DynamicResolution) {
+			ImGui::PushItemFlag(ImGuiItemFlags_Disabled, true);
+			ImGui::PushStyleVar(ImGuiStyleVar_Alpha, ImGui::GetStyle().Alpha * 0.5f);
+		}
+
+		/* TARGET FPS: */
+		ImGui::Text("Target FPS: ");
+		ImGui::SameLine();
+		ImGui::PushItemWidth(-1);
+		if (ImGui::InputInt("##optp_targetfps", &settings->Preview.TargetFPS, 1, 10))
+			settings->Preview.TargetFPS = std::max(1, settings->Preview.TargetFPS);
+		ImGui::PopItemWidth();
+
+		if (!settings->Preview.DynamicResolution) {
+			ImGui::PopStyleVar();
+			ImGui::PopItemFlag();
+		}
+
 	}
 	void OptionsUI::m_renderPlugins()
 	{
@@ -788,6 +872,19 @@ namespace ed
 			m_data->Parser.ModifyProject();
 		}
 
+		/* SYSTEM UNIFORM BUFFER: */
+		ImGui::Text("System variable uniform buffer: ");
+		ImGui::SameLine();
+		if (ImGui::Checkbox("##optpr_sysubo", &settings->Project.SystemUniformBuffer)) {
+			// the block declaration is a part of the shader source
+			std::vector<PipelineItem*> passes = m_data->Pipeline.GetList();
+			for (PipelineItem* pass : passes)
+				m_data->Renderer.Recompile(pass->Name);
+			m_data->Parser.ModifyProject();
+		}
+		if (ImGui::IsItemHovered())
+			ImGui::SetTooltip("Store the system variables in the " SYSTEM_UNIFORM_BUFFER_NAME " uniform block (sed* names)");
+
 		/* CLEAR COLOR: */
 		ImGui::Text("Preview window clear color: ");
 		ImGui::SameLine();
@@ -1100,30 +1100,23 @@ namespace ed
 			ImGui::Separator();
 
 			int id = 0;
-			std::vector<GLuint> &els = m_data->Objects.GetBindList(m_modalItem);
-			const std::vector<std::string> &items = m_data->Objects.GetObjects();
+			// copy - swapping changes the bind list
+			std::vector<ObjectHandle> els = m_data->Objects.GetBindHandles(m_modalItem);
 
 			/* EXISTING VARIABLES */
 			for (const auto& el : els) {
-				const std::string& itemName = m_data->Objects.GetItemNameByTextureID(el);
+				ObjectManagerItem* itemData = m_data->Objects.GetObjectManagerItem(el);
+				const std::string itemName = itemData == nullptr ? "" : itemData->Name;
 
 				/* CONTROLS */
 				ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0));
 				/* UP BUTTON */
-				if (ImGui::Button((UI_ICON_ARROW_UP "##s" + std::to_string(id)).c_str()) && id != 0) {
-					GLuint temp = els[id - 1];
-					els[id - 1] = el;
-					els[id] = temp;
-					m_data->Parser.ModifyProject();
-				}
+				if (ImGui::Button((UI_ICON_ARROW_UP "##s" + std::to_string(id)).c_str()) && id != 0)
+					m_data->Objects.SwapBind(m_modalItem, id - 1, id);
 				ImGui::SameLine(0,0);
 				/* DOWN BUTTON */
-				if (ImGui::Button((UI_ICON_ARROW_DOWN "##s" + std::to_string(id)).c_str()) && id != els.size() - 1) {
-					GLuint temp = els[id + 1];
-					els[id + 1] = el;
-					els[id] = temp;
-					m_data->Parser.ModifyProject();
-				}
+				if (ImGui::Button((UI_ICON_ARROW_DOWN "##s" + std::to_string(id)).c_str()) && id != els.size() - 1)
+					m_data->Objects.SwapBind(m_modalItem, id, id + 1);
 				ImGui::PopStyleColor();
 				ImGui::NextColumn();
 
@@ -1177,30 +1170,23 @@ namespace ed
 			ImGui::Separator();
 
 			int id = 0;
-			std::vector<GLuint> &els = m_data->Objects.GetUniformBindList(m_modalItem);
-			const std::vector<std::string> &items = m_data->Objects.GetObjects();
+			// copy - swapping changes the bind list
+			std::vector<ObjectHandle> els = m_data->Objects.GetUniformBindHandles(m_modalItem);
 
 			/* EXISTING VARIABLES */
 			for (const auto& el : els) {
-				const std::string& itemName = m_data->Objects.GetItemNameByTextureID(el);
+				ObjectManagerItem* itemData = m_data->Objects.GetObjectManagerItem(el);
+				const std::string itemName = itemData == nullptr ? "" : itemData->Name;
 
 				/* CONTROLS */
 				ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0));
 				/* UP BUTTON */
-				if (ImGui::Button((UI_ICON_ARROW_UP "##u" + std::to_string(id)).c_str()) && id != 0) {
-					GLuint temp = els[id - 1];
-					els[id - 1] = el;
-					els[id] = temp;
-					m_data->Parser.ModifyProject();
-				}
+				if (ImGui::Button((UI_ICON_ARROW_UP "##u" + std::to_string(id)).c_str()) && id != 0)
+					m_data->Objects.SwapUniformBind(m_modalItem, id - 1, id);
 				ImGui::SameLine(0,0);
 				/* DOWN BUTTON */
-				if (ImGui::Button((UI_ICON_ARROW_DOWN "##u" + std::to_string(id)).c_str()) && id != els.size() - 1) {
-					GLuint temp = els[id + 1];
-					els[id + 1] = el;
-					els[id] = temp;
-					m_data->Parser.ModifyProject();
-				}
+				if (ImGui::Button((UI_ICON_ARROW_DOWN "##u" + std::to_string(id)).c_str()) && id != els.size() - 1)
+					m_data->Objects.SwapUniformBind(m_modalItem, id, id + 1);
 				ImGui::PopStyleColor();
 				ImGui::NextColumn();
 
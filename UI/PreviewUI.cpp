@@ -13,6 +13,7 @@
 
 #include <chrono>
 #include <thread>
+#include <algorithm>
 #include <imgui/imgui_internal.h>
 
 #define STATUSBAR_HEIGHT 30 * Settings::Instance().DPIScale
@@ -22,6 +23,9 @@
 #define FPS_UPDATE_RATE 0.3f
 #define BOUNDING_BOX_PADDING 0.01f
 #define MAX_PICKED_ITEM_LIST_SIZE 4
+#define DYNAMIC_RES_UPDATE_RATE 0.5f
+#define DYNAMIC_RES_STEP 0.05f
+#define DYNAMIC_RES_MIN_SCALE 0.25f
 
 
 const char* BOX_VS_CODE = R"(
@@ -276,10 +280,18 @@ namespace ed
 		m_fpsUpdateTime += delta;
 		m_elapsedTime += delta;
 		if (capWholeApp || m_fpsLimit <= 0 || m_elapsedTime >= 1.0f / m_fpsLimit) {
-			if (!paused)
-				renderer->Render(imageSize.x, imageSize.y);
+			renderer->GetProfiler().SetFrameTimingEnabled(Settings::Instance().Preview.DynamicResolution);
+			if (!paused || renderer->IsCompiling()) {
+				int renderWidth = std::max<int>(1, imageSize.x * m_renderScale);
+				int renderHeight = std::max<int>(1, imageSize.y * m_renderScale);
+				renderer->Render(renderWidth, renderHeight);
+			}
 
 			float fps = m_fpsTimer.Restart();
+			if (!paused)
+				m_updateRenderScale(fps, renderer->GetProfiler().GetFrameGPUTime() / 1000.0f);
+			else
+				m_renderScale = 1.0f; // the render below will go back to the full size
 			if (m_fpsUpdateTime > FPS_UPDATE_RATE) {
 				m_fpsDelta = fps;
 				m_fpsUpdateTime -= FPS_UPDATE_RATE;
@@ -293,11 +305,27 @@ namespace ed
 			
 		GLuint rtView = renderer->GetTexture();
 
+		// smaller render -> upscale with bilinear filtering (the texture is recreated with GL_NEAREST once the size changes)
+		if (renderer->GetLastRenderSize() != m_zoomLastSize) {
+			glBindTexture(GL_TEXTURE_2D, rtView);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
+
 		// display the image on the imgui window
 		const glm::vec2& zPos = m_zoom.GetZoomPosition();
 		const glm::vec2& zSize = m_zoom.GetZoomSize();
 		ImGui::Image((void*)rtView, imageSize, ImVec2(zPos.x,zPos.y+zSize.y), ImVec2(zPos.x+zSize.x,zPos.y));
 
+		// shaders are compiled in the background after opening a project
+		if (renderer->IsCompiling()) {
+			ImVec2 cursorPos = ImGui::GetCursorPos();
+			ImGui::SetCursorPos(ImVec2(ImGui::GetWindowContentRegionMin().x + 5 * settings.DPIScale, ImGui::GetWindowContentRegionMin().y + 5 * settings.DPIScale));
+			ImGui::Text("Compiling %d/%d", renderer->GetCompiledCount(), renderer->GetCompileCount());
+			ImGui::SetCursorPos(cursorPos);
+		}
+
 		m_hasFocus = ImGui::IsWindowFocused();
 
 
@@ -749,11 +777,59 @@ namespace ed
 				((PropertyUI*)m_ui->Get(ViewID::Properties))->Open(m_picks[m_picks.size()-1]);
 	}
 
+	void PreviewUI::m_updateRenderScale(float frameTime, float gpuTime)
+	{
+		Settings& settings = Settings::Instance();
+
+		float targetFPS = settings.Preview.TargetFPS;
+		if (m_fpsLimit > 0)
+			targetFPS = std::min(targetFPS, m_fpsLimit); // we can't go faster than the FPS limit anyways
+
+		if (!settings.Preview.DynamicResolution || targetFPS <= 0) {
+			m_renderScale = 1.0f;
+			m_frameTimeAvg = m_scaleUpdateTime = 0.0f;
+			return;
+		}
+
+		// the wall clock time between frames also contains the UI and the vsync wait - only the GPU time
+		// of the pipeline depends on the render size (results arrive PROFILER_QUERY_RING_SIZE frames late)
+		float targetTime = 1.0f / targetFPS;
+		if (gpuTime >= 0.0f) {
+			if (m_frameTimeAvg <= 0.0f)
+				m_frameTimeAvg = gpuTime;
+			else
+				m_frameTimeAvg = m_frameTimeAvg * 0.9f + gpuTime * 0.1f;
+		}
+
+		// resizing recreates the render textures so don't do it too often
+		m_scaleUpdateTime += frameTime;
+		if (m_scaleUpdateTime < DYNAMIC_RES_UPDATE_RATE)
+			return;
+		m_scaleUpdateTime = 0.0f;
+
+		if (m_frameTimeAvg <= 0.0f)
+			return;
+
+		if (m_frameTimeAvg > targetTime * 1.1f || (m_frameTimeAvg < targetTime * 0.85f && m_renderScale < 1.0f)) {
+			// frame time ~ number of pixels
+			float scale = m_renderScale * sqrt(targetTime / m_frameTimeAvg);
+			scale = std::round(scale / DYNAMIC_RES_STEP) * DYNAMIC_RES_STEP;
+			scale = std::max(DYNAMIC_RES_MIN_SCALE, std::min(scale, 1.0f));
+
+			if (scale != m_renderScale) {
+				m_renderScale = scale;
+				m_frameTimeAvg = 0.0f; // measure the new size from scratch
+			}
+		}
+	}
 	void PreviewUI::m_renderStatusbar(float width, float height)
 	{
 		float FPS = 1.0f / m_fpsDelta;
 		ImGui::Separator();
-		ImGui::Text("FPS: %.2f", FPS);
+		if (m_renderScale < 1.0f)
+			ImGui::Text("FPS: %.1f @%d%%", FPS, (int)(m_renderScale * 100.0f + 0.5f));
+		else
+			ImGui::Text("FPS: %.2f", FPS);
 		ImGui::SameLine();
 
 		ImGui::SameLine(120 * Settings::Instance().DPIScale);
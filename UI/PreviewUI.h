@@ -22,6 +22,8 @@ namespace ed
 			m_setupShortcuts();
 			m_setupBoundingBox();
 			m_fpsLimit = m_elapsedTime = 0;
+			m_renderScale = 1.0f;
+			m_frameTimeAvg = m_scaleUpdateTime = 0.0f;
 			m_hasFocus = false;
 			m_startWrap = false;
 			m_mouseHovers = false;
@@ -44,6 +46,8 @@ namespace ed
 		void m_setupShortcuts();
 
 		void m_renderStatusbar(float width, float height);
+
+		void m_updateRenderScale(float frameTime, float gpuTime); // Settings::Preview.DynamicResolution, gpuTime < 0 if unknown
 		
 		void m_setupBoundingBox();
 		void m_buildBoundingBox();
@@ -78,6 +82,11 @@ namespace ed
 		float m_elapsedTime;
 		float m_fpsLimit;
 
+		// dynamic resolution
+		float m_renderScale; // render size = image size * m_renderScale
+		float m_frameTimeAvg;
+		float m_scaleUpdateTime;
+
 		std::vector<PipelineItem*> m_picks;
 		int m_pickMode; // 0 = position, 1 = scale, 2 = rotation
 
@@ -0,0 +1,73 @@
+#include "ProfilerUI.h"
+#include "UIHelper.h"
+#include "../Objects/Settings.h"
+#include "../Objects/GLState.h"
+#include <imgui/imgui.h>
+
+namespace ed
+{
+	void ProfilerUI::OnEvent(const SDL_Event& e)
+	{}
+	void ProfilerUI::Update(float delta)
+	{
+		Profiler& profiler = m_data->Renderer.GetProfiler();
+
+		bool enabled = profiler.IsEnabled();
+		if (ImGui::Checkbox("Enabled", &enabled))
+			profiler.SetEnabled(enabled);
+		ImGui::SameLine();
+		if (ImGui::Button("Export trace")) {
+			std::string file;
+			if (UIHelper::GetSaveFileDialog(file, "json"))
+				profiler.ExportTrace(file);
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Clear"))
+			profiler.Clear();
+
+		ImGui::Text("Uniform uploads: %d (skipped: %d)", ShaderVariableContainer::GetLastUploadCount(), ShaderVariableContainer::GetLastSkippedUploadCount());
+		ImGui::Text("GL state calls: %d (skipped: %d)", GLState::Instance().GetLastCallCount(), GLState::Instance().GetLastSkippedCount());
+		ImGui::Text("Cached passes reused: %d", m_data->Renderer.GetLastSkippedPassCount());
+
+		if (!enabled) {
+			ImGui::TextWrapped("Enable the profiler to measure CPU and GPU time of each pipeline item.");
+			return;
+		}
+
+		float frameGPU = profiler.GetFrameGPUTime();
+		ImGui::Text("Frame CPU: %.3f ms", profiler.GetFrameCPUTime());
+		ImGui::SameLine(200 * Settings::Instance().DPIScale);
+		if (frameGPU < 0.0f)
+			ImGui::Text("Frame GPU: n/a");
+		else
+			ImGui::Text("Frame GPU: %.3f ms", frameGPU);
+		ImGui::Separator();
+
+		const std::vector<Profiler::ItemTime>& results = profiler.GetResults();
+
+		ImGui::Columns(6);
+
+		ImGui::Text("Item"); ImGui::NextColumn();
+		ImGui::Text("GPU (ms)"); ImGui::NextColumn();
+		ImGui::Text("CPU (ms)"); ImGui::NextColumn();
+		ImGui::Text("Uniforms"); ImGui::NextColumn();
+		ImGui::Text("FBO"); ImGui::NextColumn();
+		ImGui::Text("Plugin"); ImGui::NextColumn();
+		ImGui::Separator();
+
+		for (const auto& item : results) {
+			ImGui::Text("%s", item.Name.c_str()); ImGui::NextColumn();
+			if (item.GPU < 0.0f)
+				ImGui::Text("n/a");
+			else
+				ImGui::Text("%.3f", item.GPU);
+			ImGui::NextColumn();
+			ImGui::Text("%.3f", item.CPU[(int)Profiler::Stage::Item]); ImGui::NextColumn();
+			ImGui::Text("%.3f", item.CPU[(int)Profiler::Stage::Uniforms]); ImGui::NextColumn();
+			ImGui::Text("%.3f", item.CPU[(int)Profiler::Stage::FBO]); ImGui::NextColumn();
+			ImGui::Text("%.3f", item.CPU[(int)Profiler::Stage::Plugin]); ImGui::NextColumn();
+		}
+
+		ImGui::Columns(1);
+	}
+}
@@ -49,6 +49,8 @@ namespace ed
 					ImGui::Text("Image3D");
 				else if (IsPlugin())
 					ImGui::Text(m_currentObj->Plugin->Type);
+				else if (IsTexture())
+					ImGui::Text("Texture");
 				else
 					ImGui::Text("ObjectManagerItem");
 			}
@@ -343,6 +345,28 @@ namespace ed
 					ImGui::NextColumn();
 
 					if (!item->GSUsed) ImGui::PopItemFlag();
+					ImGui::Separator();
+
+					// batching
+					ImGui::Text("Batching:");
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip("Draw geometry that only differs in transform with one draw call.\nThe vertex shader has to read the transform from\nlayout(location = 11) in mat4 and IsPicked from layout(location = 15) in float.\nModels and instanced geometry aren't batched but get the same attributes -\ntheir instance buffer layout has to stay below location 11.");
+					ImGui::NextColumn();
+					if (ImGui::Checkbox("##pui_batching", &item->Batching))
+						m_data->Parser.ModifyProject();
+					ImGui::NextColumn();
+					ImGui::Separator();
+
+					// result caching
+					ImGui::Text("Cache:");
+					if (ImGui::IsItemHovered())
+						ImGui::SetTooltip("Dynamic - render every frame\nAuto - only render when textures, uniforms or items used by this pass change\nStatic - render once and reuse the render textures");
+					ImGui::NextColumn();
+					ImGui::PushItemWidth(-1);
+					if (ImGui::Combo("##pui_cache", reinterpret_cast<int*>(&item->Cache), PASS_CACHE_MODE_NAMES, HARRAYSIZE(PASS_CACHE_MODE_NAMES)))
+						m_data->Parser.ModifyProject();
+					ImGui::PopItemWidth();
+					ImGui::NextColumn();
 				}
 				else if (m_current->Type == ed::PipelineItem::ItemType::ComputePass)
 				{
@@ -1212,6 +1236,66 @@ namespace ed
 				}
 				ImGui::PopItemWidth();
 			}
+			else if (IsTexture()) {
+				ed::TextureSampler* sampler = &m_currentObj->Sampler;
+				std::string texName = m_data->Objects.GetObjectManagerItemName(m_currentObj);
+
+				/* INFO */
+				ImGui::Text("Format:");
+				ImGui::NextColumn();
+				ImGui::Text("%dx%d, %s, %d level(s) in the file", m_currentObj->ImageSize.x, m_currentObj->ImageSize.y,
+					TextureLoader::GetFormatName(m_currentObj->TextureFormat), m_currentObj->FileLevels);
+				ImGui::NextColumn();
+				ImGui::Separator();
+
+				/* MIPMAPS */
+				ImGui::Text("Mipmaps:");
+				ImGui::NextColumn();
+				if (ImGui::Checkbox("##pui_tex_mipmaps", &sampler->Mipmaps))
+					m_data->Objects.UpdateTextureSampler(texName);
+				ImGui::NextColumn();
+				ImGui::Separator();
+
+				/* FILTERS & WRAPPING */
+				const char* filterLabels[] = { "Min filter:", "Mag filter:" };
+				const char* filterIDs[] = { "##pui_tex_minfilter", "##pui_tex_magfilter" };
+				GLint* filters[] = { &sampler->MinFilter, &sampler->MagFilter };
+				for (int f = 0; f < 2; f++) {
+					ImGui::Text(filterLabels[f]);
+					ImGui::NextColumn();
+					ImGui::PushItemWidth(-1);
+					int filterIndex = *filters[f] == GL_NEAREST ? 0 : 1;
+					if (ImGui::Combo(filterIDs[f], &filterIndex, TEXTURE_FILTER_NAMES, HARRAYSIZE(TEXTURE_FILTER_NAMES))) {
+						*filters[f] = TEXTURE_FILTER_VALUES[filterIndex];
+						m_data->Objects.UpdateTextureSampler(texName);
+					}
+					ImGui::PopItemWidth();
+					ImGui::NextColumn();
+					ImGui::Separator();
+				}
+
+				const char* wrapLabels[] = { "Wrap S:", "Wrap T:" };
+				const char* wrapIDs[] = { "##pui_tex_wraps", "##pui_tex_wrapt" };
+				GLint* wraps[] = { &sampler->WrapS, &sampler->WrapT };
+				for (int w = 0; w < 2; w++) {
+					ImGui::Text(wrapLabels[w]);
+					ImGui::NextColumn();
+					ImGui::PushItemWidth(-1);
+					int wrapIndex = 0;
+					for (int k = 0; k < HARRAYSIZE(TEXTURE_WRAP_VALUES); k++)
+						if (TEXTURE_WRAP_VALUES[k] == *wraps[w])
+							wrapIndex = k;
+					if (ImGui::Combo(wrapIDs[w], &wrapIndex, TEXTURE_WRAP_NAMES, HARRAYSIZE(TEXTURE_WRAP_NAMES))) {
+						*wraps[w] = TEXTURE_WRAP_VALUES[wrapIndex];
+						m_data->Objects.UpdateTextureSampler(texName);
+					}
+					ImGui::PopItemWidth();
+					if (w == 0) {
+						ImGui::NextColumn();
+						ImGui::Separator();
+					}
+				}
+			}
 			else if (IsPlugin()) {
 				ImGui::Columns(1);
 
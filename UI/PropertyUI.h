@@ -24,6 +24,7 @@ namespace ed
 		inline bool IsImage() { return m_currentObj != nullptr && m_currentObj->Image != nullptr; }
 		inline bool IsImage3D() { return m_currentObj != nullptr && m_currentObj->Image3D != nullptr; }
 		inline bool IsPlugin() { return m_currentObj != nullptr && m_currentObj->Plugin != nullptr; }
+		inline bool IsTexture() { return m_currentObj != nullptr && m_currentObj->IsTexture; }
 
 	private:
 		char m_itemName[64];
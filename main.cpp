@@ -7,11 +7,13 @@
 #include "Objects/AudioShaderStream.h"
 #include "Objects/Settings.h"
 #include "Objects/Logger.h"
+#include "Objects/SystemVariableManager.h"
 #include "EditorEngine.h"
 #include "Engine/GeometryFactory.h"
 
 #include <thread>
 #include <chrono>
+#include <algorithm>
 #include <fstream>
 #include <ghc/filesystem.hpp>
 
@@ -71,12 +73,177 @@ void setIcon(SDL_Window* wnd)
 	stbi_set_flip_vertically_on_load(1);
 }
 
+struct HeadlessOptions
+{
+	bool Enabled = false;
+	std::string Project = "";
+	std::string OutputDir = "./";
+	int Frames = 1;
+	int Width = 800, Height = 600;
+	float FPS = 60.0f;
+};
+bool parseHeadlessArgs(int argc, char* argv[], HeadlessOptions& opts)
+{
+	for (int i = 1; i < argc; i++) {
+		std::string arg(argv[i]);
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--headless")
+			opts.Enabled = true;
+		else if (arg == "--render" && hasValue)
+			opts.Project = argv[++i];
+		else if (arg == "--out" && hasValue)
+			opts.OutputDir = argv[++i];
+		else if (arg == "--frames" && hasValue)
+			opts.Frames = std::max(1, atoi(argv[++i]));
+		else if (arg == "--fps" && hasValue)
+			opts.FPS = std::max(1.0f, (float)atof(argv[++i]));
+		else if (arg == "--size" && hasValue) {
+			if (sscanf(argv[++i], "%dx%d", &opts.Width, &opts.Height) != 2 || opts.Width <= 0 || opts.Height <= 0) {
+				ed::Logger::Get().Log("Invalid --size argument, expected WIDTHxHEIGHT", true);
+				return false;
+			}
+		}
+	}
+
+	if (opts.Enabled && opts.Project.empty()) {
+		ed::Logger::Get().Log("--headless requires a project file (--render project.sprj)", true);
+		return false;
+	}
+
+	return true;
+}
+int runHeadless(const HeadlessOptions& opts, const ghc::filesystem::path& cmdDir)
+{
+	// use SDL's offscreen (EGL) video driver when available so that no display server is needed
+	if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_AUDIO) < 0 || (SDL_VideoInit("offscreen") < 0 && SDL_VideoInit(nullptr) < 0)) {
+		ed::Logger::Get().Log("Failed to initialize SDL2 video for headless rendering", true);
+		ed::Logger::Get().Save();
+		return 1;
+	}
+
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+
+	// hidden window - only used to own the GL context, everything is rendered to the engine's render textures
+	SDL_Window* wnd = SDL_CreateWindow("SHADERed", 0, 0, 64, 64, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+	SDL_GLContext glContext = wnd ? SDL_GL_CreateContext(wnd) : nullptr;
+	if (glContext == nullptr) {
+		ed::Logger::Get().Log("Failed to create an offscreen OpenGL context: " + std::string(SDL_GetError()), true);
+		ed::Logger::Get().Save();
+		if (wnd) SDL_DestroyWindow(wnd);
+		SDL_Quit();
+		return 1;
+	}
+	SDL_GL_MakeCurrent(wnd, glContext);
+
+	glewExperimental = true;
+	if (glewInit() != GLEW_OK) {
+		ed::Logger::Get().Log("Failed to initialize GLEW", true);
+		ed::Logger::Get().Save();
+		SDL_GL_DeleteContext(glContext);
+		SDL_DestroyWindow(wnd);
+		SDL_Quit();
+		return 1;
+	}
+
+	ed::Settings::Instance().Load();
+
+	int ret = 0;
+	{
+		// no GUIManager -> no ImGui, no plugins, no editor state
+		ed::InterfaceManager data(nullptr);
+		data.Renderer.AllowComputeShaders(GLEW_ARB_compute_shader);
+
+		ghc::filesystem::path projFile(opts.Project);
+		if (projFile.is_relative())
+			projFile = cmdDir / projFile;
+
+		ghc::filesystem::path outDir(opts.OutputDir);
+		if (outDir.is_relative())
+			outDir = cmdDir / outDir;
+		std::error_code errCode;
+		ghc::filesystem::create_directories(outDir, errCode);
+
+		ed::Logger::Get().Log("Rendering " + projFile.generic_string() + " headless");
+		if (!data.Parser.Open(projFile.generic_string())) {
+			ed::Logger::Get().Log("Failed to open " + projFile.generic_string(), true);
+			ret = 1;
+		} else if (data.Pipeline.GetList().size() == 0) {
+			ed::Logger::Get().Log("The project's pipeline is empty - nothing to render", true);
+			ret = 1;
+		}
+
+		if (ret == 0) {
+			data.Renderer.WaitForCompilation();
+			data.Objects.WaitForTextures();
+
+			// fixed time step so that the output doesn't depend on how fast the frames are rendered
+			float delta = 1.0f / opts.FPS;
+			ed::SystemVariableManager& sysVars = ed::SystemVariableManager::Instance();
+			data.Renderer.Pause(true);
+			sysVars.SetViewportSize(opts.Width, opts.Height);
+			sysVars.SetTimeDelta(delta);
+
+			unsigned char* pixels = (unsigned char*)malloc(opts.Width * opts.Height * 4);
+			char filename[32];
+
+			for (int frame = 0; frame < opts.Frames; frame++) {
+				sysVars.CopyState();
+				sysVars.SetFrameIndex(frame);
+
+				data.Renderer.Render(opts.Width, opts.Height);
+
+				if (!data.Messages.CanRenderPreview()) {
+					for (const auto& msg : data.Messages.GetMessages())
+						if (msg.MType == ed::MessageStack::Type::Error)
+							ed::Logger::Get().Log(msg.Group + ": " + msg.Text, true);
+					ret = 1;
+					break;
+				}
+
+				glBindTexture(GL_TEXTURE_2D, data.Renderer.GetTexture());
+				glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+				glBindTexture(GL_TEXTURE_2D, 0);
+
+				snprintf(filename, sizeof(filename), "frame%05d.png", frame);
+				std::string outPath = (outDir / filename).generic_string();
+				if (!stbi_write_png(outPath.c_str(), opts.Width, opts.Height, 4, pixels, opts.Width * 4)) {
+					ed::Logger::Get().Log("Failed to write " + outPath, true);
+					ret = 1;
+					break;
+				}
+
+				sysVars.AdvanceTimer(delta);
+			}
+
+			free(pixels);
+		}
+
+		data.Pipeline.Clear();
+	}
+
+	SDL_GL_DeleteContext(glContext);
+	SDL_DestroyWindow(wnd);
+	SDL_Quit();
+
+	ed::Logger::Get().Log("Finished headless rendering");
+	ed::Logger::Get().Save();
+
+	return ret;
+}
+
 #include <stdio.h>
 #include <string.h>
 
 int main(int argc, char* argv[])
 {
 	ghc::filesystem::path cmdDir = ghc::filesystem::current_path();
+
+	HeadlessOptions headless;
+	if (!parseHeadlessArgs(argc, argv, headless))
+		return 1;
 	if (argc > 0) {
 		if (ghc::filesystem::exists(ghc::filesystem::path(argv[0]).parent_path())) {
 			ghc::filesystem::current_path(ghc::filesystem::path(argv[0]).parent_path());
@@ -88,7 +255,7 @@ int main(int argc, char* argv[])
 #if defined(__linux__) || defined(__unix__)
 	// currently the only supported argument is a path to set the working directory... dont do this check if user wants to explicitly set the working directory,
 	// TODO: if more arguments get added, use different methods to check if working directory is being set explicitly
-	if (argc <= 1) { 
+	if (argc <= 1 || headless.Enabled) { 
 		char result[PATH_MAX];
 		ssize_t readlinkRes = readlink("/proc/self/exe", result, PATH_MAX);
 		std::string exePath = "";
@@ -134,6 +301,8 @@ int main(int argc, char* argv[])
 	else
 		ed::Logger::Get().Log("Failed to initialize glslang", true);
 
+	if (headless.Enabled)
+		return runHeadless(headless, cmdDir);
 	
 	// init sdl2
 	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_AUDIO) < 0) {